@@ -4,6 +4,30 @@ import os
 cimport debug_mgr.core as dm_core
 cimport vsc_dm.core as vsc_dm
 cimport vsc_solvers.decl as decl
+from libc.stdint cimport int32_t
+from libc.stdint cimport uint32_t
+from libc.stdint cimport uint64_t
+from libcpp.vector cimport vector as cpp_vector
+
+cdef dict _hist2dict(const decl.SolverStatsHist &h):
+    # Latencies are in nanoseconds
+    return {
+        "count" : h.count(),
+        "total" : h.total(),
+        "mean"  : h.mean(),
+        "max"   : h.max(),
+        "p50"   : h.p50(),
+        "p99"   : h.p99()
+    }
+
+cdef void _paths2set(decl.RefPathSet *s, paths) except *:
+    cdef cpp_vector[int32_t] path_v
+    for path in paths:
+        path_v = path
+        if path_v.size() > decl.RefPathSet_MaxDepth:
+            raise ValueError("Path %s is deeper than %d elements" % (
+                str(path), decl.RefPathSet_MaxDepth))
+        s.add(path_v)
 
 cdef class CompoundSolver(object):
 
@@ -13,6 +37,117 @@ cdef class CompoundSolver(object):
     cpdef bool solve(self, RandState randstate, fields, constraints, flags):
         pass
 
+    cpdef list randomizeN(
+        self, 
+        RandState           randstate, 
+        vsc_dm.ModelField   root_field, 
+        uint32_t            count, 
+        target_fields, 
+        fixed_fields, 
+        include_constraints, 
+        exclude_constraints, 
+        flags, 
+        columns):
+        """Returns one list of 'count' values per column path, or None on failure"""
+        cdef decl.RefPathSet target_s
+        cdef decl.RefPathSet fixed_s
+        cdef decl.RefPathSet include_s
+        cdef decl.RefPathSet exclude_s
+        cdef cpp_vector[cpp_vector[int32_t]] columns_v
+        cdef cpp_vector[uint64_t] data
+        cdef uint32_t c, i
+
+        _paths2set(&target_s, target_fields)
+        _paths2set(&fixed_s, fixed_fields)
+        _paths2set(&include_s, include_constraints)
+        _paths2set(&exclude_s, exclude_constraints)
+        for path in columns:
+            columns_v.push_back(path)
+        data.resize(columns_v.size()*count)
+
+        if not self._hndl.randomizeN(
+            randstate._hndl,
+            root_field.asField(),
+            count,
+            target_s,
+            fixed_s,
+            include_s,
+            exclude_s,
+            <decl.SolveFlags>(<uint32_t>flags),
+            columns_v,
+            data.data()):
+            return None
+
+        ret = []
+        for c in range(columns_v.size()):
+            ret.append([data[c*count+i] for i in range(count)])
+        return ret
+
+    cpdef void setNumThreads(self, uint32_t n_threads):
+        self._hndl.setNumThreads(n_threads)
+
+    cpdef uint32_t getNumThreads(self):
+        return self._hndl.getNumThreads()
+
+    cpdef void setPoolSize(self, uint32_t size):
+        self._hndl.setPoolSize(size)
+
+    cpdef uint32_t getPoolSize(self):
+        return self._hndl.getPoolSize()
+
+    cpdef void setBudget(self, uint32_t call_ms, uint32_t solveset_ms, str fallback="fail", uint32_t conflicts=0):
+        cdef decl.SolverFallback fallback_e = decl.FallbackFail
+        if fallback == "previous":
+            fallback_e = decl.FallbackPrevious
+        elif fallback == "engine":
+            fallback_e = decl.FallbackEngine
+        elif fallback != "fail":
+            raise Exception("Unknown budget fallback \"%s\"" % fallback)
+        self._hndl.setBudget(decl.SolverBudget(call_ms, solveset_ms, fallback_e, conflicts))
+
+    cpdef dict getStats(self):
+        cdef decl.SolverStats *stats = &self._hndl.getStats()
+        cdef uint32_t i
+        phases = {
+            "partition" : _hist2dict(stats.getPhase(decl.StatsPartition)),
+            "build"     : _hist2dict(stats.getPhase(decl.StatsBuild)),
+            "solve"     : _hist2dict(stats.getPhase(decl.StatsSolve)),
+            "readback"  : _hist2dict(stats.getPhase(decl.StatsReadback)),
+            "randomize" : _hist2dict(stats.getPhase(decl.StatsRandomize)),
+            "sat"       : _hist2dict(stats.getPhase(decl.StatsSat))
+        }
+        counters = {
+            "plan_hit"    : stats.getCount(decl.StatsPlanHit),
+            "plan_miss"   : stats.getCount(decl.StatsPlanMiss),
+            "solver_hit"  : stats.getCount(decl.StatsSolverHit),
+            "solver_miss" : stats.getCount(decl.StatsSolverMiss),
+            "unsat"       : stats.getCount(decl.StatsUnsat),
+            "swizzle_retry" : stats.getCount(decl.StatsSwizzleRetry),
+            "pool_hit"    : stats.getCount(decl.StatsPoolHit),
+            "timeout"     : stats.getCount(decl.StatsTimeout),
+            "fallback"    : stats.getCount(decl.StatsFallback),
+            "template_clone" : stats.getCount(decl.StatsTemplateClone)
+        }
+        backends = {}
+        for i in range(stats.getNumBackends()):
+            backends[stats.getBackendName(i).decode()] = _hist2dict(stats.getBackendAt(i))
+        solvesets = []
+        for i in range(stats.getNumSolveSets()):
+            ss = _hist2dict(stats.getSolveSetAt(i).solve)
+            ss["n_fields"] = stats.getSolveSetAt(i).n_fields
+            ss["n_constraints"] = stats.getSolveSetAt(i).n_constraints
+            ss["cost"] = stats.getSolveSetAt(i).cost
+            solvesets.append(ss)
+        return {
+            "phases"    : phases,
+            "counters"  : counters,
+            "backends"  : backends,
+            "solvesets" : solvesets
+        }
+
+    cpdef void resetStats(self):
+        self._hndl.resetStats()
+
     @staticmethod
     cdef mk(decl.ICompoundSolver *hndl):
         ret = CompoundSolver()
@@ -89,6 +224,9 @@ cdef class RandState(object):
     cpdef RandState next(self):
         return RandState.mk(self._hndl.next())
 
+    cpdef RandState fork(self):
+        return RandState.mk(self._hndl.fork())
+
     @staticmethod
     cdef mk(decl.IRandState *hndl):
         ret = RandState()
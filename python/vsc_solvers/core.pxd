@@ -16,6 +16,32 @@ cdef class CompoundSolver(object):
 
     cpdef bool solve(self, RandState randstate, fields, constraints, flags)
 
+    cpdef list randomizeN(
+        self, 
+        RandState           randstate, 
+        vsc_dm.ModelField   root_field, 
+        uint32_t            count, 
+        target_fields, 
+        fixed_fields, 
+        include_constraints, 
+        exclude_constraints, 
+        flags, 
+        columns)
+
+    cpdef void setNumThreads(self, uint32_t n_threads)
+
+    cpdef uint32_t getNumThreads(self)
+
+    cpdef void setPoolSize(self, uint32_t size)
+
+    cpdef uint32_t getPoolSize(self)
+
+    cpdef void setBudget(self, uint32_t call_ms, uint32_t solveset_ms, str fallback=*, uint32_t conflicts=*)
+
+    cpdef dict getStats(self)
+
+    cpdef void resetStats(self)
+
     @staticmethod
     cdef mk(decl.ICompoundSolver *)
 
@@ -39,6 +65,7 @@ cdef class RandState(object):
     cpdef void setState(self, RandState other)
     cpdef RandState clone(self)
     cpdef RandState next(self)
+    cpdef RandState fork(self)
 
     @staticmethod
     cdef mk(decl.IRandState *)
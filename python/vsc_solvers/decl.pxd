@@ -14,6 +14,70 @@ from libcpp cimport bool
 ctypedef IFactory *IFactoryP
 ctypedef IRandState *IRandStateP
 
+cdef extern from "vsc/solvers/SolverStats.h" namespace "vsc::solvers":
+    cdef enum SolverStatsPhase:
+        StatsPartition  "vsc::solvers::SolverStatsPhase::Partition"
+        StatsBuild      "vsc::solvers::SolverStatsPhase::Build"
+        StatsSolve      "vsc::solvers::SolverStatsPhase::Solve"
+        StatsReadback   "vsc::solvers::SolverStatsPhase::Readback"
+        StatsRandomize  "vsc::solvers::SolverStatsPhase::Randomize"
+        StatsSat        "vsc::solvers::SolverStatsPhase::Sat"
+
+    cdef enum SolverStatsCounter:
+        StatsPlanHit    "vsc::solvers::SolverStatsCounter::PlanHit"
+        StatsPlanMiss   "vsc::solvers::SolverStatsCounter::PlanMiss"
+        StatsSolverHit  "vsc::solvers::SolverStatsCounter::SolverHit"
+        StatsSolverMiss "vsc::solvers::SolverStatsCounter::SolverMiss"
+        StatsUnsat      "vsc::solvers::SolverStatsCounter::Unsat"
+        StatsSwizzleRetry "vsc::solvers::SolverStatsCounter::SwizzleRetry"
+        StatsPoolHit    "vsc::solvers::SolverStatsCounter::PoolHit"
+        StatsTimeout    "vsc::solvers::SolverStatsCounter::Timeout"
+        StatsFallback   "vsc::solvers::SolverStatsCounter::Fallback"
+        StatsTemplateClone "vsc::solvers::SolverStatsCounter::TemplateClone"
+
+    cdef cppclass SolverStatsHist:
+        uint64_t count() const
+        uint64_t total() const
+        uint64_t max() const
+        uint64_t mean() const
+        uint64_t p50() const
+        uint64_t p99() const
+
+    cdef cppclass SolverStatsSolveSet:
+        uint32_t n_fields
+        uint32_t n_constraints
+        uint64_t cost
+        SolverStatsHist solve
+
+    cdef cppclass SolverStats:
+        SolverStatsHist &getPhase(SolverStatsPhase)
+        uint64_t getCount(SolverStatsCounter)
+        uint32_t getNumBackends()
+        const cpp_string &getBackendName(uint32_t)
+        const SolverStatsHist &getBackendAt(uint32_t)
+        uint32_t getNumSolveSets()
+        const SolverStatsSolveSet &getSolveSetAt(uint32_t)
+
+cdef extern from "vsc/solvers/SolverBudget.h" namespace "vsc::solvers":
+    cdef enum SolverFallback:
+        FallbackFail     "vsc::solvers::SolverFallback::Fail"
+        FallbackPrevious "vsc::solvers::SolverFallback::Previous"
+        FallbackEngine   "vsc::solvers::SolverFallback::Engine"
+
+    cdef cppclass SolverBudget:
+        SolverBudget(uint32_t, uint32_t, SolverFallback, uint32_t)
+        uint32_t call_ms
+        uint32_t solveset_ms
+        SolverFallback fallback
+        uint32_t conflicts
+
+cdef extern from "vsc/solvers/impl/RefPathSet.h" namespace "vsc::solvers":
+    cdef enum:
+        RefPathSet_MaxDepth "vsc::solvers::RefPathSet::MaxDepth"
+    cdef cppclass RefPathSet:
+        RefPathSet()
+        bool add(const cpp_vector[int32_t] &path)
+
 cdef extern from "vsc/solvers/ICompoundSolver.h" namespace "vsc::solvers":
     cdef enum SolveFlags:
         Randomize          "vsc::solvers::SolveFlags::Randomize"
@@ -28,6 +92,24 @@ cdef extern from "vsc/solvers/ICompoundSolver.h" namespace "vsc::solvers":
             const cpp_vector[vsc_dm_decl.IModelConstraintP]     &constraints,
             SolveFlags                                          flags
         )
+        bool randomizeN(
+            IRandState                                          *randstate,
+            vsc_dm_decl.IModelField                             *root_field,
+            uint32_t                                            count,
+            const RefPathSet                                    &target_fields,
+            const RefPathSet                                    &fixed_fields,
+            const RefPathSet                                    &include_constraints,
+            const RefPathSet                                    &exclude_constraints,
+            SolveFlags                                          flags,
+            const cpp_vector[cpp_vector[int32_t]]               &columns,
+            uint64_t                                            *data)
+        void setNumThreads(uint32_t n_threads)
+        uint32_t getNumThreads()
+        void setPoolSize(uint32_t size)
+        uint32_t getPoolSize()
+        void setBudget(const SolverBudget &)
+        SolverStats &getStats()
+        void resetStats()
 
 cdef extern from "vsc/solvers/IFactory.h" namespace "vsc::solvers":
     cdef cppclass IFactory:
@@ -49,4 +131,5 @@ cdef extern from "vsc/solvers/IRandState.h" namespace "vsc::solvers":
         void setState(IRandState *)
         IRandState *clone() const
         IRandState *next()        
+        IRandState *fork()
 
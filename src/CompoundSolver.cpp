@@ -18,9 +18,13 @@
  * Created on:
  *     Author:
  */
+#include <algorithm>
 #include "dmgr/impl/DebugMacros.h"
+#include "vsc/dm/impl/ValRefBool.h"
+#include "vsc/dm/impl/ValRefInt.h"
+#include "vsc/solvers/impl/TaskPath2ValKind.h"
+#include "vsc/solvers/impl/TaskPath2ValRef.h"
 #include "CompoundSolver.h"
-#include "TaskBuildSolveSets.h"
 
 
 namespace vsc {
@@ -29,10 +33,35 @@ namespace solvers {
 
 CompoundSolver::CompoundSolver(
     dmgr::IDebugMgr         *dmgr,
-    ISolverFactory          *solver_f) : 
+    ISolverFactory          *solver_f,
+    ISolverFactory          *fallback_f) : 
         m_dmgr(dmgr), m_solver_f(solver_f), 
-        m_solver_unconstrained(dmgr) {
+        m_solver_unconstrained(dmgr), m_plan_cache(dmgr),
+        m_solver_cache(dmgr, solver_f) {
     DEBUG_INIT("vsc::solvers::CompoundSolver", dmgr);
+    m_plan_cache.setStats(&m_stats);
+    m_solver_cache.setStats(&m_stats);
+    if (fallback_f) {
+        m_fallback_cache = std::unique_ptr<SolverCache>(
+            new SolverCache(dmgr, fallback_f));
+        m_fallback_cache->setStats(&m_stats);
+    }
+
+    // Solvers and factory state are keyed on solve sets owned by
+    // the plan, so they are released along with the plan
+    m_plan_cache.setEvictListener([this, fallback_f](SolvePlan *plan) {
+        for (std::vector<ISolveSetUP>::const_iterator
+            it=plan->getSolveSets().begin();
+            it!=plan->getSolveSets().end(); it++) {
+            m_solver_cache.remove(it->get());
+            m_solver_f->releaseSolveSet(it->get());
+            if (m_fallback_cache) {
+                m_fallback_cache->remove(it->get());
+                fallback_f->releaseSolveSet(it->get());
+            }
+            m_stats.releaseSolveSet(it->get());
+        }
+    });
 }
 
 CompoundSolver::~CompoundSolver() {
@@ -47,36 +76,340 @@ bool CompoundSolver::randomize(
             const RefPathSet                            &include_constraints,
             const RefPathSet                            &exclude_constraints,
 			SolveFlags								    flags) {
-    std::vector<ISolveSetUP>    solvesets;
-    RefPathSet                  unconstrained;
+    // Partitioning only depends on the root type and the
+    // path sets, so re-use a prepared plan when one exists
+    SolvePlan *plan = m_plan_cache.getPlan(
+        root_field,
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints);
+
+    return randomizePlan(randstate, root_field, plan, flags);
+}
+
+bool CompoundSolver::randomize(
+			IRandState								    *randstate,
+            dm::IModelField                             *root_field,
+            const RefPathSnapshot                       &target_fields,
+            const RefPathSnapshot                       &fixed_fields,
+            const RefPathSnapshot                       &include_constraints,
+            const RefPathSnapshot                       &exclude_constraints,
+			SolveFlags								    flags) {
+    SolvePlan *plan = m_plan_cache.getPlan(
+        root_field,
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints);
+
+    return randomizePlan(randstate, root_field, plan, flags);
+}
 
-    TaskBuildSolveSets(
-        m_dmgr,
+bool CompoundSolver::randomizeN(
+			IRandState								    *randstate,
+            dm::IModelField                             *root_field,
+            uint32_t                                    count,
+            const RefPathSet                            &target_fields,
+            const RefPathSet                            &fixed_fields,
+            const RefPathSet                            &include_constraints,
+            const RefPathSet                            &exclude_constraints,
+			SolveFlags								    flags,
+            const std::vector<std::vector<int32_t>>     &columns,
+            uint64_t                                    *data) {
+    DEBUG_ENTER("randomizeN count=%d columns=%d", count, columns.size());
+    SolvePlan *plan = m_plan_cache.getPlan(
         root_field,
         target_fields,
         fixed_fields,
         include_constraints,
-        exclude_constraints).build(solvesets, unconstrained);
+        exclude_constraints);
+
+    // Field storage doesn't move between solutions, so column
+    // references and value kinds are resolved once for the whole batch
+    std::vector<dm::ValRef> column_v;
+    std::vector<ValKind> kind_v;
+    std::vector<bool> signed_v;
+    for (std::vector<std::vector<int32_t>>::const_iterator
+        it=columns.begin();
+        it!=columns.end(); it++) {
+        bool is_signed = false;
+        ValKind kind = TaskPath2ValKind(root_field).toKind(*it, &is_signed);
+
+        if (kind == ValKind::Other) {
+            DEBUG_ERROR("randomizeN: column %d is not a scalar field",
+                static_cast<int32_t>(it-columns.begin()));
+            DEBUG_LEAVE("randomizeN -- bad column");
+            return false;
+        }
+
+        column_v.push_back(TaskPath2ValRef(root_field).toMutVal(*it));
+        kind_v.push_back(kind);
+        signed_v.push_back(is_signed);
+    }
+
+    bool ret = true;
+    for (uint32_t i=0; i<count; i++) {
+        if (!randomizePlan(randstate, root_field, plan, flags)) {
+            if ((flags & SolveFlags::DiagnoseFailures) == SolveFlags::DiagnoseFailures) {
+                DEBUG_ERROR("randomizeN: solution %d of %d failed", i, count);
+            }
+            ret = false;
+            break;
+        }
+
+        for (uint32_t c=0; c<column_v.size(); c++) {
+            switch (kind_v.at(c)) {
+                case ValKind::Bool: {
+                    dm::ValRefBool val(column_v.at(c));
+                    data[c*count+i] = val.get_val();
+                } break;
+                default: {
+                    // Signed values are stored sign-extended, such that 
+                    // they read back correctly as int64_t
+                    dm::ValRefInt val(column_v.at(c));
+                    data[c*count+i] = (signed_v.at(c))?
+                        static_cast<uint64_t>(val.get_val_s()):val.get_val_u();
+                } break;
+            }
+        }
+    }
+
+    DEBUG_LEAVE("randomizeN %d", ret);
+    return ret;
+}
+
+bool CompoundSolver::randomizePlan(
+        IRandState                          *randstate,
+        dm::IModelField                     *root_field,
+        SolvePlan                           *plan,
+        SolveFlags                          flags) {
+    SolverStatsTimer timer(&m_stats.getPhase(SolverStatsPhase::Randomize));
+    bool ret = true;
 
     // First, randomize any unconstrained fields
-    if (!unconstrained.empty()) {
-        RefPathSet fixed_fields;
+    if (!plan->getUnconstrained().empty()) {
         m_solver_unconstrained.randomize(
             randstate,
             root_field,
-            unconstrained);
+            plan->getUnconstrained());
     }
 
+    // Solve sets that are UNSAT are counted as they complete. Those
+    // that timed out are counted by the backend
+    if (m_pool) {
+        ret = randomizeParallel(randstate, root_field, plan, flags);
+    } else {
+        ret = randomizeSequential(randstate, root_field, plan, flags);
+    }
+
+    return ret;
+}
+
+bool CompoundSolver::randomizeSequential(
+        IRandState                          *randstate,
+        dm::IModelField                     *root_field,
+        SolvePlan                           *plan,
+        SolveFlags                          flags) {
+    bool ret = true;
+
     // Now, move on
     for (std::vector<ISolveSetUP>::const_iterator
-        it=solvesets.begin();
-        it!=solvesets.end(); it++) {
-        ISolverUP solver(m_solver_f->mkSolver(it->get()));
-        if (!solver->randomize(randstate, root_field, it->get())) {
+        it=plan->getSolveSets().begin();
+        it!=plan->getSolveSets().end(); it++) {
+        // Each solve set draws from its own fork, as in 
+        // randomizeParallel, so results don't depend on whether
+        // a thread pool is in use
+        IRandStateUP rs(randstate->fork());
+
+        // Solver instances persist across calls, keeping the 
+        // asserted formula and learned state for re-use
+        ISolver *solver = m_solver_cache.getSolver(it->get());
+        SolverResult result = solver->randomize(rs.get(), root_field, it->get());
+        if (result == SolverResult::Timeout || 
+                result == SolverResult::Unsupported) {
+            result = fallback(rs.get(), root_field, it->get(), result);
+        }
+        if (result != SolverResult::Sat) {
+            if (result == SolverResult::Unsat) {
+                m_stats.inc(SolverStatsCounter::Unsat);
+            }
+            diagnose(flags, it->get(), result);
+            ret = false;
         }
     }
 
-    return true;
+    return ret;
+}
+
+bool CompoundSolver::randomizeParallel(
+        IRandState                          *randstate,
+        dm::IModelField                     *root_field,
+        SolvePlan                           *plan,
+        SolveFlags                          flags) {
+    DEBUG_ENTER("randomizeParallel");
+    const std::vector<ISolveSetUP> &solvesets = plan->getSolveSets();
+    bool ret = true;
+
+    // Fork a random state per solve set in plan order. This makes 
+    // results independent of the number of threads and of the 
+    // order in which solve sets complete.
+    std::vector<IRandStateUP> randstates;
+    for (uint32_t i=0; i<solvesets.size(); i++) {
+        randstates.push_back(IRandStateUP(randstate->fork()));
+    }
+
+    // Submit the most-expensive solve sets first
+    std::vector<uint32_t> order;
+    for (uint32_t i=0; i<solvesets.size(); i++) {
+        order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [&solvesets](uint32_t a, uint32_t b) {
+            return solvesets.at(a)->getCost() > solvesets.at(b)->getCost();
+        });
+
+    // All solvers in a batch must be resident in the solver cache 
+    // at once, so batches are bounded by the cache size
+    uint32_t batch_sz = m_solver_cache.getMaxSize();
+    if (!batch_sz) {
+        batch_sz = 1;
+    }
+
+    std::vector<SolverResult> results(solvesets.size(), SolverResult::Sat);
+    std::vector<ThreadPool::Task> tasks;
+    for (uint32_t base=0; base<order.size(); base+=batch_sz) {
+        tasks.clear();
+        for (uint32_t i=base; i<order.size() && i<base+batch_sz; i++) {
+            uint32_t idx = order.at(i);
+            ISolveSet *solveset = solvesets.at(idx).get();
+            ISolver *solver = m_solver_cache.getSolver(solveset);
+            IRandState *rs = randstates.at(idx).get();
+            SolverResult *result = &results.at(idx);
+            tasks.push_back([solver, rs, root_field, solveset, result]() {
+                *result = solver->randomize(rs, root_field, solveset);
+            });
+        }
+        m_pool->run(tasks);
+    }
+
+    // Fallback solvers aren't shared with the workers, so timed-out
+    // solve sets are handled on the calling thread in plan order
+    for (uint32_t i=0; i<results.size(); i++) {
+        if (results.at(i) == SolverResult::Timeout ||
+                results.at(i) == SolverResult::Unsupported) {
+            results.at(i) = fallback(
+                randstates.at(i).get(), 
+                root_field, 
+                solvesets.at(i).get(),
+                results.at(i));
+        }
+        if (results.at(i) != SolverResult::Sat) {
+            if (results.at(i) == SolverResult::Unsat) {
+                m_stats.inc(SolverStatsCounter::Unsat);
+            }
+            diagnose(flags, solvesets.at(i).get(), results.at(i));
+            ret = false;
+        }
+    }
+
+    DEBUG_LEAVE("randomizeParallel");
+    return ret;
+}
+
+void CompoundSolver::setNumThreads(uint32_t n_threads) {
+    if (!n_threads) {
+        m_pool.reset();
+    } else if (!m_pool || m_pool->size() != n_threads) {
+        m_pool = ThreadPoolUP(new ThreadPool(n_threads));
+    }
+}
+
+uint32_t CompoundSolver::getNumThreads() const {
+    return (m_pool)?m_pool->size():0;
+}
+
+void CompoundSolver::setPoolSize(uint32_t size) {
+    m_solver_cache.setPoolSize(size);
+}
+
+uint32_t CompoundSolver::getPoolSize() const {
+    return m_solver_cache.getPoolSize();
+}
+
+void CompoundSolver::setBudget(const SolverBudget &budget) {
+    m_solver_cache.setBudget(budget);
+    if (m_fallback_cache) {
+        // The fallback engine is bounded by the same limits, but
+        // doesn't fall back any further
+        m_fallback_cache->setBudget(SolverBudget(
+            budget.call_ms, 
+            budget.solveset_ms, 
+            SolverFallback::Fail,
+            budget.conflicts));
+    }
+}
+
+const SolverBudget &CompoundSolver::getBudget() const {
+    return m_solver_cache.getBudget();
+}
+
+SolverResult CompoundSolver::fallback(
+        IRandState                          *randstate,
+        dm::IModelField                     *root_field,
+        ISolveSet                           *solveset,
+        SolverResult                        result) {
+    DEBUG_ENTER("fallback");
+    const SolverBudget &budget = m_solver_cache.getBudget();
+
+    // The 'Previous' fallback is applied by the backend, since 
+    // only the backend knows which solution is still valid. 
+    // Solve sets that the backend can't lower always fall back
+    if ((budget.fallback == SolverFallback::Engine || 
+            result == SolverResult::Unsupported) && m_fallback_cache) {
+        SolverResult f_result = m_fallback_cache->getSolver(solveset)->randomize(
+            randstate,
+            root_field,
+            solveset);
+        if (f_result != SolverResult::Timeout && 
+                f_result != SolverResult::Unsupported) {
+            m_stats.inc(SolverStatsCounter::Fallback);
+            DEBUG_LEAVE("fallback -- engine %d", static_cast<int32_t>(f_result));
+            return f_result;
+        }
+    }
+
+    if (result == SolverResult::Unsupported) {
+        DEBUG_LEAVE("fallback -- unsupported");
+        return result;
+    }
+
+    DEBUG_ERROR("solve set with %zu fields and %zu constraints exceeded its "
+        "budget (call: %ums ; solve set: %ums ; conflicts: %u)",
+        static_cast<size_t>(solveset->getFields().size()),
+        static_cast<size_t>(solveset->getConstraints().size()),
+        budget.call_ms,
+        budget.solveset_ms,
+        budget.conflicts);
+
+    DEBUG_LEAVE("fallback -- timeout");
+    return SolverResult::Timeout;
+}
+
+void CompoundSolver::diagnose(
+        SolveFlags                          flags,
+        ISolveSet                           *solveset,
+        SolverResult                        result) {
+    if ((flags & SolveFlags::DiagnoseFailures) != SolveFlags::DiagnoseFailures) {
+        return;
+    }
+
+    DEBUG_ERROR("solve set with %zu fields and %zu constraints is %s",
+        static_cast<size_t>(solveset->getFields().size()),
+        static_cast<size_t>(solveset->getConstraints().size()),
+        (result == SolverResult::Timeout)?"out of budget":
+        (result == SolverResult::Unsupported)?"not supported by the backend":
+        "UNSAT");
 }
 
 bool CompoundSolver::sat(
@@ -86,7 +419,65 @@ bool CompoundSolver::sat(
             const RefPathSet                            &include_constraints,
             const RefPathSet                            &exclude_constraints,
 			SolveFlags								    flags) {
-    return true;
+    DEBUG_ENTER("sat");
+    SolverStatsTimer timer(&m_stats.getPhase(SolverStatsPhase::Sat));
+    // Shares plans and solver instances with randomize, such that
+    // checking right after randomizing re-uses the built formula
+    SolvePlan *plan = m_plan_cache.getPlan(
+        root_field,
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints);
+    const std::vector<ISolveSetUP> &solvesets = plan->getSolveSets();
+
+    // Unconstrained fields are always satisfiable. Check the cheapest
+    // solve sets first, since the first UNSAT set decides the result
+    std::vector<uint32_t> order;
+    for (uint32_t i=0; i<solvesets.size(); i++) {
+        order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [&solvesets](uint32_t a, uint32_t b) {
+            return solvesets.at(a)->getCost() < solvesets.at(b)->getCost();
+        });
+
+    bool ret = true;
+    for (std::vector<uint32_t>::const_iterator
+        it=order.begin();
+        it!=order.end(); it++) {
+        ISolveSet *solveset = solvesets.at(*it).get();
+        SolverResult result = m_solver_cache.getSolver(solveset)->sat(
+            root_field, 
+            solveset);
+        if (result == SolverResult::Unsupported && m_fallback_cache) {
+            result = m_fallback_cache->getSolver(solveset)->sat(
+                root_field, 
+                solveset);
+        }
+
+        if (result == SolverResult::Unsat) {
+            DEBUG("solve set %d is UNSAT", *it);
+            m_stats.inc(SolverStatsCounter::Unsat);
+            diagnose(flags, solveset, result);
+            ret = false;
+            break;
+        } else if (result != SolverResult::Sat) {
+            // Satisfiability is unknown, so the set can't be reported
+            // as satisfiable. It isn't counted as UNSAT
+            DEBUG_ERROR("satisfiability of solve set with %zu fields and "
+                "%zu constraints is unknown (%s)",
+                static_cast<size_t>(solveset->getFields().size()),
+                static_cast<size_t>(solveset->getConstraints().size()),
+                (result == SolverResult::Timeout)?
+                    "out of budget":"not supported by the backend");
+            ret = false;
+            break;
+        }
+    }
+
+    DEBUG_LEAVE("sat %d", ret);
+    return ret;
 }
 
 dmgr::IDebug *CompoundSolver::m_dbg = 0;
@@ -22,16 +22,24 @@
 #include "dmgr/IDebugMgr.h"
 #include "vsc/solvers/ISolverFactory.h"
 #include "vsc/solvers/ICompoundSolver.h"
+#include "SolvePlanCache.h"
+#include "SolverCache.h"
 #include "SolverUnconstrained.h"
+#include "ThreadPool.h"
 
 namespace vsc {
 namespace solvers {
 
 class CompoundSolver : public ICompoundSolver {
 public:
+    /**
+     * 'fallback_f', when non-null, creates the cheaper engine used 
+     * for solve sets that exceed an 'Engine' fallback budget
+     */
     CompoundSolver(
         dmgr::IDebugMgr     *dmgr,
-        ISolverFactory      *solver_f
+        ISolverFactory      *solver_f,
+        ISolverFactory      *fallback_f=0
     );
 
     virtual ~CompoundSolver();
@@ -45,6 +53,15 @@ public:
             const RefPathSet                            &exclude_constraints,
 			SolveFlags								    flags) override;
 
+	virtual bool randomize(
+			IRandState								    *randstate,
+            dm::IModelField                             *root_field,
+            const RefPathSnapshot                       &target_fields,
+            const RefPathSnapshot                       &fixed_fields,
+            const RefPathSnapshot                       &include_constraints,
+            const RefPathSnapshot                       &exclude_constraints,
+			SolveFlags								    flags) override;
+
 	virtual bool sat(
             dm::IModelField                             *root_field,
             const RefPathSet                            &target_fields,
@@ -53,11 +70,85 @@ public:
             const RefPathSet                            &exclude_constraints,
 			SolveFlags								    flags) override;
 
+	virtual bool randomizeN(
+			IRandState								    *randstate,
+            dm::IModelField                             *root_field,
+            uint32_t                                    count,
+            const RefPathSet                            &target_fields,
+            const RefPathSet                            &fixed_fields,
+            const RefPathSet                            &include_constraints,
+            const RefPathSet                            &exclude_constraints,
+			SolveFlags								    flags,
+            const std::vector<std::vector<int32_t>>     &columns,
+            uint64_t                                    *data) override;
+
+	virtual void setNumThreads(uint32_t n_threads) override;
+
+	virtual uint32_t getNumThreads() const override;
+
+	virtual void setPoolSize(uint32_t size) override;
+
+	virtual uint32_t getPoolSize() const override;
+
+	virtual void setBudget(const SolverBudget &budget) override;
+
+	virtual const SolverBudget &getBudget() const override;
+
+	virtual SolverStats &getStats() override { return m_stats; }
+
+	virtual void resetStats() override { m_stats.reset(); }
+
+    SolvePlanCache &getPlanCache() { return m_plan_cache; }
+
+    SolverCache &getSolverCache() { return m_solver_cache; }
+
+private:
+    bool randomizePlan(
+        IRandState                          *randstate,
+        dm::IModelField                     *root_field,
+        SolvePlan                           *plan,
+        SolveFlags                          flags);
+
+    bool randomizeSequential(
+        IRandState                          *randstate,
+        dm::IModelField                     *root_field,
+        SolvePlan                           *plan,
+        SolveFlags                          flags);
+
+    bool randomizeParallel(
+        IRandState                          *randstate,
+        dm::IModelField                     *root_field,
+        SolvePlan                           *plan,
+        SolveFlags                          flags);
+
+    /**
+     * Handles a solve set for which the backend returned 'result'
+     * (Timeout or Unsupported)
+     */
+    SolverResult fallback(
+        IRandState                          *randstate,
+        dm::IModelField                     *root_field,
+        ISolveSet                           *solveset,
+        SolverResult                        result);
+
+    /**
+     * Reports a failed solve set when 'flags' requests diagnostics
+     */
+    void diagnose(
+        SolveFlags                          flags,
+        ISolveSet                           *solveset,
+        SolverResult                        result);
+
 private:
     static dmgr::IDebug                 *m_dbg;
     dmgr::IDebugMgr                     *m_dmgr;
     ISolverFactory                      *m_solver_f;
+    SolverStats                         m_stats;
     SolverUnconstrained                 m_solver_unconstrained;
+    SolvePlanCache                      m_plan_cache;
+    SolverCache                         m_solver_cache;
+    std::unique_ptr<SolverCache>        m_fallback_cache;
+    ThreadPoolUP                        m_pool;
 
 };
 
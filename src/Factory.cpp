@@ -1,4 +1,5 @@
 
+#include <stdio.h>
 #include <unistd.h>
 #include "Factory.h"
 #include "CompoundSolver.h"
@@ -7,7 +8,11 @@
 #include "RandStateLehmer_64_dual.h"
 #include "RandStateLehmer_32.h"
 #include "vsc/solvers/FactoryExt.h"
+#include "SolverFactoryBitwuzla.h"
 #include "SolverFactoryBoolector.h"
+#include "SolverFactoryInterval.h"
+#include "SolverFactoryPortfolio.h"
+#include "SolverFactoryStrategy.h"
 
 namespace vsc {
 namespace solvers {
@@ -21,7 +26,12 @@ Factory::~Factory() {
 }
 
 ICompoundSolver *Factory::mkCompoundSolver() {
-    return new CompoundSolver(m_dmgr, getSolverFactory());
+    if (!m_fallback_f) {
+        // Solving without randomization preferences makes a single
+        // backend call per solution, which is the cheapest option
+        m_fallback_f = ISolverFactoryUP(new SolverFactoryBoolector(m_dmgr, 0, 0));
+    }
+    return new CompoundSolver(m_dmgr, getSolverFactory(), m_fallback_f.get());
 }
 
 IRandState *Factory::mkRandState(const std::string &seed) {
@@ -33,16 +43,72 @@ IRandState *Factory::mkRandState(const std::string &seed) {
 ISolverFactory *Factory::getSolverFactory() {
     if (!m_solver_f) {
         const char *vsc_solver_strategy = getenv("VSC_SOLVER_STRATEGY");
+        std::string strategy;
 
-        if (vsc_solver_strategy && vsc_solver_strategy[0]) {
+        if (vsc_solver_strategy) {
+            strategy = vsc_solver_strategy;
+        }
 
-        } else {
-            m_solver_f = ISolverFactoryUP(new SolverFactoryBoolector(m_dmgr));
+        ISolverFactory *solver_f = mkSolverFactory(strategy);
+        if (!solver_f) {
+            fprintf(stderr, 
+                "Warning: unknown VSC_SOLVER_STRATEGY \"%s\". Using default\n",
+                strategy.c_str());
+            solver_f = mkSolverFactory("");
         }
+        m_solver_f = ISolverFactoryUP(solver_f);
     }
     return m_solver_f.get();
 }
 
+ISolverFactory *Factory::mkSolverFactory(const std::string &strategy) {
+    // 'routed' solves with Boolector, except as noted below
+    bool routed = (strategy == "routed");
+    std::string backend = (strategy.size() && !routed)?strategy:"boolector";
+
+    ISolverFactory *backend_f = mkBackendFactory(backend);
+    if (!backend_f) {
+        return 0;
+    }
+
+    SolverFactoryStrategy *strategy_f = new SolverFactoryStrategy(
+        m_dmgr,
+        backend_f);
+    // Bound-only single-field sets are sampled directly
+    strategy_f->addStrategy(
+        SolveSetFlags::Domain,
+        new SolverFactoryInterval(
+            m_dmgr, 
+            mkBackendFactory(backend)));
+
+    if (routed) {
+        // Products and quotients of variables are costly to bit-blast
+        // eagerly, and are better handled by Bitwuzla. This is opt-in,
+        // since the Bitwuzla backend doesn't handle all the values
+        // that Boolector does
+        strategy_f->addStrategy(
+            SolveSetFlags::NonLinear,
+            mkBackendFactory("bitwuzla"));
+    }
+
+    return strategy_f;
+}
+
+ISolverFactory *Factory::mkBackendFactory(const std::string &name) {
+    if (name == "boolector") {
+        return new SolverFactoryBoolector(m_dmgr);
+    } else if (name == "bitwuzla") {
+        return new SolverFactoryBitwuzla(m_dmgr);
+    } else if (name == "portfolio") {
+        SolverFactoryPortfolio *portfolio_f = new SolverFactoryPortfolio(m_dmgr);
+        portfolio_f->addBackend(new SolverFactoryBoolector(m_dmgr));
+        portfolio_f->addBackend(new SolverFactoryBitwuzla(m_dmgr));
+        return portfolio_f;
+    } else {
+        return 0;
+    }
+}
+
 IFactory *Factory::inst() {
     if (!m_inst) {
         m_inst = FactoryUP(new Factory());
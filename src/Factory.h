@@ -1,6 +1,7 @@
 
 #pragma once
 #include <memory>
+#include <string>
 #include "vsc/solvers/IFactory.h"
 
 
@@ -31,11 +32,27 @@ public:
 
     static IFactory *inst();
 
+    /**
+     * Creates the per-solve-set engine selection for a strategy 
+     * name, as accepted by VSC_SOLVER_STRATEGY. An empty name selects
+     * Boolector, and 'routed' sends non-linear solve sets to Bitwuzla.
+     * Returns null if the name is unknown
+     */
+    ISolverFactory *mkSolverFactory(const std::string &strategy);
+
+private:
+    /**
+     * Creates the backend factory selected by name ('boolector',
+     * 'bitwuzla', or 'portfolio' to race both), or null if the name
+     * is unknown
+     */
+    ISolverFactory *mkBackendFactory(const std::string &name);
 
 private:
     static FactoryUP                    m_inst;
     dmgr::IDebugMgr                     *m_dmgr;
     ISolverFactoryUP                    m_solver_f;
+    ISolverFactoryUP                    m_fallback_f;
 
 };
 
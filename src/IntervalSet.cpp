@@ -0,0 +1,160 @@
+/*
+ * IntervalSet.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "IntervalSet.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+IntervalSet::IntervalSet() {
+
+}
+
+IntervalSet::IntervalSet(uint64_t lo, uint64_t hi) {
+    if (lo <= hi) {
+        m_intervals.push_back({lo, hi});
+    }
+}
+
+IntervalSet::~IntervalSet() {
+
+}
+
+void IntervalSet::intersect(const IntervalSet &rhs) {
+    std::vector<Interval> result;
+    std::vector<Interval>::const_iterator l_it = m_intervals.begin();
+    std::vector<Interval>::const_iterator r_it = rhs.m_intervals.begin();
+
+    while (l_it != m_intervals.end() && r_it != rhs.m_intervals.end()) {
+        uint64_t lo = (l_it->first > r_it->first)?l_it->first:r_it->first;
+        uint64_t hi = (l_it->second < r_it->second)?l_it->second:r_it->second;
+
+        if (lo <= hi) {
+            result.push_back({lo, hi});
+        }
+
+        // Advance whichever interval ends first
+        if (l_it->second < r_it->second) {
+            l_it++;
+        } else {
+            r_it++;
+        }
+    }
+
+    m_intervals.swap(result);
+}
+
+void IntervalSet::unite(const IntervalSet &rhs) {
+    std::vector<Interval> result;
+    std::vector<Interval>::const_iterator l_it = m_intervals.begin();
+    std::vector<Interval>::const_iterator r_it = rhs.m_intervals.begin();
+
+    while (l_it != m_intervals.end() || r_it != rhs.m_intervals.end()) {
+        Interval next;
+        if (r_it == rhs.m_intervals.end() || 
+                (l_it != m_intervals.end() && l_it->first <= r_it->first)) {
+            next = *l_it++;
+        } else {
+            next = *r_it++;
+        }
+
+        // Merge overlapping and adjacent intervals
+        if (result.size() && (result.back().second == UINT64_MAX ||
+                next.first <= result.back().second+1)) {
+            if (next.second > result.back().second) {
+                result.back().second = next.second;
+            }
+        } else {
+            result.push_back(next);
+        }
+    }
+
+    m_intervals.swap(result);
+}
+
+void IntervalSet::complement() {
+    std::vector<Interval> result;
+    uint64_t lo = 0;
+    bool done = false;
+
+    for (std::vector<Interval>::const_iterator
+        it=m_intervals.begin();
+        it!=m_intervals.end(); it++) {
+        if (it->first > lo) {
+            result.push_back({lo, it->first-1});
+        }
+        if (it->second == UINT64_MAX) {
+            done = true;
+            break;
+        }
+        lo = it->second+1;
+    }
+
+    if (!done) {
+        result.push_back({lo, UINT64_MAX});
+    }
+
+    m_intervals.swap(result);
+}
+
+uint64_t IntervalSet::count() const {
+    uint64_t ret = 0;
+    for (std::vector<Interval>::const_iterator
+        it=m_intervals.begin();
+        it!=m_intervals.end(); it++) {
+        // Wraps to 0 only when the full domain is covered
+        ret += (it->second - it->first) + 1;
+    }
+    return ret;
+}
+
+uint64_t IntervalSet::sample(IRandState *randstate) const {
+    uint64_t n = count();
+
+    if (!n) {
+        return randstate->rand_ui64();
+    }
+
+    // Reject the low values that would bias the modulo
+    uint64_t thresh = (0 - n) % n;
+    uint64_t r;
+    do {
+        r = randstate->rand_ui64();
+    } while (r < thresh);
+    r %= n;
+
+    for (std::vector<Interval>::const_iterator
+        it=m_intervals.begin();
+        it!=m_intervals.end(); it++) {
+        uint64_t sz = (it->second - it->first) + 1;
+        if (r < sz) {
+            return it->first + r;
+        }
+        r -= sz;
+    }
+
+    // Unreachable for a non-empty set
+    return m_intervals.front().first;
+}
+
+}
+}
@@ -0,0 +1,80 @@
+/**
+ * IntervalSet.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <stdint.h>
+#include <utility>
+#include <vector>
+#include "vsc/solvers/IRandState.h"
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * Set of disjoint, sorted, inclusive [lo,hi] intervals over the 
+ * 64-bit unsigned domain. Signed values are represented by flipping
+ * the sign bit, such that ordering is preserved.
+ */
+class IntervalSet {
+public:
+    using Interval=std::pair<uint64_t, uint64_t>;
+
+    IntervalSet();
+
+    IntervalSet(uint64_t lo, uint64_t hi);
+
+    virtual ~IntervalSet();
+
+    static IntervalSet full() { return IntervalSet(0, UINT64_MAX); }
+
+    bool empty() const { return m_intervals.empty(); }
+
+    const std::vector<Interval> &getIntervals() const { return m_intervals; }
+
+    void intersect(const IntervalSet &rhs);
+
+    void unite(const IntervalSet &rhs);
+
+    /**
+     * Replaces the set with the values it doesn't hold
+     */
+    void complement();
+
+    /**
+     * Returns the number of values in the set, or 0 
+     * when the set covers the full 64-bit domain
+     */
+    uint64_t count() const;
+
+    /**
+     * Selects a value uniformly from the set, which must be non-empty
+     */
+    uint64_t sample(IRandState *randstate) const;
+
+private:
+    std::vector<Interval>           m_intervals;
+
+};
+
+}
+}
+
+
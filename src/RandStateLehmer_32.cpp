@@ -7,6 +7,7 @@
 
 #include <random>
 #include "RandStateLehmer_32.h"
+#include "SplitMix64.h"
 
 namespace vsc {
 namespace solvers {
@@ -101,5 +102,16 @@ IRandState *RandStateLehmer_32::next() {
 	return clone(); 
 }
 
+IRandState *RandStateLehmer_32::fork() {
+	RandStateLehmer_32 *ret = new RandStateLehmer_32(*this);
+
+	// Seed the fork from a scrambled draw (mutating our state), such
+	// that the fork's sequence doesn't overlap with ours. The Lehmer
+	// state must be odd.
+	ret->m_state = (splitmix64(next_ui64()) | 1);
+
+	return ret;
+}
+
 }
 }
@@ -7,6 +7,7 @@
 
 #include <random>
 #include "RandStateLehmer_64.h"
+#include "SplitMix64.h"
 
 namespace vsc {
 namespace solvers {
@@ -94,5 +95,18 @@ IRandState *RandStateLehmer_64::next() {
 	return clone(); 
 }
 
+IRandState *RandStateLehmer_64::fork() {
+	RandStateLehmer_64 *ret = new RandStateLehmer_64(*this);
+
+	// Seed the fork from scrambled draws (mutating our state), such
+	// that the fork's sequence doesn't overlap with ours. The Lehmer
+	// state must be odd.
+	uint64_t hi = splitmix64(next_ui64());
+	uint64_t lo = splitmix64(next_ui64());
+	ret->m_state = ((static_cast<__uint128_t>(hi) << 64) | lo | 1);
+
+	return ret;
+}
+
 }
 }
@@ -7,6 +7,7 @@
 
 #include <random>
 #include "RandStateLehmer_64_dual.h"
+#include "SplitMix64.h"
 
 namespace vsc {
 namespace solvers {
@@ -109,5 +110,21 @@ IRandState *RandStateLehmer_64_dual::next() {
 	return clone(); 
 }
 
+IRandState *RandStateLehmer_64_dual::fork() {
+	RandStateLehmer_64_dual *ret = new RandStateLehmer_64_dual(*this);
+
+	// Seed the fork from scrambled draws (mutating our state), such
+	// that the fork's sequences don't overlap with ours. The Lehmer
+	// states must be odd.
+	uint64_t hi1 = splitmix64(next_ui64());
+	uint64_t lo1 = splitmix64(next_ui64());
+	uint64_t hi2 = splitmix64(next_ui64());
+	uint64_t lo2 = splitmix64(next_ui64());
+	ret->m_state1 = ((static_cast<__uint128_t>(hi1) << 64) | lo1 | 1);
+	ret->m_state2 = ((static_cast<__uint128_t>(hi2) << 64) | lo2 | 1);
+
+	return ret;
+}
+
 }
 }
@@ -46,6 +46,8 @@ public:
 
 	virtual IRandState *next() override;
 
+	virtual IRandState *fork() override;
+
 protected:
 	uint64_t next_ui64();
 
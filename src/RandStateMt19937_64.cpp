@@ -7,6 +7,7 @@
 
 #include <random>
 #include "RandStateMt19937_64.h"
+#include "SplitMix64.h"
 
 namespace vsc {
 namespace solvers {
@@ -91,5 +92,11 @@ IRandState *RandStateMt19937_64::next() {
 	return new RandStateMt19937_64(m_state);
 }
 
+IRandState *RandStateMt19937_64::fork() {
+	// Seed the fork from a scrambled draw (mutating our state), such
+	// that the fork's sequence doesn't overlap with ours
+	return new RandStateMt19937_64(std::mt19937_64(splitmix64(m_state())));
+}
+
 }
 }
@@ -0,0 +1,56 @@
+/*
+ * RefPathTable.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "RefPathTable.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+RefPathTable::RefPathTable() {
+
+}
+
+RefPathTable::~RefPathTable() {
+
+}
+
+int32_t RefPathTable::intern(const std::vector<int32_t> &path) {
+    int32_t id;
+    if (!m_id_m.find(path, id)) {
+        id = m_path_l.size();
+        m_id_m.add(path, id);
+        m_path_l.push_back(path);
+    }
+    return id;
+}
+
+int32_t RefPathTable::find(const std::vector<int32_t> &path) {
+    int32_t id;
+    if (!m_id_m.find(path, id)) {
+        id = -1;
+    }
+    return id;
+}
+
+}
+}
+
@@ -0,0 +1,74 @@
+/**
+ * RefPathTable.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <stdint.h>
+#include <memory>
+#include <vector>
+#include "vsc/solvers/impl/RefPathMap.h"
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * Interns reference paths to dense IDs, assigned in order of first use.
+ * Structures built from the table can be keyed by ID as flat vectors,
+ * with the path of an ID only looked up when crossing into the data
+ * model.
+ */
+class RefPathTable;
+using RefPathTableUP=std::unique_ptr<RefPathTable>;
+class RefPathTable {
+public:
+    RefPathTable();
+
+    virtual ~RefPathTable();
+
+    /**
+     * Returns the ID of a path, interning it if needed
+     */
+    int32_t intern(const std::vector<int32_t> &path);
+
+    /**
+     * Returns the ID of a path, or -1 if it has not been interned
+     */
+    int32_t find(const std::vector<int32_t> &path);
+
+    const std::vector<int32_t> &getPath(int32_t id) const {
+        return m_path_l.at(id);
+    }
+
+    const std::vector<std::vector<int32_t>> &getPaths() const {
+        return m_path_l;
+    }
+
+    uint32_t size() const { return m_path_l.size(); }
+
+private:
+    RefPathMap<int32_t>                         m_id_m;
+    std::vector<std::vector<int32_t>>           m_path_l;
+
+};
+
+}
+}
+
+
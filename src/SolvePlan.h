@@ -0,0 +1,70 @@
+/**
+ * SolvePlan.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <memory>
+#include <vector>
+#include "vsc/solvers/ISolveSet.h"
+#include "vsc/solvers/impl/RefPathSet.h"
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * A prepared randomization plan: the result of partitioning a root
+ * datatype into independent solve sets for a specific combination of
+ * target/fixed/include/exclude sets. Plans only hold type-relative
+ * paths, so a plan can be applied to any model field of the root type.
+ */
+class SolvePlan;
+using SolvePlanUP=std::unique_ptr<SolvePlan>;
+class SolvePlan {
+public:
+    SolvePlan();
+
+    virtual ~SolvePlan();
+
+    std::vector<ISolveSetUP> &getSolveSets() {
+        return m_solvesets;
+    }
+
+    const std::vector<ISolveSetUP> &getSolveSets() const {
+        return m_solvesets;
+    }
+
+    RefPathSet &getUnconstrained() {
+        return m_unconstrained;
+    }
+
+    const RefPathSet &getUnconstrained() const {
+        return m_unconstrained;
+    }
+
+private:
+    std::vector<ISolveSetUP>        m_solvesets;
+    RefPathSet                      m_unconstrained;
+
+};
+
+}
+}
+
+
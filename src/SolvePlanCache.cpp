@@ -0,0 +1,238 @@
+/*
+ * SolvePlanCache.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "dmgr/impl/DebugMacros.h"
+#include "SolvePlanCache.h"
+#include "TaskBuildSolveSets.h"
+#include "TaskBuildTypeDepGraph.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+SolvePlanCache::SolvePlanCache(
+    dmgr::IDebugMgr         *dmgr,
+    uint32_t                max_size) : m_dmgr(dmgr), m_max_size(max_size),
+        m_hits(0), m_misses(0), m_evictions(0), m_stats(0) {
+    DEBUG_INIT("vsc::solvers::SolvePlanCache", dmgr);
+}
+
+SolvePlanCache::~SolvePlanCache() {
+
+}
+
+SolvePlan *SolvePlanCache::getPlan(
+        dm::IModelField                         *root_field,
+        const RefPathSet                        &target_fields,
+        const RefPathSet                        &fixed_fields,
+        const RefPathSet                        &include_constraints,
+        const RefPathSet                        &exclude_constraints) {
+    DEBUG_ENTER("getPlan");
+
+    // Re-use the key storage across calls to avoid re-allocating
+    // the signature on every lookup
+    m_key.type = root_field->getDataType();
+    m_key.sets.clear();
+    appendSet(m_key.sets, target_fields);
+    appendSet(m_key.sets, fixed_fields);
+    appendSet(m_key.sets, include_constraints);
+    appendSet(m_key.sets, exclude_constraints);
+
+    std::map<Key, EntryL::iterator>::const_iterator it = m_plan_m.find(m_key);
+
+    if (it != m_plan_m.end()) {
+        m_hits++;
+        if (m_stats) {
+            m_stats->inc(SolverStatsCounter::PlanHit);
+        }
+        touch(it->second);
+        DEBUG_LEAVE("getPlan -- hit");
+        return it->second->plan.get();
+    }
+
+    m_misses++;
+    if (m_stats) {
+        m_stats->inc(SolverStatsCounter::PlanMiss);
+    }
+
+    SolvePlan *plan = new SolvePlan();
+    {
+        SolverStatsTimer timer((m_stats)?
+            &m_stats->getPhase(SolverStatsPhase::Partition):0);
+        TaskBuildSolveSets(
+            m_dmgr,
+            root_field,
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            getDepGraph(root_field->getDataType())).build(
+                plan->getSolveSets(),
+                plan->getUnconstrained());
+    }
+    m_graph_m.find(m_key.type)->second.n_plans++;
+
+    m_lru.push_front(Entry());
+    m_lru.front().key = m_key;
+    m_lru.front().plan = SolvePlanUP(plan);
+    m_lru.front().has_snapshot = false;
+    m_plan_m.insert({m_key, m_lru.begin()});
+
+    evict();
+
+    DEBUG_LEAVE("getPlan -- miss");
+    return plan;
+}
+
+SolvePlan *SolvePlanCache::getPlan(
+        dm::IModelField                         *root_field,
+        const RefPathSnapshot                   &target_fields,
+        const RefPathSnapshot                   &fixed_fields,
+        const RefPathSnapshot                   &include_constraints,
+        const RefPathSnapshot                   &exclude_constraints) {
+    DEBUG_ENTER("getPlan(snapshot)");
+    SnapshotKey key;
+    key.type = root_field->getDataType();
+    key.sets[0] = target_fields;
+    key.sets[1] = fixed_fields;
+    key.sets[2] = include_constraints;
+    key.sets[3] = exclude_constraints;
+
+    std::unordered_map<SnapshotKey, EntryL::iterator, SnapshotKeyHash>::const_iterator it =
+        m_snapshot_plan_m.find(key);
+
+    if (it != m_snapshot_plan_m.end()) {
+        m_hits++;
+        if (m_stats) {
+            m_stats->inc(SolverStatsCounter::PlanHit);
+        }
+        touch(it->second);
+        DEBUG_LEAVE("getPlan(snapshot) -- hit");
+        return it->second->plan.get();
+    }
+
+    // Plans are shared with path-set lookups, so an equivalent 
+    // plan is only built if neither form has been seen before
+    RefPathSet target_s, fixed_s, include_s, exclude_s;
+    target_fields.toSet(target_s);
+    fixed_fields.toSet(fixed_s);
+    include_constraints.toSet(include_s);
+    exclude_constraints.toSet(exclude_s);
+
+    SolvePlan *plan = getPlan(root_field, target_s, fixed_s, include_s, exclude_s);
+
+    // The plan just returned is always the most-recently-used entry
+    Entry &entry = m_lru.front();
+    entry.has_snapshot = true;
+    entry.snapshot = key;
+    m_snapshot_plan_m.insert({key, m_lru.begin()});
+
+    DEBUG_LEAVE("getPlan(snapshot)");
+    return plan;
+}
+
+TypeDepGraph *SolvePlanCache::getDepGraph(dm::IDataType *type) {
+    std::map<dm::IDataType *, GraphEntry>::const_iterator it = 
+        m_graph_m.find(type);
+
+    if (it != m_graph_m.end()) {
+        return it->second.graph.get();
+    }
+
+    TypeDepGraph *graph = TaskBuildTypeDepGraph(m_dmgr).build(type);
+    GraphEntry entry;
+    entry.graph = TypeDepGraphUP(graph);
+    entry.n_plans = 0;
+    m_graph_m.insert({type, std::move(entry)});
+    return graph;
+}
+
+void SolvePlanCache::clear() {
+    if (m_evict_l) {
+        for (EntryL::const_iterator
+            it=m_lru.begin();
+            it!=m_lru.end(); it++) {
+            m_evict_l(it->plan.get());
+        }
+    }
+    m_snapshot_plan_m.clear();
+    m_plan_m.clear();
+    m_lru.clear();
+    m_graph_m.clear();
+    m_hits = 0;
+    m_misses = 0;
+    m_evictions = 0;
+}
+
+void SolvePlanCache::setMaxSize(uint32_t max_size) {
+    m_max_size = max_size;
+    evict();
+}
+
+void SolvePlanCache::touch(EntryL::iterator it) {
+    if (it != m_lru.begin()) {
+        m_lru.splice(m_lru.begin(), m_lru, it);
+    }
+}
+
+void SolvePlanCache::evict() {
+    // Always retain the most-recently-used entry, since the 
+    // caller holds a reference to its plan
+    while (m_lru.size() > 1 && m_lru.size() > m_max_size) {
+        Entry &entry = m_lru.back();
+        DEBUG("Evicting plan %p", entry.plan.get());
+
+        if (m_evict_l) {
+            m_evict_l(entry.plan.get());
+        }
+
+        if (entry.has_snapshot) {
+            m_snapshot_plan_m.erase(entry.snapshot);
+        }
+        m_plan_m.erase(entry.key);
+
+        std::map<dm::IDataType *, GraphEntry>::iterator g_it = 
+            m_graph_m.find(entry.key.type);
+        if (g_it != m_graph_m.end() && !(--g_it->second.n_plans)) {
+            m_graph_m.erase(g_it);
+        }
+
+        m_lru.pop_back();
+        m_evictions++;
+    }
+}
+
+void SolvePlanCache::appendSet(
+        std::vector<int32_t>        &sig,
+        const RefPathSet            &set) {
+    // Each path is encoded as <len> <elems...>. Path elements are
+    // never negative, so -1 unambiguously terminates the set
+    set.forEach([&sig](const int32_t *path, uint32_t depth) {
+        sig.push_back(depth);
+        sig.insert(sig.end(), path, path+depth);
+    });
+    sig.push_back(-1);
+}
+
+dmgr::IDebug *SolvePlanCache::m_dbg = 0;
+
+}
+}
@@ -0,0 +1,184 @@
+/**
+ * SolvePlanCache.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <functional>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "dmgr/IDebugMgr.h"
+#include "vsc/dm/IModelField.h"
+#include "vsc/solvers/SolverStats.h"
+#include "vsc/solvers/impl/RefPathSet.h"
+#include "vsc/solvers/impl/RefPathSnapshot.h"
+#include "SolvePlan.h"
+#include "TypeDepGraph.h"
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * Caches prepared solve plans keyed on the root datatype and
+ * the content of the target/fixed/include/exclude path sets.
+ * Repeated randomizations of the same class with the same sets
+ * skip solve-set partitioning entirely. The dependency graph of each
+ * root type is also cached, such that new combinations of sets only
+ * need to re-partition the graph.
+ *
+ * The cache is bounded. Once more than 'max_size' plans are held, the
+ * least-recently-used plan is evicted, along with the dependency graph
+ * of its type once no other plan references it. The evict listener is
+ * notified before a plan is deleted, such that state keyed on its 
+ * solve sets can be released.
+ */
+class SolvePlanCache {
+public:
+    using EvictListener=std::function<void (SolvePlan *)>;
+
+    static const uint32_t DefaultMaxSize = 256;
+
+    SolvePlanCache(
+        dmgr::IDebugMgr         *dmgr,
+        uint32_t                max_size=DefaultMaxSize);
+
+    virtual ~SolvePlanCache();
+
+    SolvePlan *getPlan(
+        dm::IModelField                         *root_field,
+        const RefPathSet                        &target_fields,
+        const RefPathSet                        &fixed_fields,
+        const RefPathSet                        &include_constraints,
+        const RefPathSet                        &exclude_constraints);
+
+    /**
+     * Returns the plan for a set of snapshots. Lookups use the 
+     * snapshots' precomputed hashes, such that the sets are not 
+     * re-encoded on each call
+     */
+    SolvePlan *getPlan(
+        dm::IModelField                         *root_field,
+        const RefPathSnapshot                   &target_fields,
+        const RefPathSnapshot                   &fixed_fields,
+        const RefPathSnapshot                   &include_constraints,
+        const RefPathSnapshot                   &exclude_constraints);
+
+    TypeDepGraph *getDepGraph(dm::IDataType *type);
+
+    void clear();
+
+    void setMaxSize(uint32_t max_size);
+
+    uint32_t getMaxSize() const { return m_max_size; }
+
+    void setEvictListener(const EvictListener &listener) { m_evict_l = listener; }
+
+    uint32_t size() const { return m_plan_m.size(); }
+
+    uint32_t getNumDepGraphs() const { return m_graph_m.size(); }
+
+    uint64_t getNumEvictions() const { return m_evictions; }
+
+    uint64_t getNumHits() const { return m_hits; }
+
+    uint64_t getNumMisses() const { return m_misses; }
+
+    void setStats(SolverStats *stats) { m_stats = stats; }
+
+private:
+    struct Key {
+        dm::IDataType               *type;
+        std::vector<int32_t>        sets;
+
+        bool operator < (const Key &rhs) const {
+            if (type != rhs.type) {
+                return type < rhs.type;
+            }
+            return sets < rhs.sets;
+        }
+    };
+
+    struct SnapshotKey {
+        dm::IDataType               *type;
+        RefPathSnapshot             sets[4];
+
+        bool operator == (const SnapshotKey &rhs) const {
+            return (type == rhs.type 
+                && sets[0] == rhs.sets[0] && sets[1] == rhs.sets[1]
+                && sets[2] == rhs.sets[2] && sets[3] == rhs.sets[3]);
+        }
+    };
+
+    struct SnapshotKeyHash {
+        std::size_t operator()(const SnapshotKey &k) const {
+            uint64_t h = reinterpret_cast<uintptr_t>(k.type);
+            for (uint32_t i=0; i<4; i++) {
+                h = (h * 0x9e3779b97f4a7c15ULL) ^ k.sets[i].hash();
+            }
+            return h;
+        }
+    };
+
+    struct Entry {
+        Key                         key;
+        SolvePlanUP                 plan;
+        // Snapshot key that references this entry, if any. Equal
+        // snapshots have equal content, so there is at most one
+        bool                        has_snapshot;
+        SnapshotKey                 snapshot;
+    };
+    using EntryL=std::list<Entry>;
+
+    struct GraphEntry {
+        TypeDepGraphUP              graph;
+        uint32_t                    n_plans;
+    };
+
+    void appendSet(
+        std::vector<int32_t>        &sig,
+        const RefPathSet            &set);
+
+    void touch(EntryL::iterator it);
+
+    void evict();
+
+private:
+    static dmgr::IDebug                 *m_dbg;
+    dmgr::IDebugMgr                     *m_dmgr;
+    uint32_t                            m_max_size;
+    EvictListener                       m_evict_l;
+    // Entries in most-recently-used order
+    EntryL                              m_lru;
+    std::map<Key, EntryL::iterator>     m_plan_m;
+    std::unordered_map<SnapshotKey, EntryL::iterator, SnapshotKeyHash> m_snapshot_plan_m;
+    std::map<dm::IDataType *, GraphEntry>   m_graph_m;
+    Key                                 m_key;
+    uint64_t                            m_hits;
+    uint64_t                            m_misses;
+    uint64_t                            m_evictions;
+    SolverStats                         *m_stats;
+
+};
+
+}
+}
+
+
@@ -26,7 +26,8 @@ namespace vsc {
 namespace solvers {
 
 
-SolveSet::SolveSet() : m_max_bits(0), m_num_bits(0) {
+SolveSet::SolveSet() : m_flags(SolveSetFlags::NoFlags), 
+    m_max_bits(0), m_num_bits(0) {
     memset(m_size, 0, sizeof(m_size));
 }
 
@@ -35,15 +36,19 @@ SolveSet::~SolveSet() {
 }
 
 void SolveSet::setFlag(SolveSetFlags flags) {
-
+    m_flags = m_flags | flags;
 }
 
 void SolveSet::addField(
     const std::vector<int32_t>  &path, 
     SolveSetFieldType           type,
-    int32_t                     bits) {
+    int32_t                     bits,
+    int32_t                     id) {
     if (m_field_s.add(path, type)) {
         m_size[(uint32_t)type]++;
+        if (id != -1) {
+            m_field_id_l.push_back(id);
+        }
     }
     if (bits > 0) {
         if (bits > m_max_bits) {
@@ -53,14 +58,25 @@ void SolveSet::addField(
     }
 }
 
-void SolveSet::addConstraint(const std::vector<int32_t> &path) {
-    m_constraint_s.add(path);
-};
+void SolveSet::addConstraint(
+    const std::vector<int32_t>  &path,
+    int32_t                     id) {
+    if (m_constraint_s.add(path) && id != -1) {
+        m_constraint_id_l.push_back(id);
+    }
+}
 
 int32_t SolveSet::size(SolveSetFieldType type) const {
     return m_size[(uint32_t)type];
 }
 
+uint64_t SolveSet::getCost() const {
+    // Solving effort grows with both the number of variables
+    // and the number of constraints relating them
+    return static_cast<uint64_t>(m_field_s.size()+1) * 
+        (m_constraint_s.size()+1) + m_num_bits;
+}
+
 void SolveSet::merge(SolveSet *rhs) {
     for (RefPathMap<SolveSetFieldType>::iterator 
         it=rhs->getFields().begin(); it.next(); ) {
@@ -70,6 +86,13 @@ void SolveSet::merge(SolveSet *rhs) {
         it=rhs->getConstraints().begin(); it.next(); ) {
         addConstraint(it.path());
     }
+    // Partitions are disjoint, so IDs are never duplicated
+    m_field_id_l.insert(m_field_id_l.end(), 
+        rhs->m_field_id_l.begin(), rhs->m_field_id_l.end());
+    m_constraint_id_l.insert(m_constraint_id_l.end(), 
+        rhs->m_constraint_id_l.begin(), rhs->m_constraint_id_l.end());
+    // A merged set is never a single-field domain
+    m_flags = (m_flags | rhs->m_flags) & ~SolveSetFlags::Domain;
     if (rhs->m_max_bits > m_max_bits) {
         m_max_bits = rhs->m_max_bits;
     }
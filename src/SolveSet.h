@@ -37,12 +37,19 @@ public:
 
     void setFlag(SolveSetFlags flags);
 
+    /**
+     * Adds a field. 'id' is the field's ID in the dependency graph
+     * of the root type, if the field is known to the graph
+     */
     void addField(
         const std::vector<int32_t>  &path,
         SolveSetFieldType           type,
-        int32_t                     bits=-1);
+        int32_t                     bits=-1,
+        int32_t                     id=-1);
 
-    void addConstraint(const std::vector<int32_t> &path);
+    void addConstraint(
+        const std::vector<int32_t>  &path,
+        int32_t                     id=-1);
 
     virtual const RefPathMap<SolveSetFieldType> &getFields() const override {
         return m_field_s;
@@ -50,8 +57,22 @@ public:
 
     const RefPathSet &getConstraints() const { return m_constraint_s; }
 
+    /**
+     * Returns graph IDs of the fields added with an ID
+     */
+    const std::vector<int32_t> &getFieldIds() const { return m_field_id_l; }
+
+    /**
+     * Returns graph IDs of the constraints added with an ID
+     */
+    const std::vector<int32_t> &getConstraintIds() const { return m_constraint_id_l; }
+
+    virtual uint64_t getCost() const override;
+
     int32_t size(SolveSetFieldType type=SolveSetFieldType::Target) const;
 
+    uint32_t getMaxBits() const { return m_max_bits; }
+
     void merge(SolveSet *rhs);
 
 private:
@@ -62,6 +83,8 @@ private:
 
     RefPathMap<SolveSetFieldType>   m_field_s;
     RefPathSet                      m_constraint_s;
+    std::vector<int32_t>            m_field_id_l;
+    std::vector<int32_t>            m_constraint_id_l;
 
 
 };
@@ -0,0 +1,441 @@
+/*
+ * SolverBitwuzla.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "bitwuzla/bitwuzla.h"
+#include "dmgr/impl/DebugMacros.h"
+#include "vsc/solvers/impl/RefPathConstraint.h"
+#include "SolverBitwuzla.h"
+#include "SolverBitwuzlaConstraintBuilder.h"
+#include "SolverBitwuzlaFieldBuilder.h"
+#include "SolverBitwuzlaSetFieldValue.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+SolverBitwuzla::SolverBitwuzla(
+    dmgr::IDebugMgr                         *dmgr,
+    uint32_t                                swizzle_calls,
+    uint32_t                                swizzle_bits) : 
+    m_dmgr(dmgr), m_built(false), m_lowered(true),
+    m_swizzle_calls(swizzle_calls), m_swizzle_bits(swizzle_bits),
+    m_race(0), m_race_id(-1),
+    m_stats(0), m_backend_h(0), m_solveset_h(0) {
+    DEBUG_INIT("vsc::solvers::SolverBitwuzla", dmgr);
+
+    m_bzla = bitwuzla_new();
+    bitwuzla_set_option(m_bzla, BITWUZLA_OPT_INCREMENTAL, 1);
+    bitwuzla_set_option(m_bzla, BITWUZLA_OPT_PRODUCE_MODELS, 1);
+
+    // Polled during checks to abandon calls that lost a race
+    // or exceeded their budget
+    bitwuzla_set_termination_callback(m_bzla, &SolverBitwuzla::terminate, this);
+}
+
+SolverBitwuzla::~SolverBitwuzla() {
+    bitwuzla_delete(m_bzla);
+}
+
+SolverResult SolverBitwuzla::randomize(
+        IRandState                              *randstate,
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) {
+    DEBUG_ENTER("randomize");
+    SolverStatsTimer timer(getSolveSetHist(solveset));
+
+    if (!m_built) {
+        build(root_field, solveset);
+        m_built = true;
+    }
+
+    if (!m_lowered) {
+        // The caller may re-solve with another engine
+        DEBUG_LEAVE("randomize -- constraints not lowered");
+        return SolverResult::Unsupported;
+    }
+
+    bindFixedFields(root_field, solveset);
+    startBudget();
+
+    // Solve, preferring random values for a subset of target bits
+    int32_t result = solveSwizzled(randstate, solveset);
+
+    if (timedOut(result)) {
+        SolverResult ret = fallbackPrevious(root_field, solveset);
+        DEBUG_LEAVE("randomize -- timeout %d", static_cast<int32_t>(ret));
+        return ret;
+    }
+
+    if (!claim()) {
+        DEBUG_LEAVE("randomize -- lost race");
+        return SolverResult::Unsat;
+    }
+
+    if (result != BITWUZLA_SAT) {
+        DEBUG_LEAVE("randomize -- unsat");
+        return SolverResult::Unsat;
+    }
+
+    SolverStatsTimer rb_timer((m_stats)?
+        &m_stats->getPhase(SolverStatsPhase::Readback):0);
+    if (m_budget.fallback == SolverFallback::Previous) {
+        // Keep the solution for re-use if a later call times out
+        m_prev_key = m_fixed_l;
+        m_prev.clear();
+        for (RefPathMap<SolveSetFieldType>::iterator
+            it=solveset->getFields().begin(); it.next(); ) {
+            if (it.value() == SolveSetFieldType::Target) {
+                m_prev.push_back(bitwuzla_get_bv_value(
+                    m_bzla, 
+                    m_field_m.find(it.path())));
+            }
+        }
+        writeSolution(root_field, solveset, m_prev);
+    } else {
+        SolverBitwuzlaSetFieldValue setter(m_dmgr, m_bzla, root_field);
+        for (RefPathMap<SolveSetFieldType>::iterator
+            it=solveset->getFields().begin(); it.next(); ) {
+            if (it.value() == SolveSetFieldType::Target) {
+                setter.set(it.path(), m_field_m.find(it.path()));
+            }
+        }
+    }
+
+    DEBUG_LEAVE("randomize");
+    return SolverResult::Sat;
+}
+
+SolverResult SolverBitwuzla::sat(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) {
+    DEBUG_ENTER("sat");
+    SolverStatsTimer timer(getSolveSetHist(solveset));
+
+    if (!m_built) {
+        build(root_field, solveset);
+        m_built = true;
+    }
+
+    if (!m_lowered) {
+        DEBUG_LEAVE("sat -- constraints not lowered");
+        return SolverResult::Unsupported;
+    }
+
+    bindFixedFields(root_field, solveset);
+    assumeFixedFields();
+    startBudget();
+
+    int32_t result = solve();
+
+    if (timedOut(result)) {
+        DEBUG_LEAVE("sat -- timeout");
+        return SolverResult::Timeout;
+    }
+
+    if (!claim()) {
+        DEBUG_LEAVE("sat -- lost race");
+        return SolverResult::Unsat;
+    }
+
+    bool ret = (result == BITWUZLA_SAT);
+    DEBUG_LEAVE("sat %d", ret);
+    return (ret)?SolverResult::Sat:SolverResult::Unsat;
+}
+
+void SolverBitwuzla::build(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) {
+    DEBUG_ENTER("build");
+    SolverStatsTimer timer((m_stats)?
+        &m_stats->getPhase(SolverStatsPhase::Build):0);
+
+    // All fields are represented by variables. The value of fixed
+    // fields is bound with an assumption on each solve.
+    SolverBitwuzlaFieldBuilder builder(m_dmgr, m_bzla, root_field);
+    for (RefPathMap<SolveSetFieldType>::iterator
+        it=solveset->getFields().begin(); it.next(); ) {
+        m_field_m.add(
+            it.path(),
+            builder.build(it.path(), false));
+    }
+
+    // Create and assert all hard constraints
+    SolverBitwuzlaConstraintBuilder c_builder(m_dmgr, m_bzla, m_field_m, root_field);
+    for (RefPathSet::iterator
+        it=solveset->getConstraints().begin(); it.next(); ) {
+        const BitwuzlaTerm *c = c_builder.build(it.path());
+        if (c) {
+            bitwuzla_assert(m_bzla, c);
+        } else {
+            // Solving without the constraint could produce a
+            // solution that violates it
+            DEBUG_ERROR("constraint %s uses a construct not supported "
+                "by the Bitwuzla backend",
+                RefPathConstraint(it.path()).toString().c_str());
+            m_lowered = false;
+        }
+    }
+
+    DEBUG_LEAVE("build");
+}
+
+void SolverBitwuzla::bindFixedFields(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) {
+    DEBUG_ENTER("bindFixedFields");
+    m_fixed_l.clear();
+    SolverBitwuzlaFieldBuilder builder(m_dmgr, m_bzla, root_field);
+    for (RefPathMap<SolveSetFieldType>::iterator
+        it=solveset->getFields().begin(); it.next(); ) {
+        if (it.value() == SolveSetFieldType::Fixed) {
+            const BitwuzlaTerm *var = m_field_m.find(it.path());
+            const BitwuzlaTerm *val = builder.build(it.path(), true);
+            m_fixed_l.push_back(bitwuzla_mk_term2(
+                m_bzla, 
+                BITWUZLA_KIND_EQUAL, 
+                var, 
+                val));
+        }
+    }
+    DEBUG_LEAVE("bindFixedFields");
+}
+
+void SolverBitwuzla::assumeFixedFields() {
+    // Assumptions only apply to a single check, so the 
+    // bindings are re-assumed before each check
+    for (std::vector<const BitwuzlaTerm *>::const_iterator
+        it=m_fixed_l.begin();
+        it!=m_fixed_l.end(); it++) {
+        bitwuzla_assume(m_bzla, *it);
+    }
+}
+
+void SolverBitwuzla::setStats(SolverStats *stats) {
+    m_stats = stats;
+    m_backend_h = (stats)?&stats->getBackend("bitwuzla"):0;
+    m_solveset_h = 0;
+}
+
+int32_t SolverBitwuzla::solve() {
+    if (m_budget.limited()) {
+        m_deadline = m_solveset_deadline;
+        if (m_budget.call_ms) {
+            std::chrono::steady_clock::time_point call_deadline = 
+                std::chrono::steady_clock::now() + 
+                std::chrono::milliseconds(m_budget.call_ms);
+            if (call_deadline < m_deadline) {
+                m_deadline = call_deadline;
+            }
+        }
+    }
+
+    if (!m_stats) {
+        return bitwuzla_check_sat(m_bzla);
+    }
+
+    std::chrono::steady_clock::time_point start = 
+        std::chrono::steady_clock::now();
+    int32_t result = bitwuzla_check_sat(m_bzla);
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    m_stats->getPhase(SolverStatsPhase::Solve).record(ns);
+    m_backend_h->record(ns);
+
+    return result;
+}
+
+int32_t SolverBitwuzla::solveSwizzled(
+        IRandState                              *randstate,
+        ISolveSet                               *solveset) {
+    DEBUG_ENTER("solveSwizzled");
+    std::vector<const BitwuzlaTerm *> target_l;
+    std::vector<const BitwuzlaTerm *> pref_l;
+
+    if (m_swizzle_calls && m_swizzle_bits) {
+        for (RefPathMap<SolveSetFieldType>::iterator
+            it=solveset->getFields().begin(); it.next(); ) {
+            if (it.value() == SolveSetFieldType::Target) {
+                target_l.push_back(m_field_m.find(it.path()));
+            }
+        }
+    }
+
+    // Select random target bits, and a random preferred value for each.
+    // Assumptions must be Boolean, so each preference compares the bit
+    const BitwuzlaSort *bit_s = bitwuzla_mk_bv_sort(m_bzla, 1);
+    for (uint32_t i=0; target_l.size() && i<m_swizzle_bits; i++) {
+        uint64_t r = randstate->rand_ui64();
+        const BitwuzlaTerm *var = target_l.at(static_cast<uint32_t>(r) % target_l.size());
+        uint32_t bit = static_cast<uint32_t>(r >> 32) % bitwuzla_term_bv_get_size(var);
+        pref_l.push_back(bitwuzla_mk_term2(
+            m_bzla,
+            BITWUZLA_KIND_EQUAL,
+            bitwuzla_mk_term1_indexed2(m_bzla, BITWUZLA_KIND_BV_EXTRACT, var, bit, bit),
+            (r & (1ULL << 63))?
+                bitwuzla_mk_bv_one(m_bzla, bit_s):
+                bitwuzla_mk_bv_zero(m_bzla, bit_s)));
+    }
+
+    uint32_t n_calls = 0;
+    int32_t result;
+    while (true) {
+        assumeFixedFields();
+        for (std::vector<const BitwuzlaTerm *>::const_iterator
+            it=pref_l.begin();
+            it!=pref_l.end(); it++) {
+            bitwuzla_assume(m_bzla, *it);
+        }
+
+        result = solve();
+
+        // Stop on SAT, or when a termination callback abandoned the call
+        if (result != BITWUZLA_UNSAT || !pref_l.size()) {
+            break;
+        }
+
+        // Drop the preferences that contributed to the conflict
+        uint32_t n_pref = 0;
+        for (uint32_t i=0; i<pref_l.size(); i++) {
+            if (!bitwuzla_is_unsat_assumption(m_bzla, pref_l.at(i))) {
+                pref_l.at(n_pref++) = pref_l.at(i);
+            }
+        }
+
+        if (n_pref == pref_l.size()) {
+            // The conflict doesn't involve any preference, so
+            // the fixed-field values are unsatisfiable
+            break;
+        }
+        pref_l.resize(n_pref);
+
+        // Once the budget is reached, make the last call without preferences
+        if (++n_calls >= m_swizzle_calls) {
+            pref_l.clear();
+        }
+
+        if (m_stats) {
+            m_stats->inc(SolverStatsCounter::SwizzleRetry);
+        }
+    }
+
+    DEBUG_LEAVE("solveSwizzled %d (%d retries)", result, n_calls);
+    return result;
+}
+
+void SolverBitwuzla::startBudget() {
+    m_solveset_deadline = std::chrono::steady_clock::time_point::max();
+    if (m_budget.solveset_ms) {
+        m_solveset_deadline = std::chrono::steady_clock::now() + 
+            std::chrono::milliseconds(m_budget.solveset_ms);
+    }
+}
+
+bool SolverBitwuzla::timedOut(int32_t result) {
+    // Checks abandoned because another racer won aren't timeouts
+    if (result != BITWUZLA_UNKNOWN || (m_race && m_race->done())) {
+        return false;
+    }
+    if (m_stats) {
+        m_stats->inc(SolverStatsCounter::Timeout);
+    }
+    return true;
+}
+
+SolverResult SolverBitwuzla::fallbackPrevious(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) {
+    // Terms are hash-consed and never released, so bindings to
+    // the same values are the same terms
+    if (m_budget.fallback != SolverFallback::Previous ||
+            !m_prev.size() || m_prev_key != m_fixed_l) {
+        return SolverResult::Timeout;
+    }
+
+    if (!claim()) {
+        return SolverResult::Unsat;
+    }
+
+    DEBUG("Timeout: re-using the previous solution");
+    if (m_stats) {
+        m_stats->inc(SolverStatsCounter::Fallback);
+    }
+    writeSolution(root_field, solveset, m_prev);
+    return SolverResult::Sat;
+}
+
+void SolverBitwuzla::writeSolution(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset,
+        const std::vector<std::string>          &solution) {
+    SolverBitwuzlaSetFieldValue setter(m_dmgr, m_bzla, root_field);
+    uint32_t i = 0;
+    for (RefPathMap<SolveSetFieldType>::iterator
+        it=solveset->getFields().begin(); it.next(); ) {
+        if (it.value() == SolveSetFieldType::Target) {
+            setter.set(it.path(), solution.at(i++).c_str());
+        }
+    }
+}
+
+void SolverBitwuzla::setBudget(const SolverBudget &budget) {
+    m_budget = budget;
+    if (budget.fallback != SolverFallback::Previous) {
+        m_prev.clear();
+        m_prev_key.clear();
+    }
+}
+
+void SolverBitwuzla::setRace(SolverRace *race, int32_t id) {
+    m_race = race;
+    m_race_id = id;
+}
+
+bool SolverBitwuzla::claim() {
+    return (!m_race || m_race->claim(m_race_id));
+}
+
+int32_t SolverBitwuzla::terminate(void *ud) {
+    SolverBitwuzla *solver = reinterpret_cast<SolverBitwuzla *>(ud);
+    if (solver->m_race && solver->m_race->done() && 
+            solver->m_race->getWinner() != solver->m_race_id) {
+        return 1;
+    }
+    return (solver->m_budget.limited() && 
+        std::chrono::steady_clock::now() >= solver->m_deadline);
+}
+
+SolverStatsHist *SolverBitwuzla::getSolveSetHist(ISolveSet *solveset) {
+    // A solver instance is bound to a single solve set, so the
+    // entry is looked up once
+    if (m_stats && !m_solveset_h) {
+        m_solveset_h = &m_stats->getSolveSet(
+            solveset,
+            solveset->getFields().size(),
+            solveset->getConstraints().size(),
+            solveset->getCost()).solve;
+    }
+    return m_solveset_h;
+}
+
+dmgr::IDebug *SolverBitwuzla::m_dbg = 0;
+
+}
+}
@@ -0,0 +1,138 @@
+/**
+ * SolverBitwuzla.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+#include "dmgr/IDebugMgr.h"
+#include "vsc/solvers/ISolver.h"
+#include "vsc/solvers/impl/RefPathPtrMap.h"
+
+struct Bitwuzla;
+struct BitwuzlaTerm;
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * Solves a solve set with Bitwuzla. The structure follows the 
+ * Boolector backend: the formula is built and asserted once, fixed
+ * fields are bound with assumptions on each call, and randomization
+ * prefers random values for randomly-selected target bits. Terms are
+ * owned by the Bitwuzla instance, so nothing is released per call.
+ * Budgets and races stop checks through the termination callback.
+ * The Bitwuzla API has no conflict limit, so only time limits apply.
+ * A solve set with a constraint that can't be lowered is reported,
+ * and fails to solve rather than being solved without it.
+ */
+class SolverBitwuzla : public virtual ISolver {
+public:
+    static const uint32_t DefaultSwizzleCalls = 4;
+    static const uint32_t DefaultSwizzleBits = 32;
+
+    SolverBitwuzla(
+        dmgr::IDebugMgr                         *dmgr,
+        uint32_t                                swizzle_calls=DefaultSwizzleCalls,
+        uint32_t                                swizzle_bits=DefaultSwizzleBits);
+
+    virtual ~SolverBitwuzla();
+
+    virtual SolverResult randomize(
+        IRandState                              *randstate,
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) override;
+
+    virtual SolverResult sat(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) override;
+
+    virtual void setStats(SolverStats *stats) override;
+
+    virtual void setBudget(const SolverBudget &budget) override;
+
+    virtual void setRace(SolverRace *race, int32_t id) override;
+
+private:
+    void build(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset);
+
+    void bindFixedFields(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset);
+
+    void assumeFixedFields();
+
+    int32_t solve();
+
+    void startBudget();
+
+    bool timedOut(int32_t result);
+
+    SolverResult fallbackPrevious(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset);
+
+    void writeSolution(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset,
+        const std::vector<std::string>          &solution);
+
+    int32_t solveSwizzled(
+        IRandState                              *randstate,
+        ISolveSet                               *solveset);
+
+    SolverStatsHist *getSolveSetHist(ISolveSet *solveset);
+
+    bool claim();
+
+    static int32_t terminate(void *ud);
+
+private:
+    static dmgr::IDebug                         *m_dbg;
+    dmgr::IDebugMgr                             *m_dmgr;
+    struct Bitwuzla                             *m_bzla;
+    bool                                        m_built;
+    // All constraints of the solve set were lowered and asserted
+    bool                                        m_lowered;
+    RefPathPtrMap<const struct BitwuzlaTerm>    m_field_m;
+    std::vector<const struct BitwuzlaTerm *>    m_fixed_l;
+    uint32_t                                    m_swizzle_calls;
+    uint32_t                                    m_swizzle_bits;
+    SolverBudget                                m_budget;
+    std::chrono::steady_clock::time_point       m_solveset_deadline;
+    std::chrono::steady_clock::time_point       m_deadline;
+    // Last solution and its fixed-field bindings, for the 'Previous' fallback
+    std::vector<std::string>                    m_prev;
+    std::vector<const struct BitwuzlaTerm *>    m_prev_key;
+    SolverRace                                  *m_race;
+    int32_t                                     m_race_id;
+    SolverStats                                 *m_stats;
+    SolverStatsHist                             *m_backend_h;
+    SolverStatsHist                             *m_solveset_h;
+
+};
+
+}
+}
+
+
@@ -0,0 +1,426 @@
+/*
+ * SolverBitwuzlaConstraintBuilder.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "bitwuzla/bitwuzla.h"
+#include "dmgr/impl/DebugMacros.h"
+#include "vsc/dm/ITypeExprFieldRef.h"
+#include "vsc/dm/ITypeExprRange.h"
+#include "vsc/dm/ITypeExprRangelist.h"
+#include "vsc/dm/ITypeExprVal.h"
+#include "vsc/dm/impl/ValRefBool.h"
+#include "vsc/dm/impl/ValRefInt.h"
+#include "vsc/solvers/impl/RefPathPtrMap.h"
+#include "vsc/solvers/impl/RefPathField.h"
+#include "vsc/solvers/impl/TaskPath2Constraint.h"
+#include "vsc/solvers/impl/TaskPath2Field.h"
+#include "SolverBitwuzlaConstraintBuilder.h"
+#include "SolverBitwuzlaFieldBuilder.h"
+#include "ValRefIntWords.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+SolverBitwuzlaConstraintBuilder::SolverBitwuzlaConstraintBuilder(
+    dmgr::IDebugMgr                             *dmgr,
+    Bitwuzla                                    *bzla,
+    const RefPathPtrMap<const BitwuzlaTerm>     &field_m,
+    dm::IModelField                             *root_field) :
+    m_bzla(bzla), m_field_m(field_m), m_root_field(root_field),
+    m_expr({0, false, false}), m_rangelist(0), 
+    m_dt_mode(DataTypeMode::Literal) {
+    DEBUG_INIT("vsc::solvers::SolverBitwuzlaConstraintBuilder", dmgr);
+}
+
+SolverBitwuzlaConstraintBuilder::~SolverBitwuzlaConstraintBuilder() {
+
+}
+
+const BitwuzlaTerm *SolverBitwuzlaConstraintBuilder::build(const std::vector<int32_t> &path) {
+    DEBUG_ENTER("build");
+    m_expr = {0, false, false};
+
+    int32_t constraint_offset = *(path.begin());
+
+    m_path_prefix.clear();
+    m_path_prefix.insert(
+        m_path_prefix.begin(),
+        path.begin()+1,
+        path.begin()+constraint_offset);
+
+    // Now, locate and build the constraint
+    dm::ITypeConstraint *c = TaskPath2Constraint(m_root_field).toConstraint(path);
+
+    c->accept(m_this);
+
+    // Only Boolean terms can be asserted
+    if (m_expr.term) {
+        m_expr = booleanize(m_expr);
+    }
+
+    DEBUG_LEAVE("build");
+    return m_expr.term;
+}
+
+void SolverBitwuzlaConstraintBuilder::visitDataTypeBool(dm::IDataTypeBool *t) {
+    DEBUG_ENTER("visitDataTypeBool");
+    if (m_dt_mode == DataTypeMode::Literal) {
+        dm::ValRefBool val(m_val);
+
+        m_expr = {
+            bitwuzla_mk_bv_value_uint64(
+                m_bzla,
+                bitwuzla_mk_bv_sort(m_bzla, 1),
+                val.get_val()?1:0),
+            false,
+            false};
+    } else if (m_dt_mode == DataTypeMode::RefSign) {
+        m_expr.is_signed = false;
+    }
+    DEBUG_LEAVE("visitDataTypeBool");
+}
+
+void SolverBitwuzlaConstraintBuilder::visitDataTypeEnum(dm::IDataTypeEnum *t) {
+    if (m_dt_mode == DataTypeMode::Literal) {
+    } else if (m_dt_mode == DataTypeMode::RefSign) {
+    }
+}
+
+void SolverBitwuzlaConstraintBuilder::visitDataTypeInt(dm::IDataTypeInt *t) {
+    DEBUG_ENTER("visitDataTypeInt");
+    if (m_dt_mode == DataTypeMode::Literal) {
+        dm::ValRefInt val(m_val);
+        std::vector<uint64_t> words(ValRefIntWords::numWords(val.bits()));
+        ValRefIntWords::get(val, val.bits(), t->isSigned(), words.data());
+
+        m_expr = {
+            SolverBitwuzlaFieldBuilder::mkValue(m_bzla, val.bits(), words.data()),
+            t->isSigned(),
+            false
+        };
+    } else if (m_dt_mode == DataTypeMode::RefSign) {
+        m_expr.is_signed = t->isSigned();
+    }
+    DEBUG_LEAVE("visitDataTypeInt");
+}
+
+void SolverBitwuzlaConstraintBuilder::visitTypeConstraintExpr(dm::ITypeConstraintExpr *c) {
+    DEBUG_ENTER("visitTypeConstraintExpr");
+    c->expr()->accept(m_this);
+    DEBUG_LEAVE("visitTypeConstraintExpr");
+}
+
+void SolverBitwuzlaConstraintBuilder::visitTypeConstraintIfElse(dm::ITypeConstraintIfElse *c) { 
+
+}
+
+void SolverBitwuzlaConstraintBuilder::visitTypeConstraintImplies(dm::ITypeConstraintImplies *c) { 
+
+}
+
+void SolverBitwuzlaConstraintBuilder::visitTypeConstraintScope(dm::ITypeConstraintScope *c) { 
+    VisitorBase::visitTypeConstraintScope(c);
+}
+
+void SolverBitwuzlaConstraintBuilder::visitTypeConstraintUnique(dm::ITypeConstraintUnique *c) { 
+
+}
+
+void SolverBitwuzlaConstraintBuilder::visitTypeExprBin(dm::ITypeExprBin *e) { 
+    DEBUG_ENTER("visitTypeExprBin");
+    m_expr = {0, false, false};
+    m_rangelist = 0;
+    e->lhs()->accept(m_this);
+    ExprT lhs = m_expr;
+    dm::ITypeExprRangelist *lhs_l = m_rangelist;
+
+    m_expr = {0, false, false};
+    m_rangelist = 0;
+    e->rhs()->accept(m_this);
+    ExprT rhs = m_expr;
+    dm::ITypeExprRangelist *rhs_l = m_rangelist;
+    m_rangelist = 0;
+
+    // Membership (Eq) or non-membership (Ne) in a rangelist
+    if ((lhs_l || rhs_l) && 
+            (e->op() == dm::BinOp::Eq || e->op() == dm::BinOp::Ne)) {
+        m_expr = (lhs_l)?mkInside(rhs, lhs_l):mkInside(lhs, rhs_l);
+        if (m_expr.term && e->op() == dm::BinOp::Ne) {
+            m_expr.term = bitwuzla_mk_term1(m_bzla, BITWUZLA_KIND_NOT, m_expr.term);
+        }
+        DEBUG_LEAVE("visitTypeExprBin -- rangelist");
+        return;
+    }
+
+    if (!lhs.term || !rhs.term) {
+        DEBUG("Unsupported operand of operator %d", static_cast<int32_t>(e->op()));
+        m_expr = {0, false, false};
+        DEBUG_LEAVE("visitTypeExprBin -- unsupported operand");
+        return;
+    }
+
+    bool is_signed = lhs.is_signed && rhs.is_signed;
+
+    // Prepare operands
+    switch (e->op()) {
+        case dm::BinOp::LogAnd:
+        case dm::BinOp::LogOr: 
+        case dm::BinOp::LogXor: { // Operands must be boolean
+            lhs = booleanize(lhs);
+            rhs = booleanize(rhs);
+        } break;
+
+        default: { // Operands must be same-sized bit vectors
+            lhs = bitvectorize(lhs);
+            rhs = bitvectorize(rhs);
+            lhs = maxsize(lhs, rhs);
+            rhs = maxsize(rhs, lhs);
+        } break;
+    }
+
+    BitwuzlaKind kind;
+    bool is_bool = false;
+    switch (e->op()) {
+	    case dm::BinOp::Eq: kind = BITWUZLA_KIND_EQUAL; is_bool = true; break;
+        case dm::BinOp::Ne: kind = BITWUZLA_KIND_DISTINCT; is_bool = true; break;
+        case dm::BinOp::Gt: 
+            kind = (is_signed)?BITWUZLA_KIND_BV_SGT:BITWUZLA_KIND_BV_UGT;
+            is_bool = true;
+            break;
+        case dm::BinOp::Ge: 
+            kind = (is_signed)?BITWUZLA_KIND_BV_SGE:BITWUZLA_KIND_BV_UGE;
+            is_bool = true;
+            break;
+        case dm::BinOp::Lt: 
+            kind = (is_signed)?BITWUZLA_KIND_BV_SLT:BITWUZLA_KIND_BV_ULT;
+            is_bool = true;
+            break;
+        case dm::BinOp::Le: 
+            kind = (is_signed)?BITWUZLA_KIND_BV_SLE:BITWUZLA_KIND_BV_ULE;
+            is_bool = true;
+            break;
+        case dm::BinOp::Add: kind = BITWUZLA_KIND_BV_ADD; break;
+        case dm::BinOp::Sub: kind = BITWUZLA_KIND_BV_SUB; break;
+        case dm::BinOp::Div: 
+            kind = (is_signed)?BITWUZLA_KIND_BV_SDIV:BITWUZLA_KIND_BV_UDIV;
+            break;
+        case dm::BinOp::Mul: kind = BITWUZLA_KIND_BV_MUL; break;
+        case dm::BinOp::Mod: 
+            kind = (is_signed)?BITWUZLA_KIND_BV_SMOD:BITWUZLA_KIND_BV_UREM;
+            break;
+        case dm::BinOp::BinAnd: kind = BITWUZLA_KIND_BV_AND; break;
+        case dm::BinOp::BinOr: kind = BITWUZLA_KIND_BV_OR; break;
+        case dm::BinOp::BinXor: kind = BITWUZLA_KIND_BV_XOR; break;
+        case dm::BinOp::LogAnd: kind = BITWUZLA_KIND_AND; is_bool = true; break;
+        case dm::BinOp::LogOr: kind = BITWUZLA_KIND_OR; is_bool = true; break;
+        case dm::BinOp::LogXor: kind = BITWUZLA_KIND_XOR; is_bool = true; break;
+        case dm::BinOp::Sll: kind = BITWUZLA_KIND_BV_SHL; break;
+        case dm::BinOp::Srl: kind = BITWUZLA_KIND_BV_SHR; break;
+        default:
+            DEBUG("Unsupported operator %d", static_cast<int32_t>(e->op()));
+            m_expr = {0, false, false};
+            DEBUG_LEAVE("visitTypeExprBin -- unsupported");
+            return;
+    }
+
+    m_expr = {
+        bitwuzla_mk_term2(m_bzla, kind, lhs.term, rhs.term),
+        is_signed,
+        is_bool
+    };
+
+    DEBUG_LEAVE("visitTypeExprBin");
+}
+
+void SolverBitwuzlaConstraintBuilder::visitTypeExprRefBottomUp(dm::ITypeExprRefBottomUp *e) {
+    DEBUG_ENTER("visitTypeExprRefBottomUp");
+
+    DEBUG_LEAVE("visitTypeExprRefBottomUp");
+}
+
+void SolverBitwuzlaConstraintBuilder::visitTypeExprRefPath(dm::ITypeExprRefPath *e) {
+    DEBUG_ENTER("visitTypeExprRefPath");
+    int32_t prefix_sz = m_path_prefix.size();
+    e->getTarget()->accept(m_this);
+
+    m_path_prefix.insert(
+        m_path_prefix.end(),
+        e->getPath().begin(),
+        e->getPath().end()
+    );
+
+    m_expr.term = m_field_m.find(m_path_prefix);
+    m_expr.is_bool = false;
+
+    DEBUG("term @ %s: %p", RefPathField(m_path_prefix).toString().c_str(), m_expr.term);
+
+    DataTypeMode dt_mode = m_dt_mode;
+    m_dt_mode = DataTypeMode::RefSign;
+    TaskPath2Field(m_root_field).toField(m_path_prefix)->getDataType()->accept(m_this);
+    m_dt_mode = dt_mode;
+
+    m_path_prefix.resize(prefix_sz);
+    DEBUG_LEAVE("visitTypeExprRefPath");
+}
+
+void SolverBitwuzlaConstraintBuilder::visitTypeExprRefTopDown(dm::ITypeExprRefTopDown *e) {
+    DEBUG_ENTER("visitTypeExprRefTopDown");
+
+    DEBUG_LEAVE("visitTypeExprRefTopDown");
+}
+
+void SolverBitwuzlaConstraintBuilder::visitTypeExprFieldRef(dm::ITypeExprFieldRef *e) { 
+
+}
+
+void SolverBitwuzlaConstraintBuilder::visitTypeExprRangelist(dm::ITypeExprRangelist *e) { 
+    // A rangelist has no term of its own. The enclosing 
+    // comparison lowers it against the other operand
+    m_rangelist = e;
+    m_expr = {0, false, false};
+}
+
+void SolverBitwuzlaConstraintBuilder::visitTypeExprVal(dm::ITypeExprVal *e) { 
+    DEBUG_ENTER("visitTypeExprVal");
+    m_val = e->val();
+    e->val().type()->accept(m_this);
+
+    DEBUG_LEAVE("visitTypeExprVal");
+}
+
+SolverBitwuzlaConstraintBuilder::ExprT SolverBitwuzlaConstraintBuilder::booleanize(const ExprT &expr) {
+    if (expr.is_bool) {
+        return expr;
+    }
+
+    return {
+        bitwuzla_mk_term2(
+            m_bzla,
+            BITWUZLA_KIND_DISTINCT,
+            expr.term,
+            bitwuzla_mk_bv_zero(m_bzla, bitwuzla_term_get_sort(expr.term))),
+        expr.is_signed,
+        true};
+}
+
+SolverBitwuzlaConstraintBuilder::ExprT SolverBitwuzlaConstraintBuilder::bitvectorize(const ExprT &expr) {
+    if (!expr.is_bool) {
+        return expr;
+    }
+
+    const BitwuzlaSort *sort = bitwuzla_mk_bv_sort(m_bzla, 1);
+    return {
+        bitwuzla_mk_term3(
+            m_bzla,
+            BITWUZLA_KIND_ITE,
+            expr.term,
+            bitwuzla_mk_bv_one(m_bzla, sort),
+            bitwuzla_mk_bv_zero(m_bzla, sort)),
+        false,
+        false};
+}
+
+SolverBitwuzlaConstraintBuilder::ExprT SolverBitwuzlaConstraintBuilder::maxsize(const ExprT &expr, const ExprT &other) {
+    uint32_t expr_sz = bitwuzla_term_bv_get_size(expr.term);
+    uint32_t other_sz = bitwuzla_term_bv_get_size(other.term);
+    bool is_signed = (expr.is_signed && other.is_signed);
+
+    if (other_sz > expr_sz) {
+        return {
+            bitwuzla_mk_term1_indexed1(
+                m_bzla,
+                (is_signed)?BITWUZLA_KIND_BV_SIGN_EXTEND:BITWUZLA_KIND_BV_ZERO_EXTEND,
+                expr.term,
+                other_sz-expr_sz),
+            is_signed,
+            false};
+    } else {
+        return expr;
+    }
+}
+
+SolverBitwuzlaConstraintBuilder::ExprT SolverBitwuzlaConstraintBuilder::mkInside(
+        const ExprT                 &expr,
+        dm::ITypeExprRangelist      *rangelist) {
+    if (!expr.term) {
+        return {0, false, false};
+    }
+
+    ExprT val = bitvectorize(expr);
+    const BitwuzlaTerm *ret = 0;
+
+    for (std::vector<dm::ITypeExprRangeUP>::const_iterator
+        it=rangelist->getRanges().begin();
+        it!=rangelist->getRanges().end(); it++) {
+        m_expr = {0, false, false};
+        (*it)->lower()->accept(m_this);
+        if (!m_expr.term) {
+            return {0, false, false};
+        }
+        ExprT lo = bitvectorize(m_expr);
+        ExprT val_lo = maxsize(val, lo);
+        lo = maxsize(lo, val);
+        bool lo_signed = val_lo.is_signed && lo.is_signed;
+
+        const BitwuzlaTerm *in;
+        if ((*it)->isSingle() || !(*it)->upper()) {
+            in = bitwuzla_mk_term2(
+                m_bzla, 
+                BITWUZLA_KIND_EQUAL, 
+                val_lo.term, 
+                lo.term);
+        } else {
+            m_expr = {0, false, false};
+            (*it)->upper()->accept(m_this);
+            if (!m_expr.term) {
+                return {0, false, false};
+            }
+            ExprT hi = bitvectorize(m_expr);
+            ExprT val_hi = maxsize(val, hi);
+            hi = maxsize(hi, val);
+            bool hi_signed = val_hi.is_signed && hi.is_signed;
+
+            in = bitwuzla_mk_term2(
+                m_bzla,
+                BITWUZLA_KIND_AND,
+                bitwuzla_mk_term2(
+                    m_bzla,
+                    (lo_signed)?BITWUZLA_KIND_BV_SGE:BITWUZLA_KIND_BV_UGE,
+                    val_lo.term,
+                    lo.term),
+                bitwuzla_mk_term2(
+                    m_bzla,
+                    (hi_signed)?BITWUZLA_KIND_BV_SLE:BITWUZLA_KIND_BV_ULE,
+                    val_hi.term,
+                    hi.term));
+        }
+
+        ret = (ret)?bitwuzla_mk_term2(m_bzla, BITWUZLA_KIND_OR, ret, in):in;
+    }
+
+    // An empty rangelist holds no values
+    return {(ret)?ret:bitwuzla_mk_false(m_bzla), false, true};
+}
+
+dmgr::IDebug *SolverBitwuzlaConstraintBuilder::m_dbg = 0;
+
+}
+}
@@ -0,0 +1,128 @@
+/**
+ * SolverBitwuzlaConstraintBuilder.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <vector>
+#include "dmgr/IDebugMgr.h"
+#include "vsc/dm/IModelField.h"
+#include "vsc/dm/impl/VisitorBase.h"
+#include "vsc/solvers/impl/RefPathConstraint.h"
+
+struct Bitwuzla;
+struct BitwuzlaTerm;
+
+namespace vsc {
+namespace solvers {
+
+template <class T> class RefPathPtrMap;
+
+
+/**
+ * Builds the Bitwuzla term for a constraint. Unlike Boolector,
+ * Bitwuzla distinguishes the Boolean sort from single-bit vectors, 
+ * so the sort of each sub-expression is tracked and converted
+ * as required by the operator. Membership in a rangelist is lowered
+ * to a disjunction of per-range comparisons.
+ */
+class SolverBitwuzlaConstraintBuilder : public dm::VisitorBase {
+public:
+    SolverBitwuzlaConstraintBuilder(
+        dmgr::IDebugMgr                                 *dmgr,
+        struct Bitwuzla                                 *bzla,
+        const RefPathPtrMap<const struct BitwuzlaTerm>  &field_m,
+        dm::IModelField                                 *root_field
+    );
+
+    virtual ~SolverBitwuzlaConstraintBuilder();
+
+    /**
+     * Returns the Boolean term for the constraint at 'path', or null
+     * if the constraint uses a construct that can't be lowered
+     */
+    const struct BitwuzlaTerm *build(const std::vector<int32_t> &path);
+
+	virtual void visitDataTypeBool(dm::IDataTypeBool *t) override;
+
+	virtual void visitDataTypeEnum(dm::IDataTypeEnum *t) override;
+
+	virtual void visitDataTypeInt(dm::IDataTypeInt *t) override;
+
+	virtual void visitTypeConstraintExpr(dm::ITypeConstraintExpr *c) override;
+
+	virtual void visitTypeConstraintIfElse(dm::ITypeConstraintIfElse *c) override;
+
+	virtual void visitTypeConstraintImplies(dm::ITypeConstraintImplies *c) override;
+
+	virtual void visitTypeConstraintScope(dm::ITypeConstraintScope *c) override;
+
+	virtual void visitTypeConstraintUnique(dm::ITypeConstraintUnique *c) override;
+
+	virtual void visitTypeExprBin(dm::ITypeExprBin *e) override;
+
+	virtual void visitTypeExprRefBottomUp(dm::ITypeExprRefBottomUp *e) override;
+
+	virtual void visitTypeExprRefPath(dm::ITypeExprRefPath *e) override;
+
+	virtual void visitTypeExprRefTopDown(dm::ITypeExprRefTopDown *e) override;
+
+	virtual void visitTypeExprFieldRef(dm::ITypeExprFieldRef *e) override;
+
+	virtual void visitTypeExprRangelist(dm::ITypeExprRangelist *e) override;
+
+	virtual void visitTypeExprVal(dm::ITypeExprVal *e) override;
+
+protected:
+    struct ExprT {
+        const struct BitwuzlaTerm   *term;
+        bool                        is_signed;
+        bool                        is_bool;
+    };
+
+    enum class DataTypeMode {
+        Literal,
+        RefSign
+    };
+
+protected:
+    ExprT booleanize(const ExprT &expr);
+
+    ExprT bitvectorize(const ExprT &expr);
+
+    ExprT maxsize(const ExprT &expr, const ExprT &other);
+
+    ExprT mkInside(const ExprT &expr, dm::ITypeExprRangelist *rangelist);
+
+private:
+    static dmgr::IDebug                             *m_dbg;
+    struct Bitwuzla                                 *m_bzla;
+    const RefPathPtrMap<const struct BitwuzlaTerm>  &m_field_m;
+    dm::IModelField                                 *m_root_field;
+    std::vector<int32_t>                            m_path_prefix;
+    ExprT                                           m_expr;
+    // Set by visitTypeExprRangelist, for the enclosing comparison
+    dm::ITypeExprRangelist                          *m_rangelist;
+    dm::ValRef                                      m_val;
+    DataTypeMode                                    m_dt_mode;
+};
+
+}
+}
+
+
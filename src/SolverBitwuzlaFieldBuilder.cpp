@@ -0,0 +1,128 @@
+/*
+ * SolverBitwuzlaFieldBuilder.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "bitwuzla/bitwuzla.h"
+#include "dmgr/impl/DebugMacros.h"
+#include "vsc/dm/impl/ValRefBool.h"
+#include "vsc/dm/impl/ValRefInt.h"
+#include "vsc/solvers/impl/TaskPath2Field.h"
+#include "vsc/solvers/impl/TaskPath2ValRef.h"
+#include "SolverBitwuzlaFieldBuilder.h"
+#include "ValRefIntWords.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+SolverBitwuzlaFieldBuilder::SolverBitwuzlaFieldBuilder(
+    dmgr::IDebugMgr         *dmgr,
+    Bitwuzla                *bzla,
+    vsc::dm::IModelField    *root_field) : m_bzla(bzla), 
+        m_root_field(root_field), m_is_fixed(false), m_term(0) {
+    DEBUG_INIT("vsc::solvers::SolverBitwuzlaFieldBuilder", dmgr);
+}
+
+SolverBitwuzlaFieldBuilder::~SolverBitwuzlaFieldBuilder() {
+
+}
+
+const BitwuzlaTerm *SolverBitwuzlaFieldBuilder::build(
+        const std::vector<int32_t>  &path,
+        bool                        is_fixed) {
+    DEBUG_ENTER("build");
+    m_term = 0;
+    m_is_fixed = is_fixed;
+
+    // Fixed fields are built as a value holding the current value
+    if (is_fixed) {
+        m_val = TaskPath2ValRef(m_root_field).toMutVal(path);
+    }
+
+    // Resolve to a field that we can visit
+    dm::ITypeField *field = TaskPath2Field(m_root_field).toField(path);
+    field->accept(m_this);
+
+    DEBUG_LEAVE("build");
+    return m_term;
+}
+
+const BitwuzlaTerm *SolverBitwuzlaFieldBuilder::mkValue(
+        Bitwuzla                    *bzla,
+        uint32_t                    width,
+        const uint64_t              *words) {
+    const BitwuzlaSort *sort = bitwuzla_mk_bv_sort(bzla, width);
+    if (width <= 64) {
+        return bitwuzla_mk_bv_value_uint64(bzla, sort, words[0]);
+    } else {
+        return bitwuzla_mk_bv_value(
+            bzla, 
+            sort, 
+            ValRefIntWords::toBits(width, words).c_str(),
+            BITWUZLA_BV_BASE_BIN);
+    }
+}
+
+void SolverBitwuzlaFieldBuilder::visitDataTypeBool(dm::IDataTypeBool *t) {
+    DEBUG_ENTER("visitDataTypeBool");
+    const BitwuzlaSort *sort = bitwuzla_mk_bv_sort(m_bzla, 1);
+    if (m_is_fixed) {
+        dm::ValRefBool val(m_val);
+        m_term = bitwuzla_mk_bv_value_uint64(m_bzla, sort, val.get_val()?1:0);
+    } else {
+        m_term = bitwuzla_mk_const(m_bzla, sort, 0);
+    }
+    DEBUG_LEAVE("visitDataTypeBool");
+}
+
+void SolverBitwuzlaFieldBuilder::visitDataTypeEnum(dm::IDataTypeEnum *t) {
+    DEBUG_ENTER("visitDataTypeEnum");
+    if (m_is_fixed) {
+
+    } else {
+
+    }
+    DEBUG_LEAVE("visitDataTypeEnum");
+}
+
+void SolverBitwuzlaFieldBuilder::visitDataTypeInt(dm::IDataTypeInt *t) {
+    DEBUG_ENTER("visitDataTypeInt");
+    const BitwuzlaSort *sort = bitwuzla_mk_bv_sort(m_bzla, t->width());
+    if (m_is_fixed) {
+        dm::ValRefInt val(m_val);
+        std::vector<uint64_t> words(ValRefIntWords::numWords(t->width()));
+        ValRefIntWords::get(val, t->width(), t->isSigned(), words.data());
+        m_term = mkValue(m_bzla, t->width(), words.data());
+    } else {
+        m_term = bitwuzla_mk_const(m_bzla, sort, 0);
+    }
+    DEBUG_LEAVE("visitDataTypeInt");
+}
+
+void SolverBitwuzlaFieldBuilder::visitTypeFieldPhy(dm::ITypeFieldPhy *f) {
+    DEBUG_ENTER("visitTypeFieldPhy");
+    f->getDataType()->accept(m_this);
+    DEBUG_LEAVE("visitTypeFieldPhy");
+}
+
+dmgr::IDebug *SolverBitwuzlaFieldBuilder::m_dbg = 0;
+
+}
+}
@@ -0,0 +1,85 @@
+/**
+ * SolverBitwuzlaFieldBuilder.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include "dmgr/IDebugMgr.h"
+#include "vsc/dm/IModelField.h"
+#include "vsc/dm/impl/ValRef.h"
+#include "vsc/dm/impl/VisitorBase.h"
+
+struct Bitwuzla;
+struct BitwuzlaSort;
+struct BitwuzlaTerm;
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * Builds the Bitwuzla term for a field. Variable fields are built
+ * as bit-vector constants, while fixed fields are built as values.
+ * Boolean fields are single-bit vectors, as with Boolector.
+ */
+class SolverBitwuzlaFieldBuilder : public vsc::dm::VisitorBase {
+public:
+    SolverBitwuzlaFieldBuilder(
+        dmgr::IDebugMgr         *dmgr,
+        struct Bitwuzla         *bzla,
+        vsc::dm::IModelField    *root_field);
+
+    virtual ~SolverBitwuzlaFieldBuilder();
+
+    const struct BitwuzlaTerm *build(
+        const std::vector<int32_t>  &path,
+        bool                        is_fixed);
+
+    /**
+     * Builds a value of the given width from words, least-significant
+     * first. Values wider than 64 bits are built from a binary string
+     */
+    static const struct BitwuzlaTerm *mkValue(
+        struct Bitwuzla             *bzla,
+        uint32_t                    width,
+        const uint64_t              *words);
+
+	virtual void visitDataTypeBool(dm::IDataTypeBool *t) override;
+
+	virtual void visitDataTypeEnum(dm::IDataTypeEnum *t) override;
+
+	virtual void visitDataTypeInt(dm::IDataTypeInt *t) override;
+
+	virtual void visitTypeFieldPhy(dm::ITypeFieldPhy *f) override;
+
+private:
+    static dmgr::IDebug                             *m_dbg;
+    struct Bitwuzla                                 *m_bzla;
+    vsc::dm::IModelField                            *m_root_field;
+    bool                                            m_is_fixed;
+    const struct BitwuzlaTerm                       *m_term;
+    dm::ValRef                                      m_val;
+
+};
+
+}
+}
+
+
@@ -0,0 +1,115 @@
+/*
+ * SolverBitwuzlaSetFieldValue.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "bitwuzla/bitwuzla.h"
+#include "dmgr/impl/DebugMacros.h"
+#include "vsc/dm/impl/ValRefBool.h"
+#include "vsc/dm/impl/ValRefInt.h"
+#include "vsc/solvers/impl/TaskPath2ValRef.h"
+#include "vsc/solvers/impl/TaskPath2Field.h"
+#include "SolverBitwuzlaSetFieldValue.h"
+#include "ValRefIntWords.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+SolverBitwuzlaSetFieldValue::SolverBitwuzlaSetFieldValue(
+    dmgr::IDebugMgr     *dmgr,
+    Bitwuzla            *bzla,
+    dm::IModelField     *root_field) : 
+    m_bzla(bzla), m_root_field(root_field), m_term(0), m_bits(0) {
+    DEBUG_INIT("vsc::solvers::SolverBitwuzlaSetFieldValue", dmgr);
+}
+
+SolverBitwuzlaSetFieldValue::~SolverBitwuzlaSetFieldValue() {
+
+}
+
+void SolverBitwuzlaSetFieldValue::set(
+        const std::vector<int32_t> &path, 
+        const BitwuzlaTerm         *term) {
+    DEBUG_ENTER("set");
+    m_term = term;
+    m_bits = 0;
+    dm::ITypeField *field = TaskPath2Field(m_root_field).toField(path);
+    DEBUG("Field: %s", field->name().c_str());
+    m_val = TaskPath2ValRef(m_root_field).toMutVal(path);
+    field->getDataType()->accept(m_this);
+    DEBUG_LEAVE("set");
+}
+
+void SolverBitwuzlaSetFieldValue::set(
+        const std::vector<int32_t> &path, 
+        const char                 *bits) {
+    DEBUG_ENTER("set");
+    m_term = 0;
+    m_bits = bits;
+    dm::ITypeField *field = TaskPath2Field(m_root_field).toField(path);
+    m_val = TaskPath2ValRef(m_root_field).toMutVal(path);
+    field->getDataType()->accept(m_this);
+    DEBUG_LEAVE("set");
+}
+
+void SolverBitwuzlaSetFieldValue::visitDataTypeBool(dm::IDataTypeBool *t) {
+    DEBUG_ENTER("visitDataTypeBool");
+    const char *bits = (m_bits)?m_bits:bitwuzla_get_bv_value(m_bzla, m_term);
+    dm::ValRefBool val_b(m_val);
+    val_b.set_val(bits[0] == '1');
+    DEBUG_LEAVE("visitDataTypeBool");
+}
+
+void SolverBitwuzlaSetFieldValue::visitDataTypeEnum(dm::IDataTypeEnum *t) {
+    DEBUG_ENTER("visitDataTypeEnum");
+
+    DEBUG_LEAVE("visitDataTypeEnum");
+}
+
+void SolverBitwuzlaSetFieldValue::visitDataTypeInt(dm::IDataTypeInt *t) {
+    DEBUG_ENTER("visitDataTypeInt");
+
+    // The value string is owned by Bitwuzla, and is valid 
+    // until the next call
+    const char *bits = (m_bits)?m_bits:bitwuzla_get_bv_value(m_bzla, m_term);
+    DEBUG("bits: %s\n", bits);
+    dm::ValRefInt val_i(m_val);
+    if (t->width() <= 64) {
+        uint64_t val = 0;
+
+        for (uint32_t i=0; i<t->width() && bits[i]; i++) {
+            val <<= 1;
+            val |= (bits[i] == '1');
+        }
+
+        val_i.set_val(val);
+    } else {
+        std::vector<uint64_t> words(ValRefIntWords::numWords(t->width()));
+        ValRefIntWords::fromBits(bits, t->width(), words.data());
+        ValRefIntWords::set(val_i, words.data());
+    }
+
+    DEBUG_LEAVE("visitDataTypeInt");
+}
+
+dmgr::IDebug *SolverBitwuzlaSetFieldValue::m_dbg = 0;
+
+}
+}
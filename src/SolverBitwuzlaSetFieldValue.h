@@ -0,0 +1,74 @@
+/**
+ * SolverBitwuzlaSetFieldValue.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include "dmgr/IDebugMgr.h"
+#include "vsc/dm/impl/VisitorBase.h"
+#include "vsc/dm/impl/ValRef.h"
+
+struct Bitwuzla;
+struct BitwuzlaTerm;
+
+namespace vsc {
+namespace solvers {
+
+
+
+class SolverBitwuzlaSetFieldValue : public virtual dm::VisitorBase {
+public:
+    SolverBitwuzlaSetFieldValue(
+        dmgr::IDebugMgr     *dmgr,
+        struct Bitwuzla     *bzla,
+        dm::IModelField     *root_field);
+
+    virtual ~SolverBitwuzlaSetFieldValue();
+
+    void set(
+        const std::vector<int32_t> &path, 
+        const struct BitwuzlaTerm  *term);
+
+    /**
+     * Sets the field from a binary string, as returned
+     * by bitwuzla_get_bv_value
+     */
+    void set(
+        const std::vector<int32_t> &path, 
+        const char                 *bits);
+
+	virtual void visitDataTypeBool(dm::IDataTypeBool *t) override;
+
+	virtual void visitDataTypeEnum(dm::IDataTypeEnum *t) override;
+
+	virtual void visitDataTypeInt(dm::IDataTypeInt *t) override;
+
+private:
+    static dmgr::IDebug             *m_dbg;
+    struct Bitwuzla                 *m_bzla;
+    dm::IModelField                 *m_root_field;
+    const struct BitwuzlaTerm       *m_term;
+    const char                      *m_bits;
+    dm::ValRef                      m_val;
+
+};
+
+}
+}
+
+
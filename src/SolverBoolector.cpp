@@ -21,97 +21,576 @@
 #include "boolector/boolector.h"
 #include "dmgr/impl/DebugMacros.h"
 #include "SolverBoolector.h"
-#include "SolverBoolectorConstraintBuilder.h"
 #include "SolverBoolectorFieldBuilder.h"
-#include "SolverBoolectorSetFieldValue.h"
 
 
 namespace vsc {
 namespace solvers {
 
 
-SolverBoolector::SolverBoolector(dmgr::IDebugMgr *dmgr) : 
-    m_dmgr(dmgr), m_issat(false) {
+SolverBoolector::SolverBoolector(
+    dmgr::IDebugMgr                         *dmgr,
+    uint32_t                                swizzle_calls,
+    uint32_t                                swizzle_bits,
+    SolverBoolectorTemplateCache            *templates) : 
+    m_dmgr(dmgr), m_templates(templates), m_btor(0),
+    m_issat(false), m_built(false), m_lowered(false), 
+    m_swizzle_calls(swizzle_calls), m_swizzle_bits(swizzle_bits),
+    m_pool_size(0),
+    m_race(0), m_race_id(-1),
+    m_stats(0), m_backend_h(0), m_solveset_h(0) {
     DEBUG_INIT("vsc::solvers::SolverBoolector", dmgr);
 
-	m_btor = boolector_new();
-	boolector_set_opt(m_btor, BTOR_OPT_INCREMENTAL, 1);
-	boolector_set_opt(m_btor, BTOR_OPT_MODEL_GEN, 1);
+    // With templates, the instance is a clone created on first build
+    if (!m_templates) {
+        Btor *btor = boolector_new();
+        boolector_set_opt(btor, BTOR_OPT_INCREMENTAL, 1);
+        boolector_set_opt(btor, BTOR_OPT_MODEL_GEN, 1);
+        init(btor);
+    }
 }
 
 SolverBoolector::~SolverBoolector() {
-	boolector_release_all(m_btor);
-	boolector_delete(m_btor);
+    if (m_btor) {
+        m_sorts->release();
+        boolector_release_all(m_btor);
+        boolector_delete(m_btor);
+    }
+}
+
+void SolverBoolector::init(Btor *btor) {
+    m_btor = btor;
+    m_sorts = SolverBoolectorSortCacheUP(new SolverBoolectorSortCache(btor));
+    m_const_f = SolverBoolectorConstFactoryUP(
+        new SolverBoolectorConstFactory(btor, m_sorts.get()));
+    m_setter = SolverBoolectorSetFieldValueUP(
+        new SolverBoolectorSetFieldValue(m_dmgr, btor));
+
+    // Polled during boolector_sat to abandon calls that lost 
+    // a race or exceeded their budget
+    boolector_set_term(m_btor, &SolverBoolector::terminate, this);
 }
 
-bool SolverBoolector::randomize(
+SolverResult SolverBoolector::randomize(
         IRandState                              *randstate,
         dm::IModelField                         *root_field,
         ISolveSet                               *solveset) {
-    bool ret = true;
+    SolverResult ret;
     DEBUG_ENTER("randomize");
+    SolverStatsTimer timer(getSolveSetHist(solveset));
+
+    // The formula for a solve set only depends on the type, so it
+    // is built and asserted once. Subsequent calls only re-bind 
+    // the values of fixed fields and re-solve incrementally.
+    if (!m_built) {
+        build(root_field, solveset);
+        m_built = true;
+    }
+
+    if (!m_lowered) {
+        DEBUG_LEAVE("randomize -- unsupported constraints");
+        return SolverResult::Unsupported;
+    }
+
+    bindFixedFields(root_field, solveset);
+    startBudget();
+
+    if (m_pool_size) {
+        ret = randomizePooled(randstate, root_field, solveset);
+        DEBUG_LEAVE("randomize -- pooled %d", static_cast<int32_t>(ret));
+        return ret;
+    }
+
+    // Solve, preferring random values for a subset of target bits
+    int32_t result = solveSwizzled(randstate, solveset);
+
+    if (timedOut(result)) {
+        ret = fallbackPrevious(root_field, solveset);
+        releaseAssumptions();
+        DEBUG_LEAVE("randomize -- timeout %d", static_cast<int32_t>(ret));
+        return ret;
+    }
+
+    // Keep the solution, and the fixed-field values it was found with
+    bool keep = (result == BTOR_RESULT_SAT && 
+        m_budget.fallback == SolverFallback::Previous);
+    if (keep) {
+        m_prev_key = m_fixed_val_l;
+        m_setter->read(m_prev);
+    }
+
+    releaseAssumptions();
+
+    if (!claim()) {
+        DEBUG_LEAVE("randomize -- lost race");
+        return SolverResult::Unsat;
+    }
 
-    // Solve set will tell us what fields are:
-    // - target
-    // - have a fixed value
+    if (result != BTOR_RESULT_SAT) {
+        DEBUG_LEAVE("randomize -- unsat");
+        return SolverResult::Unsat;
+    }
+
+    // Finally, fix the values of target fields
+    SolverStatsTimer rb_timer((m_stats)?
+        &m_stats->getPhase(SolverStatsPhase::Readback):0);
+    if (!keep) {
+        m_setter->read(m_solution);
+    }
+    m_setter->write(root_field, (keep)?m_prev:m_solution);
+
+    DEBUG_LEAVE("randomize");
+    return SolverResult::Sat;
+}
+
+SolverResult SolverBoolector::sat(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) {
+    DEBUG_ENTER("sat");
+    SolverStatsTimer timer(getSolveSetHist(solveset));
+
+    if (!m_built) {
+        build(root_field, solveset);
+        m_built = true;
+    }
+
+    if (!m_lowered) {
+        DEBUG_LEAVE("sat -- unsupported constraints");
+        return SolverResult::Unsupported;
+    }
+
+    bindFixedFields(root_field, solveset);
+    assumeFixedFields();
+    startBudget();
+
+    // No values are read back, so skip model generation
+    boolector_set_opt(m_btor, BTOR_OPT_MODEL_GEN, 0);
+    int32_t result = solve();
+    boolector_set_opt(m_btor, BTOR_OPT_MODEL_GEN, 1);
+
+    releaseAssumptions();
+
+    if (timedOut(result)) {
+        DEBUG_LEAVE("sat -- timeout");
+        return SolverResult::Timeout;
+    }
+
+    if (!claim()) {
+        DEBUG_LEAVE("sat -- lost race");
+        return SolverResult::Unsat;
+    }
+
+    bool ret = (result == BTOR_RESULT_SAT);
+    DEBUG_LEAVE("sat %d", ret);
+    return (ret)?SolverResult::Sat:SolverResult::Unsat;
+}
+
+void SolverBoolector::build(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) {
+    DEBUG_ENTER("build");
+    SolverStatsTimer timer((m_stats)?
+        &m_stats->getPhase(SolverStatsPhase::Build):0);
+
+    if (m_templates) {
+        // Start from a clone of the compiled formula
+        SolverBoolectorTemplateSP tmpl = m_templates->getTemplate(
+            root_field, solveset);
+        init(tmpl->clone(
+            root_field,
+            solveset,
+            m_field_m));
+        m_lowered = tmpl->isLowered();
+        if (m_stats) {
+            m_stats->inc(SolverStatsCounter::TemplateClone);
+        }
+    } else {
+        m_lowered = SolverBoolectorTemplate::lower(
+            m_dmgr,
+            m_btor,
+            m_sorts.get(),
+            m_const_f.get(),
+            root_field,
+            solveset,
+            m_field_m);
+    }
+
+    // Target fields are resolved to readback slots once
+    m_setter->init(root_field, solveset, m_field_m);
 
-    SolverBoolectorFieldBuilder builder(m_dmgr, m_btor, root_field);
     for (RefPathMap<SolveSetFieldType>::iterator
         it=solveset->getFields().begin(); it.next(); ) {
-        if (it.value() == SolveSetFieldType::Target ||
-            it.value() == SolveSetFieldType::NonTarget) {
-            // Create a solver variable to represent
-            m_field_m.add(
-                it.path(),
-                builder.build(it.path(), false));
-        } else {
-            // Create a literal to represent
-            m_field_m.add(
-                it.path(),
-                builder.build(it.path(), true));
+        if (it.value() == SolveSetFieldType::Fixed) {
+            m_fixed_path_l.push_back(it.path());
+            m_fixed_var_l.push_back(m_field_m.find(it.path()));
+        } else if (it.value() == SolveSetFieldType::Target) {
+            m_target_var_l.push_back(m_field_m.find(it.path()));
         }
     }
 
-    // - Create variables for the target fields
-    // - Create constraints, opportunistically creating variables for non-target fields
-    std::vector<BoolectorNode *> constraints;
-    SolverBoolectorConstraintBuilder c_builder(m_dmgr, m_btor, m_field_m, root_field);
-    for (RefPathSet::iterator
-        it=solveset->getConstraints().begin(); it.next(); ) {
-        BoolectorNode *c = c_builder.build(it.path());
-        boolector_assert(m_btor, c);
-        constraints.push_back(c);
+    DEBUG_LEAVE("build");
+}
+
+void SolverBoolector::bindFixedFields(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) {
+    DEBUG_ENTER("bindFixedFields");
+    SolverBoolectorFieldBuilder builder(
+        m_dmgr, m_btor, m_sorts.get(), m_const_f.get(), root_field);
+    m_fixed_val_l.clear();
+    for (uint32_t i=0; i<m_fixed_var_l.size(); i++) {
+        BoolectorNode *val = builder.build(m_fixed_path_l.at(i), true);
+        BoolectorNode *eq = boolector_eq(m_btor, m_fixed_var_l.at(i), val);
+        // Words of all fields are concatenated. Field widths are fixed
+        // for the solve set, so the key is unambiguous
+        m_fixed_val_l.insert(
+            m_fixed_val_l.end(),
+            builder.getValue().begin(),
+            builder.getValue().end());
+
+        // The value is an interned constant, owned by the factory
+        m_assumptions.push_back(eq);
+        m_fixed_l.push_back(eq);
+    }
+    DEBUG_LEAVE("bindFixedFields");
+}
+
+void SolverBoolector::assumeFixedFields() {
+    // Assumptions only apply to a single sat call, so the 
+    // bindings are re-assumed before each call
+    for (std::vector<BoolectorNode *>::const_iterator
+        it=m_fixed_l.begin();
+        it!=m_fixed_l.end(); it++) {
+        boolector_assume(m_btor, *it);
+    }
+}
+
+void SolverBoolector::releaseAssumptions() {
+    // Release per-call nodes so that a long-lived instance
+    // doesn't accumulate one literal per distinct fixed value
+    for (std::vector<BoolectorNode *>::const_iterator
+        it=m_assumptions.begin();
+        it!=m_assumptions.end(); it++) {
+        boolector_release(m_btor, *it);
     }
+    m_assumptions.clear();
+    m_fixed_l.clear();
+    m_block_l.clear();
 
-    // Assert all hard constraints
+    // Bounds the number of interned fixed-field values. Interned
+    // constants that are still referenced by expressions remain valid
+    m_const_f->trim();
+}
 
-    // Solve
-    int32_t result = boolector_sat(m_btor);
+void SolverBoolector::setStats(SolverStats *stats) {
+    m_stats = stats;
+    m_backend_h = (stats)?&stats->getBackend("boolector"):0;
+    m_solveset_h = 0;
+}
 
-    ret = (result == BTOR_RESULT_SAT);
-    DEBUG("issat: %d", ret);
+int32_t SolverBoolector::solve() {
+    if (m_budget.limited()) {
+        // The termination callback stops the call at the earlier of
+        // the per-call and per-solve-set deadlines
+        m_deadline = m_solveset_deadline;
+        if (m_budget.call_ms) {
+            std::chrono::steady_clock::time_point call_deadline = 
+                std::chrono::steady_clock::now() + 
+                std::chrono::milliseconds(m_budget.call_ms);
+            if (call_deadline < m_deadline) {
+                m_deadline = call_deadline;
+            }
+        }
+    }
 
-//    boolector_saddo
+    if (!m_stats) {
+        return check();
+    }
 
-    // TODO: swizzle result for randomness
+    // Time once, and record to both the phase and backend histograms
+    std::chrono::steady_clock::time_point start = 
+        std::chrono::steady_clock::now();
+    int32_t result = check();
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    m_stats->getPhase(SolverStatsPhase::Solve).record(ns);
+    m_backend_h->record(ns);
 
-    // Finally, fix the values of target fields
-    if (ret) {
-        for (RefPathMap<SolveSetFieldType>::iterator
-            it=solveset->getFields().begin(); it.next(); ) {
-            if (it.value() == SolveSetFieldType::Target) {
-                // Assign value
-                BoolectorNode *n = m_field_m.find(it.path());
-                SolverBoolectorSetFieldValue(m_dmgr, m_btor, root_field).set(
-                    it.path(),
-                    n);
+    return result;
+}
 
+int32_t SolverBoolector::check() {
+    // A call that reaches the conflict limit is abandoned with an 
+    // unknown result, which is reported as a timeout
+    if (m_budget.conflicts) {
+        return boolector_limited_sat(m_btor, -1, m_budget.conflicts);
+    }
+    return boolector_sat(m_btor);
+}
+
+void SolverBoolector::startBudget() {
+    m_solveset_deadline = std::chrono::steady_clock::time_point::max();
+    if (m_budget.solveset_ms) {
+        m_solveset_deadline = std::chrono::steady_clock::now() + 
+            std::chrono::milliseconds(m_budget.solveset_ms);
+    }
+}
+
+bool SolverBoolector::timedOut(int32_t result) {
+    // Calls abandoned because another racer won aren't timeouts
+    if (result != BTOR_RESULT_UNKNOWN || (m_race && m_race->done())) {
+        return false;
+    }
+    if (m_stats) {
+        m_stats->inc(SolverStatsCounter::Timeout);
+    }
+    return true;
+}
+
+int32_t SolverBoolector::solveSwizzled(
+        IRandState                              *randstate,
+        ISolveSet                               *solveset) {
+    DEBUG_ENTER("solveSwizzled");
+    const std::vector<BoolectorNode *> &target_l = m_target_var_l;
+    std::vector<BoolectorNode *> pref_l;
+
+    // Select random target bits, and a random preferred value for each.
+    // Each preference is a single-bit literal that can be assumed
+    for (uint32_t i=0; m_swizzle_calls && target_l.size() && i<m_swizzle_bits; i++) {
+        uint64_t r = randstate->rand_ui64();
+        BoolectorNode *var = target_l.at(static_cast<uint32_t>(r) % target_l.size());
+        uint32_t bit = static_cast<uint32_t>(r >> 32) % boolector_get_width(m_btor, var);
+        BoolectorNode *pref = boolector_slice(m_btor, var, bit, bit);
+        m_assumptions.push_back(pref);
+        if (r & (1ULL << 63)) {
+            pref = boolector_not(m_btor, pref);
+            m_assumptions.push_back(pref);
+        }
+        pref_l.push_back(pref);
+    }
+
+    uint32_t n_calls = 0;
+    int32_t result;
+    while (true) {
+        assumeFixedFields();
+        for (std::vector<BoolectorNode *>::const_iterator
+            it=m_block_l.begin();
+            it!=m_block_l.end(); it++) {
+            boolector_assume(m_btor, *it);
+        }
+        for (std::vector<BoolectorNode *>::const_iterator
+            it=pref_l.begin();
+            it!=pref_l.end(); it++) {
+            boolector_assume(m_btor, *it);
+        }
+
+        result = solve();
+
+        // Stop on SAT, or when a termination callback abandoned the call
+        if (result != BTOR_RESULT_UNSAT || !pref_l.size()) {
+            break;
+        }
+
+        // Drop the preferences that contributed to the conflict
+        uint32_t n_pref = 0;
+        for (uint32_t i=0; i<pref_l.size(); i++) {
+            if (!boolector_failed(m_btor, pref_l.at(i))) {
+                pref_l.at(n_pref++) = pref_l.at(i);
             }
         }
+
+        if (n_pref == pref_l.size()) {
+            // The conflict doesn't involve any preference, so
+            // the fixed-field values are unsatisfiable
+            break;
+        }
+        pref_l.resize(n_pref);
+
+        // Once the budget is reached, make the last call without preferences
+        if (++n_calls >= m_swizzle_calls) {
+            pref_l.clear();
+        }
+
+        if (m_stats) {
+            m_stats->inc(SolverStatsCounter::SwizzleRetry);
+        }
     }
 
-    DEBUG_LEAVE("randomize");
-    return ret;
+    DEBUG_LEAVE("solveSwizzled %d (%d retries)", result, n_calls);
+    return result;
+}
+
+SolverResult SolverBoolector::randomizePooled(
+        IRandState                              *randstate,
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) {
+    DEBUG_ENTER("randomizePooled");
+
+    // Pooled solutions are only valid for the fixed-field values they
+    // were harvested with
+    if (m_pool_key != m_fixed_val_l) {
+        DEBUG("Fixed-field values changed. Clearing %d pooled solutions",
+            m_pool.size());
+        m_pool.clear();
+        m_pool_key = m_fixed_val_l;
+    } else if (m_pool.size() && m_stats) {
+        m_stats->inc(SolverStatsCounter::PoolHit);
+    }
+
+    int32_t result = BTOR_RESULT_SAT;
+    if (!m_pool.size()) {
+        result = harvest(randstate, solveset);
+    }
+
+    releaseAssumptions();
+
+    if (!claim()) {
+        DEBUG_LEAVE("randomizePooled -- lost race");
+        return SolverResult::Unsat;
+    }
+
+    if (!m_pool.size()) {
+        // Pooled solutions are already the previous solutions, so 
+        // a timeout before the first solution has no fallback
+        SolverResult ret = (timedOut(result))?
+            SolverResult::Timeout:SolverResult::Unsat;
+        DEBUG_LEAVE("randomizePooled -- no solution %d", 
+            static_cast<int32_t>(ret));
+        return ret;
+    }
+
+    // Serve a random pooled solution, such that the order in which
+    // solutions were harvested doesn't show through
+    uint32_t idx = randstate->randint32(0, m_pool.size()-1);
+    {
+        SolverStatsTimer timer((m_stats)?
+            &m_stats->getPhase(SolverStatsPhase::Readback):0);
+        m_setter->write(root_field, m_pool.at(idx));
+    }
+    if (idx != m_pool.size()-1) {
+        m_pool.at(idx).swap(m_pool.back());
+    }
+    m_pool.pop_back();
+
+    DEBUG_LEAVE("randomizePooled");
+    return SolverResult::Sat;
+}
+
+SolverResult SolverBoolector::fallbackPrevious(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) {
+    if (m_budget.fallback != SolverFallback::Previous ||
+            !m_prev.size() || m_prev_key != m_fixed_val_l) {
+        return SolverResult::Timeout;
+    }
+
+    if (!claim()) {
+        return SolverResult::Unsat;
+    }
+
+    DEBUG("Timeout: re-using the previous solution");
+    if (m_stats) {
+        m_stats->inc(SolverStatsCounter::Fallback);
+    }
+    m_setter->write(root_field, m_prev);
+    return SolverResult::Sat;
+}
+
+int32_t SolverBoolector::harvest(
+        IRandState                              *randstate,
+        ISolveSet                               *solveset) {
+    DEBUG_ENTER("harvest");
+    int32_t result = BTOR_RESULT_UNSAT;
+    const std::vector<SolverBoolectorSetFieldValue::Slot> &slots = 
+        m_setter->getSlots();
+
+    // Each solution after the first is found with random preferences,
+    // and with all previous solutions blocked. The blocking literals
+    // are assumptions, such that the asserted formula is unchanged
+    for (uint32_t i=0; i<m_pool_size; i++) {
+        if ((result=solveSwizzled(randstate, solveset)) != BTOR_RESULT_SAT) {
+            // Unsatisfiable, all solutions have been found, or out of budget
+            break;
+        }
+
+        m_pool.push_back(std::vector<uint64_t>());
+        std::vector<uint64_t> &solution = m_pool.back();
+        m_setter->read(solution);
+        BoolectorNode *match = 0;
+        for (std::vector<SolverBoolectorSetFieldValue::Slot>::const_iterator
+            it=slots.begin();
+            it!=slots.end(); it++) {
+            // The value is an interned constant, owned by the factory
+            BoolectorNode *val = m_const_f->mk(
+                it->width, 
+                &solution.at(it->offset));
+            BoolectorNode *eq = boolector_eq(m_btor, it->node, val);
+            m_assumptions.push_back(eq);
+            if (match) {
+                match = boolector_and(m_btor, match, eq);
+                m_assumptions.push_back(match);
+            } else {
+                match = eq;
+            }
+        }
+
+        if (!match) {
+            // No target fields, so there is exactly one solution
+            break;
+        }
+        BoolectorNode *block = boolector_not(m_btor, match);
+        m_assumptions.push_back(block);
+        m_block_l.push_back(block);
+    }
+
+    DEBUG_LEAVE("harvest %d solutions", m_pool.size());
+    return result;
+}
+
+void SolverBoolector::setBudget(const SolverBudget &budget) {
+    m_budget = budget;
+    if (budget.fallback != SolverFallback::Previous) {
+        m_prev.clear();
+        m_prev_key.clear();
+    }
+}
+
+void SolverBoolector::setPoolSize(uint32_t size) {
+    m_pool_size = size;
+    m_pool.clear();
+    m_pool_key.clear();
+}
+
+void SolverBoolector::setRace(SolverRace *race, int32_t id) {
+    m_race = race;
+    m_race_id = id;
+}
+
+bool SolverBoolector::claim() {
+    return (!m_race || m_race->claim(m_race_id));
+}
+
+int32_t SolverBoolector::terminate(void *ud) {
+    SolverBoolector *solver = reinterpret_cast<SolverBoolector *>(ud);
+    if (solver->m_race && solver->m_race->done() && 
+            solver->m_race->getWinner() != solver->m_race_id) {
+        return 1;
+    }
+    return (solver->m_budget.limited() && 
+        std::chrono::steady_clock::now() >= solver->m_deadline);
+}
+
+SolverStatsHist *SolverBoolector::getSolveSetHist(ISolveSet *solveset) {
+    // A solver instance is bound to a single solve set, so the
+    // entry is looked up once
+    if (m_stats && !m_solveset_h) {
+        m_solveset_h = &m_stats->getSolveSet(
+            solveset,
+            solveset->getFields().size(),
+            solveset->getConstraints().size(),
+            solveset->getCost()).solve;
+    }
+    return m_solveset_h;
 }
 
 dmgr::IDebug *SolverBoolector::m_dbg = 0;
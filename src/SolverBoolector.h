@@ -19,9 +19,15 @@
  *     Author: 
  */
 #pragma once
+#include <chrono>
+#include <vector>
 #include "dmgr/IDebugMgr.h"
 #include "vsc/solvers/ISolver.h"
 #include "vsc/solvers/impl/RefPathPtrMap.h"
+#include "SolverBoolectorConstFactory.h"
+#include "SolverBoolectorSetFieldValue.h"
+#include "SolverBoolectorSortCache.h"
+#include "SolverBoolectorTemplateCache.h"
 
 struct Btor;
 struct BoolectorNode;
@@ -31,23 +37,144 @@ namespace solvers {
 
 
 
+/**
+ * Solves a solve set with Boolector. Randomization prefers random 
+ * values for randomly-selected target bits, which are applied as
+ * assumptions. Preferences that conflict with the constraints are 
+ * dropped, and at most 'swizzle_calls' extra SAT calls are made 
+ * per randomization.
+ * When a pool size is set, each SAT session harvests up to that many 
+ * distinct solutions, and later randomizations are served from the 
+ * pool until it is empty or the values of fixed fields change.
+ * When a budget is set, a termination callback stops backend calls
+ * that exceed its time limits, and a conflict limit stops calls that
+ * exceed it. Randomization then reports a timeout.
+ * When a template cache is provided, the instance is cloned from a
+ * compiled formula of the solve set instead of being lowered.
+ */
 class SolverBoolector : public virtual ISolver {
 public:
-    SolverBoolector(dmgr::IDebugMgr *dmgr);
+    static const uint32_t DefaultSwizzleCalls = 4;
+    static const uint32_t DefaultSwizzleBits = 32;
+
+    SolverBoolector(
+        dmgr::IDebugMgr                         *dmgr,
+        uint32_t                                swizzle_calls=DefaultSwizzleCalls,
+        uint32_t                                swizzle_bits=DefaultSwizzleBits,
+        SolverBoolectorTemplateCache            *templates=0);
 
     virtual ~SolverBoolector();
 
-    virtual bool randomize(
+    virtual SolverResult randomize(
         IRandState                              *randstate,
         dm::IModelField                         *root_field,
         ISolveSet                               *solveset) override;
 
+    virtual SolverResult sat(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) override;
+
+    virtual void setStats(SolverStats *stats) override;
+
+    virtual void setRace(SolverRace *race, int32_t id) override;
+
+    virtual void setPoolSize(uint32_t size) override;
+
+    virtual void setBudget(const SolverBudget &budget) override;
+
+    uint32_t getPoolSize() const { return m_pool_size; }
+
+private:
+    void init(struct Btor *btor);
+
+    void build(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset);
+
+    void bindFixedFields(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset);
+
+    void assumeFixedFields();
+
+    void releaseAssumptions();
+
+    int32_t solve();
+
+    int32_t check();
+
+    int32_t solveSwizzled(
+        IRandState                              *randstate,
+        ISolveSet                               *solveset);
+
+    SolverResult randomizePooled(
+        IRandState                              *randstate,
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset);
+
+    int32_t harvest(
+        IRandState                              *randstate,
+        ISolveSet                               *solveset);
+
+    void startBudget();
+
+    bool timedOut(int32_t result);
+
+    SolverResult fallbackPrevious(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset);
+
+    SolverStatsHist *getSolveSetHist(ISolveSet *solveset);
+
+    bool claim();
+
+    static int32_t terminate(void *ud);
+
 private:
     static dmgr::IDebug                     *m_dbg;
     dmgr::IDebugMgr                         *m_dmgr;
+    SolverBoolectorTemplateCache            *m_templates;
     struct Btor                             *m_btor;
+    SolverBoolectorSortCacheUP              m_sorts;
+    SolverBoolectorConstFactoryUP           m_const_f;
+    SolverBoolectorSetFieldValueUP          m_setter;
     bool                                    m_issat;
+    bool                                    m_built;
+    // False when a constraint of the solve set couldn't be lowered
+    bool                                    m_lowered;
     RefPathPtrMap<struct BoolectorNode>     m_field_m;
+    std::vector<struct BoolectorNode *>     m_assumptions;
+    std::vector<struct BoolectorNode *>     m_fixed_l;
+    // Fixed- and target-field variables of the solve set, resolved
+    // once by build() such that per-call loops don't walk the trie
+    std::vector<std::vector<int32_t>>       m_fixed_path_l;
+    std::vector<struct BoolectorNode *>     m_fixed_var_l;
+    // Values of the fixed fields, read once per call by bindFixedFields().
+    // Each field contributes all of its words
+    std::vector<uint64_t>                   m_fixed_val_l;
+    std::vector<struct BoolectorNode *>     m_target_var_l;
+    uint32_t                                m_swizzle_calls;
+    uint32_t                                m_swizzle_bits;
+    // Excludes already-harvested solutions during a harvest
+    std::vector<struct BoolectorNode *>     m_block_l;
+    uint32_t                                m_pool_size;
+    // Fixed-field values the pool was harvested with
+    std::vector<uint64_t>                   m_pool_key;
+    // Target-field values, packed per m_setter's slots, of each solution
+    std::vector<std::vector<uint64_t>>      m_pool;
+    SolverBudget                            m_budget;
+    std::chrono::steady_clock::time_point   m_solveset_deadline;
+    std::chrono::steady_clock::time_point   m_deadline;
+    // Last solution and its fixed-field values, for the 'Previous' fallback
+    std::vector<uint64_t>                   m_prev;
+    std::vector<uint64_t>                   m_prev_key;
+    // Readback buffer, re-used across calls
+    std::vector<uint64_t>                   m_solution;
+    SolverRace                              *m_race;
+    int32_t                                 m_race_id;
+    SolverStats                             *m_stats;
+    SolverStatsHist                         *m_backend_h;
+    SolverStatsHist                         *m_solveset_h;
 
 };
 
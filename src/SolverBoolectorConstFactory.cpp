@@ -0,0 +1,157 @@
+/*
+ * SolverBoolectorConstFactory.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "boolector/boolector.h"
+#include "SolverBoolectorConstFactory.h"
+#include "SolverBoolectorSortCache.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+SolverBoolectorConstFactory::SolverBoolectorConstFactory(
+    Btor                        *btor,
+    SolverBoolectorSortCache    *sorts,
+    uint32_t                    max_entries) :
+        m_btor(btor), m_sorts(sorts), m_max_entries(max_entries) {
+
+}
+
+SolverBoolectorConstFactory::~SolverBoolectorConstFactory() {
+    // Interned nodes are released along with the Btor instance,
+    // which is typically deleted before the factory
+}
+
+BoolectorNode *SolverBoolectorConstFactory::mk(uint32_t width, uint64_t val) {
+    if (width < 64) {
+        val &= ((1ULL << width) - 1);
+    }
+
+    KeyT key(width, val);
+    std::unordered_map<KeyT, BoolectorNode *, KeyHash>::const_iterator it;
+
+    if ((it=m_const_m.find(key)) != m_const_m.end()) {
+        return it->second;
+    }
+
+    BoolectorNode *ret = build(width, &val);
+    m_const_m.insert({key, ret});
+    return ret;
+}
+
+BoolectorNode *SolverBoolectorConstFactory::mk(
+        uint32_t            width,
+        const uint64_t      *words) {
+    if (width <= 64) {
+        return mk(width, words[0]);
+    }
+
+    uint32_t n_words = (width-1)/64+1;
+    WideKeyT key(width, std::vector<uint64_t>(words, words+n_words));
+    if ((width%64) != 0) {
+        key.second.back() &= ((1ULL << (width%64)) - 1);
+    }
+
+    std::map<WideKeyT, BoolectorNode *>::const_iterator it;
+    if ((it=m_wide_m.find(key)) != m_wide_m.end()) {
+        return it->second;
+    }
+
+    BoolectorNode *ret = build(width, key.second.data());
+    m_wide_m.insert({key, ret});
+    return ret;
+}
+
+BoolectorNode *SolverBoolectorConstFactory::mkExt(
+        uint32_t            width,
+        uint64_t            val,
+        bool                is_signed) {
+    if (width <= 64) {
+        return mk(width, val);
+    }
+
+    std::vector<uint64_t> words(
+        (width-1)/64+1,
+        (is_signed && (val >> 63))?~0ULL:0ULL);
+    words.at(0) = val;
+
+    return mk(width, words.data());
+}
+
+void SolverBoolectorConstFactory::trim() {
+    if (size() > m_max_entries) {
+        release();
+    }
+}
+
+BoolectorNode *SolverBoolectorConstFactory::build(
+        uint32_t            width,
+        const uint64_t      *words) {
+    // The integer API accepts 32-bit values, so the constant is
+    // assembled from 32-bit chunks. Leading zero chunks are folded
+    // into the width of the most-significant non-zero chunk.
+    uint32_t n_chunks = (width-1)/32+1;
+    int32_t hi = n_chunks-1;
+    while (hi > 0 && !static_cast<uint32_t>(words[hi/2] >> (32*(hi%2)))) {
+        hi--;
+    }
+
+    BoolectorNode *ret = boolector_unsigned_int(
+        m_btor,
+        static_cast<uint32_t>(words[hi/2] >> (32*(hi%2))),
+        m_sorts->get(width-32*hi));
+
+    if (hi > 0) {
+        BoolectorSort sort = m_sorts->get(32);
+        for (int32_t i=hi-1; i>=0; i--) {
+            BoolectorNode *lo = boolector_unsigned_int(
+                m_btor,
+                static_cast<uint32_t>(words[i/2] >> (32*(i%2))),
+                sort);
+            BoolectorNode *cat = boolector_concat(m_btor, ret, lo);
+            boolector_release(m_btor, lo);
+            boolector_release(m_btor, ret);
+            ret = cat;
+        }
+    }
+
+    return ret;
+}
+
+void SolverBoolectorConstFactory::release() {
+    for (std::unordered_map<KeyT, BoolectorNode *, KeyHash>::const_iterator
+        it=m_const_m.begin();
+        it!=m_const_m.end(); it++) {
+        boolector_release(m_btor, it->second);
+    }
+    m_const_m.clear();
+
+    for (std::map<WideKeyT, BoolectorNode *>::const_iterator
+        it=m_wide_m.begin();
+        it!=m_wide_m.end(); it++) {
+        boolector_release(m_btor, it->second);
+    }
+    m_wide_m.clear();
+}
+
+}
+}
+
@@ -0,0 +1,116 @@
+/**
+ * SolverBoolectorConstFactory.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct Btor;
+struct BoolectorNode;
+
+namespace vsc {
+namespace solvers {
+
+class SolverBoolectorSortCache;
+
+
+/**
+ * Creates bit-vector constants for a Btor instance from native words,
+ * using the integer API rather than formatting and parsing strings.
+ * Constants are interned by (width, value), such that each is created
+ * once per instance. Returned nodes are owned by the factory, and
+ * remain valid until trim() releases them or the instance is deleted.
+ */
+class SolverBoolectorConstFactory;
+using SolverBoolectorConstFactoryUP=std::unique_ptr<SolverBoolectorConstFactory>;
+class SolverBoolectorConstFactory {
+public:
+    // Interned constants retained across trim() calls
+    static const uint32_t DefaultMaxEntries = 4096;
+
+    SolverBoolectorConstFactory(
+        struct Btor                 *btor,
+        SolverBoolectorSortCache    *sorts,
+        uint32_t                    max_entries=DefaultMaxEntries);
+
+    virtual ~SolverBoolectorConstFactory();
+
+    /**
+     * Returns a constant of up to 64 bits. Bits of 'val' above
+     * 'width' are ignored.
+     */
+    struct BoolectorNode *mk(uint32_t width, uint64_t val);
+
+    /**
+     * Returns a constant of any width. 'words' holds (width+63)/64
+     * words, least-significant first.
+     */
+    struct BoolectorNode *mk(uint32_t width, const uint64_t *words);
+
+    /**
+     * Returns a constant of any width holding a 64-bit value,
+     * sign- or zero-extended as appropriate.
+     */
+    struct BoolectorNode *mkExt(uint32_t width, uint64_t val, bool is_signed);
+
+    /**
+     * Releases all interned constants once more than 'max_entries'
+     * are held. Constants referenced by other nodes remain valid, so
+     * this must only be called when no returned constant is held
+     * outside of an expression.
+     */
+    void trim();
+
+    uint32_t size() const { return m_const_m.size() + m_wide_m.size(); }
+
+private:
+    struct BoolectorNode *build(uint32_t width, const uint64_t *words);
+
+    void release();
+
+private:
+    using KeyT=std::pair<uint32_t, uint64_t>;
+    using WideKeyT=std::pair<uint32_t, std::vector<uint64_t>>;
+
+    struct KeyHash {
+        std::size_t operator()(const KeyT &k) const {
+            return std::hash<uint64_t>()(k.second ^
+                (static_cast<uint64_t>(k.first) << 56) ^
+                (static_cast<uint64_t>(k.first) * 0x9e3779b97f4a7c15ULL));
+        }
+    };
+
+private:
+    struct Btor                                                 *m_btor;
+    SolverBoolectorSortCache                                    *m_sorts;
+    uint32_t                                                    m_max_entries;
+    std::unordered_map<KeyT, struct BoolectorNode *, KeyHash>   m_const_m;
+    std::map<WideKeyT, struct BoolectorNode *>                  m_wide_m;
+
+};
+
+}
+}
+
+
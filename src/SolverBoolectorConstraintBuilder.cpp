@@ -24,11 +24,14 @@
 #include "vsc/dm/ITypeExprVal.h"
 #include "vsc/dm/impl/ValRefBool.h"
 #include "vsc/dm/impl/ValRefInt.h"
+#include "vsc/solvers/impl/RefPathConstraint.h"
 #include "vsc/solvers/impl/RefPathPtrMap.h"
 #include "vsc/solvers/impl/RefPathField.h"
 #include "vsc/solvers/impl/TaskPath2Constraint.h"
 #include "vsc/solvers/impl/TaskPath2Field.h"
+#include "SolverBoolectorConstFactory.h"
 #include "SolverBoolectorConstraintBuilder.h"
+#include "ValRefIntWords.h"
 
 
 namespace vsc {
@@ -38,9 +41,10 @@ namespace solvers {
 SolverBoolectorConstraintBuilder::SolverBoolectorConstraintBuilder(
     dmgr::IDebugMgr                         *dmgr,
     Btor                                    *btor,
+    SolverBoolectorConstFactory             *const_f,
     const RefPathPtrMap<BoolectorNode>      &field_m,
     dm::IModelField                         *root_field) :
-    m_btor(btor), m_field_m(field_m), m_root_field(root_field),
+    m_btor(btor), m_const_f(const_f), m_field_m(field_m), m_root_field(root_field),
     m_expr_sz_down(0), m_dt_mode(DataTypeMode::Literal) {
     DEBUG_INIT("vsc::solvers::SolverBoolectorConstraintBuilder", dmgr);
 }
@@ -67,6 +71,11 @@ BoolectorNode *SolverBoolectorConstraintBuilder::build(const std::vector<int32_t
 
     c->accept(m_this);
 
+    if (!m_expr.first) {
+        DEBUG_ERROR("constraint %s uses a construct not supported by the Boolector backend",
+            RefPathConstraint(path).toString().c_str());
+    }
+
     DEBUG_LEAVE("build");
     return m_expr.first;
 }
@@ -76,10 +85,7 @@ void SolverBoolectorConstraintBuilder::visitDataTypeBool(dm::IDataTypeBool *t) {
     if (m_dt_mode == DataTypeMode::Literal) {
         dm::ValRefBool val(m_val);
 
-        m_expr = {boolector_const(
-            m_btor,
-            val.get_val()?"1":"0"),
-            false};
+        m_expr = {m_const_f->mk(1, val.get_val()), false};
     } else if (m_dt_mode == DataTypeMode::RefSign) {
         m_expr.second = false;
     }
@@ -96,20 +102,9 @@ void SolverBoolectorConstraintBuilder::visitDataTypeInt(dm::IDataTypeInt *t) {
     DEBUG_ENTER("visitDataTypeInt");
     if (m_dt_mode == DataTypeMode::Literal) {
         dm::ValRefInt val(m_val);
-
-        if (val.bits() <= 64) {
-            char tmp[32];
-            sprintf(tmp, "%llx", val.get_val_u());
-            m_expr = {
-                boolector_consth(
-                    m_btor,
-                    boolector_bitvec_sort(m_btor, val.bits()),
-                    tmp),
-                t->isSigned()
-            };
-        } else {
-            // TODO:
-        }
+        std::vector<uint64_t> words(ValRefIntWords::numWords(val.bits()));
+        ValRefIntWords::get(val, val.bits(), t->isSigned(), words.data());
+        m_expr = {m_const_f->mk(val.bits(), words.data()), t->isSigned()};
     } else if (m_dt_mode == DataTypeMode::RefSign) {
         m_expr.second = t->isSigned();
     }
@@ -148,6 +143,12 @@ void SolverBoolectorConstraintBuilder::visitTypeExprBin(dm::ITypeExprBin *e) {
     e->rhs()->accept(m_this);
     ExprT rhs = m_expr;
 
+    if (!lhs.first || !rhs.first) {
+        m_expr = {0, false};
+        DEBUG_LEAVE("visitTypeExprBin -- unsupported operand");
+        return;
+    }
+
     bool is_signed = lhs.second && rhs.second;
 
     // Prepare operands
@@ -167,250 +168,268 @@ void SolverBoolectorConstraintBuilder::visitTypeExprBin(dm::ITypeExprBin *e) {
     }
 
     m_expr.second = is_signed;
-    switch (e->op()) {
-	    case dm::BinOp::Eq:
-            m_expr.first = boolector_eq(
+    m_expr.first = mkBinOp(e->op(), is_signed, lhs.first, rhs.first);
+
+    if (!m_expr.first) {
+        DEBUG("operator %d has no lowering", static_cast<int32_t>(e->op()));
+    }
+
+    DEBUG_LEAVE("visitTypeExprBin");
+}
+
+void SolverBoolectorConstraintBuilder::visitTypeExprRefBottomUp(dm::ITypeExprRefBottomUp *e) {
+    DEBUG_ENTER("visitTypeExprRefBottomUp");
+
+    DEBUG_LEAVE("visitTypeExprRefBottomUp");
+}
+
+void SolverBoolectorConstraintBuilder::visitTypeExprRefPath(dm::ITypeExprRefPath *e) {
+    DEBUG_ENTER("visitTypeExprRefPath");
+    int32_t prefix_sz = m_path_prefix.size();
+    e->getTarget()->accept(m_this);
+
+    m_path_prefix.insert(
+        m_path_prefix.end(),
+        e->getPath().begin(),
+        e->getPath().end()
+    );
+
+    m_expr.first = m_field_m.find(m_path_prefix);
+
+    DEBUG("node @ %s: %p", RefPathField(m_path_prefix).toString().c_str(), m_expr.first);
+
+    DataTypeMode dt_mode = m_dt_mode;
+    m_dt_mode = DataTypeMode::RefSign;
+    TaskPath2Field(m_root_field).toField(m_path_prefix)->getDataType()->accept(m_this);
+    m_dt_mode = dt_mode;
+
+    m_path_prefix.resize(prefix_sz);
+    DEBUG_LEAVE("visitTypeExprRefPath");
+}
+
+void SolverBoolectorConstraintBuilder::visitTypeExprRefTopDown(dm::ITypeExprRefTopDown *e) {
+    DEBUG_ENTER("visitTypeExprRefTopDown");
+
+    DEBUG_LEAVE("visitTypeExprRefTopDown");
+}
+
+void SolverBoolectorConstraintBuilder::visitTypeExprFieldRef(dm::ITypeExprFieldRef *e) { 
+#ifdef UNDEFINED
+    DEBUG_ENTER("visitTypeExprFieldRef path.size=%d prefix=%s", 
+        e->getPath().size(),
+        RefPathField(m_path_prefix).toString().c_str());
+    int32_t prefix_sz = m_path_prefix.size();
+    m_path_prefix.insert(
+        m_path_prefix.end(),
+        e->getPath().begin(),
+        e->getPath().end()
+    );
+
+    m_expr.first = m_field_m.find(m_path_prefix);
+    DEBUG("node @ %s: %p", RefPathField(m_path_prefix).toString().c_str(), m_expr.first);
+
+    DataTypeMode dt_mode = m_dt_mode;
+    m_dt_mode = DataTypeMode::RefSign;
+    TaskPath2Field(m_root_field).toField(m_path_prefix)->getDataType()->accept(m_this);
+    m_dt_mode = dt_mode;
+
+    m_path_prefix.resize(prefix_sz);
+    DEBUG_LEAVE("visitTypeExprFieldRef");
+#endif /* UNDEFINED */
+}
+
+void SolverBoolectorConstraintBuilder::visitTypeExprRangelist(dm::ITypeExprRangelist *e) { 
+
+}
+
+void SolverBoolectorConstraintBuilder::visitTypeExprVal(dm::ITypeExprVal *e) { 
+    DEBUG_ENTER("visitTypeExprVal");
+    m_val = e->val();
+    e->val().type()->accept(m_this);
+
+    DEBUG_LEAVE("visitTypeExprVal");
+}
+
+BoolectorNode *SolverBoolectorConstraintBuilder::mkBinOp(
+        dm::BinOp                   op,
+        bool                        is_signed,
+        BoolectorNode               *lhs,
+        BoolectorNode               *rhs) {
+    // Operators without a lowering return null
+    BoolectorNode *ret = 0;
+    switch (op) {
+        case dm::BinOp::Eq:
+            ret = boolector_eq(
                 m_btor,
-                lhs.first,
-                rhs.first);
+                lhs,
+                rhs);
+            break;
         case dm::BinOp::Ne:
-            m_expr.first = boolector_ne(
+            ret = boolector_ne(
                 m_btor,
-                lhs.first,
-                rhs.first);
+                lhs,
+                rhs);
             break;
         case dm::BinOp::Gt:
             if (is_signed) {
-                m_expr.first = boolector_sgt(
+                ret = boolector_sgt(
                     m_btor,
-                    lhs.first,
-                    rhs.first);
+                    lhs,
+                    rhs);
             } else {
-                m_expr.first = boolector_ugt(
+                ret = boolector_ugt(
                     m_btor,
-                    lhs.first,
-                    rhs.first);
+                    lhs,
+                    rhs);
             }
             break;
         case dm::BinOp::Ge:
             if (is_signed) {
-                m_expr.first = boolector_sgte(
+                ret = boolector_sgte(
                     m_btor,
-                    lhs.first,
-                    rhs.first);
+                    lhs,
+                    rhs);
             } else {
-                m_expr.first = boolector_ugte(
+                ret = boolector_ugte(
                     m_btor,
-                    lhs.first,
-                    rhs.first);
+                    lhs,
+                    rhs);
             }
             break;
         case dm::BinOp::Lt:
             if (is_signed) {
-                m_expr.first = boolector_slt(
+                ret = boolector_slt(
                     m_btor,
-                    lhs.first,
-                    rhs.first);
+                    lhs,
+                    rhs);
             } else {
-                m_expr.first = boolector_ult(
+                ret = boolector_ult(
                     m_btor,
-                    lhs.first,
-                    rhs.first);
+                    lhs,
+                    rhs);
             }
             break;
         case dm::BinOp::Le:
             if (is_signed) {
-                m_expr.first = boolector_slte(
+                ret = boolector_slte(
                     m_btor,
-                    lhs.first,
-                    rhs.first);
+                    lhs,
+                    rhs);
             } else {
-                m_expr.first = boolector_ulte(
+                ret = boolector_ulte(
                     m_btor,
-                    lhs.first,
-                    rhs.first);
+                    lhs,
+                    rhs);
             }
             break;
-            m_expr.first = boolector_add(
+        case dm::BinOp::Add:
+            ret = boolector_add(
                 m_btor,
-                lhs.first,
-                rhs.first);
+                lhs,
+                rhs);
             break;
         case dm::BinOp::Sub:
-            m_expr.first = boolector_sub(
+            ret = boolector_sub(
                 m_btor,
-                lhs.first,
-                rhs.first);
+                lhs,
+                rhs);
             break;
         case dm::BinOp::Div:
             if (is_signed) {
-                m_expr.first = boolector_sdiv(
+                ret = boolector_sdiv(
                     m_btor,
-                    lhs.first,
-                    rhs.first);
+                    lhs,
+                    rhs);
             } else {
-                m_expr.first = boolector_udiv(
+                ret = boolector_udiv(
                     m_btor,
-                    lhs.first,
-                    rhs.first);
+                    lhs,
+                    rhs);
             }
             break;
         case dm::BinOp::Mul:
-            m_expr.first = boolector_mul(
+            ret = boolector_mul(
                 m_btor,
-                lhs.first,
-                rhs.first);
+                lhs,
+                rhs);
             break;
         case dm::BinOp::Mod:
             if (is_signed) {
-                m_expr.first = boolector_smod(
+                ret = boolector_smod(
                     m_btor,
-                    lhs.first,
-                    rhs.first);
+                    lhs,
+                    rhs);
             } else {
-                m_expr.first = boolector_umulo(
+                ret = boolector_urem(
                     m_btor,
-                    lhs.first,
-                    rhs.first);
+                    lhs,
+                    rhs);
             }
             break;
         case dm::BinOp::BinAnd:
-            m_expr.first = boolector_and(
+            ret = boolector_and(
                 m_btor,
-                lhs.first,
-                rhs.first);
+                lhs,
+                rhs);
             break;
         case dm::BinOp::BinOr:
-            m_expr.first = boolector_or(
+            ret = boolector_or(
                 m_btor,
-                lhs.first,
-                rhs.first);
+                lhs,
+                rhs);
             break;
         case dm::BinOp::BinXor:
-            m_expr.first = boolector_xor(
+            ret = boolector_xor(
                 m_btor,
-                lhs.first,
-                rhs.first);
+                lhs,
+                rhs);
             break;
         case dm::BinOp::LogAnd:
-            m_expr.first = boolector_and(
+            ret = boolector_and(
                 m_btor,
-                lhs.first,
-                rhs.first);
+                lhs,
+                rhs);
             break;
         case dm::BinOp::LogOr:
-            m_expr.first = boolector_or(
+            ret = boolector_or(
                 m_btor,
-                lhs.first,
-                rhs.first);
+                lhs,
+                rhs);
             break;
         case dm::BinOp::LogXor:
-            m_expr.first = boolector_xor(
+            ret = boolector_xor(
                 m_btor,
-                lhs.first,
-                rhs.first);
+                lhs,
+                rhs);
             break;
         case dm::BinOp::Sll:
-            m_expr.first = boolector_sll(
+            ret = boolector_sll(
                 m_btor,
-                lhs.first,
-                rhs.first);
+                lhs,
+                rhs);
             break;
         case dm::BinOp::Srl:
-            m_expr.first = boolector_srl(
+            ret = boolector_srl(
                 m_btor,
-                lhs.first,
-                rhs.first);
+                lhs,
+                rhs);
+            break;
+        default:
             break;
     }
 
-    DEBUG_LEAVE("visitTypeExprBin");
-}
-
-void SolverBoolectorConstraintBuilder::visitTypeExprRefBottomUp(dm::ITypeExprRefBottomUp *e) {
-    DEBUG_ENTER("visitTypeExprRefBottomUp");
-
-    DEBUG_LEAVE("visitTypeExprRefBottomUp");
-}
-
-void SolverBoolectorConstraintBuilder::visitTypeExprRefPath(dm::ITypeExprRefPath *e) {
-    DEBUG_ENTER("visitTypeExprRefPath");
-    int32_t prefix_sz = m_path_prefix.size();
-    e->getTarget()->accept(m_this);
-
-    m_path_prefix.insert(
-        m_path_prefix.end(),
-        e->getPath().begin(),
-        e->getPath().end()
-    );
-
-    m_expr.first = m_field_m.find(m_path_prefix);
-
-    DEBUG("node @ %s: %p", RefPathField(m_path_prefix).toString().c_str(), m_expr.first);
-
-    DataTypeMode dt_mode = m_dt_mode;
-    m_dt_mode = DataTypeMode::RefSign;
-    TaskPath2Field(m_root_field).toField(m_path_prefix)->getDataType()->accept(m_this);
-    m_dt_mode = dt_mode;
-
-    m_path_prefix.resize(prefix_sz);
-    DEBUG_LEAVE("visitTypeExprRefPath");
-}
-
-void SolverBoolectorConstraintBuilder::visitTypeExprRefTopDown(dm::ITypeExprRefTopDown *e) {
-    DEBUG_ENTER("visitTypeExprRefTopDown");
-
-    DEBUG_LEAVE("visitTypeExprRefTopDown");
-}
-
-void SolverBoolectorConstraintBuilder::visitTypeExprFieldRef(dm::ITypeExprFieldRef *e) { 
-#ifdef UNDEFINED
-    DEBUG_ENTER("visitTypeExprFieldRef path.size=%d prefix=%s", 
-        e->getPath().size(),
-        RefPathField(m_path_prefix).toString().c_str());
-    int32_t prefix_sz = m_path_prefix.size();
-    m_path_prefix.insert(
-        m_path_prefix.end(),
-        e->getPath().begin(),
-        e->getPath().end()
-    );
-
-    m_expr.first = m_field_m.find(m_path_prefix);
-    DEBUG("node @ %s: %p", RefPathField(m_path_prefix).toString().c_str(), m_expr.first);
-
-    DataTypeMode dt_mode = m_dt_mode;
-    m_dt_mode = DataTypeMode::RefSign;
-    TaskPath2Field(m_root_field).toField(m_path_prefix)->getDataType()->accept(m_this);
-    m_dt_mode = dt_mode;
-
-    m_path_prefix.resize(prefix_sz);
-    DEBUG_LEAVE("visitTypeExprFieldRef");
-#endif /* UNDEFINED */
-}
-
-void SolverBoolectorConstraintBuilder::visitTypeExprRangelist(dm::ITypeExprRangelist *e) { 
-
-}
-
-void SolverBoolectorConstraintBuilder::visitTypeExprVal(dm::ITypeExprVal *e) { 
-    DEBUG_ENTER("visitTypeExprVal");
-    m_val = e->val();
-    e->val().type()->accept(m_this);
-
-    DEBUG_LEAVE("visitTypeExprVal");
+    return ret;
 }
 
 SolverBoolectorConstraintBuilder::ExprT SolverBoolectorConstraintBuilder::booleanize(const ExprT &expr) {
-    int32_t expr_sz = boolector_bitvec_sort_get_width(
-        m_btor,
-        boolector_get_sort(m_btor, expr.first));
+    int32_t expr_sz = boolector_get_width(m_btor, expr.first);
     
     if (expr_sz != 1) {
         return {
             boolector_ne(
                 m_btor,
                 expr.first,
-                boolector_zero(m_btor, boolector_get_sort(m_btor, expr.first))),
+                m_const_f->mk(expr_sz, static_cast<uint64_t>(0))),
             expr.second};
     } else {
         return expr;
@@ -418,21 +437,19 @@ SolverBoolectorConstraintBuilder::ExprT SolverBoolectorConstraintBuilder::boolea
 }
 
 SolverBoolectorConstraintBuilder::ExprT SolverBoolectorConstraintBuilder::maxsize(const ExprT &expr, const ExprT &other) {
-    int32_t expr_sz = boolector_bitvec_sort_get_width(
-        m_btor,
-        boolector_get_sort(m_btor, expr.first));
-    int32_t other_sz = boolector_bitvec_sort_get_width(
-        m_btor,
-        boolector_get_sort(m_btor, other.first));
+    int32_t expr_sz = boolector_get_width(m_btor, expr.first);
+    int32_t other_sz = boolector_get_width(m_btor, other.first);
     bool is_signed = (expr.second && other.second);
     int32_t max = (other_sz>m_expr_sz_down)?other_sz:m_expr_sz_down;
 
     if (max > expr_sz) {
+        BoolectorNode *ret;
         if (is_signed) {
-            return { boolector_sext( m_btor, expr.first, (max-expr_sz)), is_signed };
+            ret = boolector_sext(m_btor, expr.first, (max-expr_sz));
         } else {
-            return { boolector_uext( m_btor, expr.first, (max-expr_sz)), is_signed };
+            ret = boolector_uext(m_btor, expr.first, (max-expr_sz));
         }
+        return {ret, is_signed};
     } else {
         return expr;
     }
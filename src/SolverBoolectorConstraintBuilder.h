@@ -32,6 +32,7 @@ namespace vsc {
 namespace solvers {
 
 template <class T> class RefPathPtrMap;
+class SolverBoolectorConstFactory;
 
 
 
@@ -40,6 +41,7 @@ public:
     SolverBoolectorConstraintBuilder(
         dmgr::IDebugMgr                             *dmgr,
         struct Btor                                 *btor,
+        SolverBoolectorConstFactory                 *const_f,
         const RefPathPtrMap<struct BoolectorNode>   &field_m,
         dm::IModelField                             *root_field
     );
@@ -87,6 +89,12 @@ protected:
     };
 
 protected:
+    struct BoolectorNode *mkBinOp(
+        dm::BinOp                   op,
+        bool                        is_signed,
+        struct BoolectorNode        *lhs,
+        struct BoolectorNode        *rhs);
+
     ExprT booleanize(const ExprT &);
 
     ExprT maxsize(const ExprT &expr, const ExprT &other);
@@ -94,6 +102,7 @@ protected:
 private:
     static dmgr::IDebug                             *m_dbg;
     struct Btor                                     *m_btor;
+    SolverBoolectorConstFactory                     *m_const_f;
     const RefPathPtrMap<struct BoolectorNode>       &m_field_m;
     dm::IModelField                                 *m_root_field;
     std::vector<int32_t>                            m_path_prefix;
@@ -23,7 +23,11 @@
 #include "vsc/dm/impl/ValRefBool.h"
 #include "vsc/dm/impl/ValRefInt.h"
 #include "vsc/solvers/impl/TaskPath2Field.h"
+#include "vsc/solvers/impl/TaskPath2ValRef.h"
+#include "SolverBoolectorConstFactory.h"
 #include "SolverBoolectorFieldBuilder.h"
+#include "SolverBoolectorSortCache.h"
+#include "ValRefIntWords.h"
 
 
 namespace vsc {
@@ -31,10 +35,12 @@ namespace solvers {
 
 
 SolverBoolectorFieldBuilder::SolverBoolectorFieldBuilder(
-    dmgr::IDebugMgr         *dmgr,
-    Btor                    *btor,
-    vsc::dm::IModelField    *root_field) : m_btor(btor), 
-        m_root_field(root_field), m_is_fixed(false) {
+    dmgr::IDebugMgr                 *dmgr,
+    Btor                            *btor,
+    SolverBoolectorSortCache        *sorts,
+    SolverBoolectorConstFactory     *const_f,
+    vsc::dm::IModelField            *root_field) : m_btor(btor), 
+        m_sorts(sorts), m_const_f(const_f), m_root_field(root_field), m_is_fixed(false) {
     DEBUG_INIT("vsc::solvers::SolverBoolectorFieldBuilder", dmgr);
 
 
@@ -49,8 +55,14 @@ BoolectorNode *SolverBoolectorFieldBuilder::build(
         bool                        is_fixed) {
     DEBUG_ENTER("build");
     m_node = 0;
+    m_words.clear();
     m_is_fixed = is_fixed;
 
+    // Fixed fields are built as a literal holding the current value
+    if (is_fixed) {
+        m_val = TaskPath2ValRef(m_root_field).toMutVal(path);
+    }
+
     // Resolve to a field that we can visit
     dm::ITypeField *field = TaskPath2Field(m_root_field).toField(path);
     field->accept(m_this);
@@ -63,15 +75,12 @@ void SolverBoolectorFieldBuilder::visitDataTypeBool(dm::IDataTypeBool *t) {
     DEBUG_ENTER("visitDataTypeBool");
     if (m_is_fixed) {
         // Create a single-bit constant
-//        dm::ValRefBool val(m_field->getInit());
-// TODO:
-        dm::ValRefBool val;
-        m_node = boolector_const(
-            m_btor,
-            val.get_val()?"1":"0");
+        dm::ValRefBool val(m_val);
+        m_words.push_back(val.get_val());
+        m_node = m_const_f->mk(1, m_words.at(0));
     } else {
         // Create a single-bit variable
-        m_node = boolector_var(m_btor, get_sort(1), 0);
+        m_node = boolector_var(m_btor, m_sorts->get(1), 0);
     }
 
     DEBUG_LEAVE("visitDataTypeBool");
@@ -90,22 +99,12 @@ void SolverBoolectorFieldBuilder::visitDataTypeEnum(dm::IDataTypeEnum *t) {
 void SolverBoolectorFieldBuilder::visitDataTypeInt(dm::IDataTypeInt *t) {
     DEBUG_ENTER("visitDataTypeInt");
     if (m_is_fixed) {
-        if (t->width() <= 64) {
-//            dm::ValRefInt val(m_field->getInit());
-            // TODO:
-            dm::ValRefInt val;
-            char tmp[32];
-            sprintf(tmp, "0x%llx", val.get_val_u());
-            m_node = boolector_consth(
-                m_btor,
-                get_sort(t->width()),
-                tmp);
-        } else {
-//            char *tmp = alloca(t->width()+1);
-            // TODO:
-        }
+        dm::ValRefInt val(m_val);
+        m_words.resize(ValRefIntWords::numWords(t->width()));
+        ValRefIntWords::get(val, t->width(), t->isSigned(), m_words.data());
+        m_node = m_const_f->mk(t->width(), m_words.data());
     } else {
-        m_node = boolector_var(m_btor, get_sort(t->width()), 0);
+        m_node = boolector_var(m_btor, m_sorts->get(t->width()), 0);
     }
     DEBUG_LEAVE("visitDataTypeInt");
 }
@@ -117,10 +116,6 @@ void SolverBoolectorFieldBuilder::visitTypeFieldPhy(dm::ITypeFieldPhy *f) {
     DEBUG_LEAVE("visitTypeFieldPhy");
 }
 
-struct BoolectorAnonymous *SolverBoolectorFieldBuilder::get_sort(int32_t width) {
-    return boolector_bitvec_sort(m_btor, width);
-};
-
 dmgr::IDebug *SolverBoolectorFieldBuilder::m_dbg = 0;
 
 }
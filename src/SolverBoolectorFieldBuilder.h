@@ -19,10 +19,11 @@
  *     Author: 
  */
 #pragma once
-#include <map>
+#include <stdint.h>
 #include <vector>
 #include "dmgr/IDebugMgr.h"
 #include "vsc/dm/IModelField.h"
+#include "vsc/dm/impl/ValRef.h"
 #include "vsc/dm/impl/VisitorBase.h"
 
 struct Btor;
@@ -32,14 +33,18 @@ struct BoolectorAnonymous;
 namespace vsc {
 namespace solvers {
 
+class SolverBoolectorConstFactory;
+class SolverBoolectorSortCache;
 
 
 class SolverBoolectorFieldBuilder : public vsc::dm::VisitorBase {
 public:
     SolverBoolectorFieldBuilder(
         dmgr::IDebugMgr         *dmgr,
-        struct Btor             *btor,
-        vsc::dm::IModelField    *root_field);
+        struct Btor                     *btor,
+        SolverBoolectorSortCache        *sorts,
+        SolverBoolectorConstFactory     *const_f,
+        vsc::dm::IModelField            *root_field);
 
     virtual ~SolverBoolectorFieldBuilder();
 
@@ -47,6 +52,12 @@ public:
         const std::vector<int32_t>  &path,
         bool                        is_fixed);
 
+    /**
+     * Returns the value of the last fixed field built, as words,
+     * least-significant first
+     */
+    const std::vector<uint64_t> &getValue() const { return m_words; }
+
 	virtual void visitDataTypeBool(dm::IDataTypeBool *t) override;
 
 	virtual void visitDataTypeEnum(dm::IDataTypeEnum *t) override;
@@ -55,18 +66,17 @@ public:
 
 	virtual void visitTypeFieldPhy(dm::ITypeFieldPhy *f) override;
 
-protected:
-    struct BoolectorAnonymous *get_sort(int32_t width);
-
-
 private:
     static dmgr::IDebug                             *m_dbg;
     struct Btor                                     *m_btor;
+    SolverBoolectorSortCache                        *m_sorts;
+    SolverBoolectorConstFactory                     *m_const_f;
     vsc::dm::IModelField                            *m_root_field;
     bool                                            m_is_fixed;
     dm::ITypeFieldPhy                               *m_field;
     struct BoolectorNode                            *m_node;
-    std::map<int32_t,struct BoolectorAnonymous *>   m_sort_m;
+    dm::ValRef                                      m_val;
+    std::vector<uint64_t>                           m_words;
 
 };
 
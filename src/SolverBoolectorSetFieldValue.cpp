@@ -18,12 +18,15 @@
  * Created on:
  *     Author:
  */
+#include <string.h>
 #include "boolector/boolector.h"
 #include "dmgr/impl/DebugMacros.h"
+#include "vsc/dm/impl/ValRefBool.h"
 #include "vsc/dm/impl/ValRefInt.h"
 #include "vsc/solvers/impl/TaskPath2ValRef.h"
 #include "vsc/solvers/impl/TaskPath2Field.h"
 #include "SolverBoolectorSetFieldValue.h"
+#include "ValRefIntWords.h"
 
 
 namespace vsc {
@@ -32,9 +35,8 @@ namespace solvers {
 
 SolverBoolectorSetFieldValue::SolverBoolectorSetFieldValue(
     dmgr::IDebugMgr     *dmgr,
-    Btor                *btor,
-    dm::IModelField     *root_field) : 
-    m_btor(btor), m_root_field(root_field) {
+    Btor                *btor) : 
+    m_btor(btor), m_n_words(0), m_kind(Kind::Int) {
     DEBUG_INIT("vsc::solvers::SolverBoolectorSetFieldValue", dmgr);
 }
 
@@ -42,53 +44,118 @@ SolverBoolectorSetFieldValue::~SolverBoolectorSetFieldValue() {
 
 }
 
-void SolverBoolectorSetFieldValue::set(
-        const std::vector<int32_t> &path, 
-        struct BoolectorNode       *node) {
-    DEBUG_ENTER("set");
-    m_node = node;
-    dm::ITypeField *field = TaskPath2Field(m_root_field).toField(path);
-    DEBUG("Field: %s", field->name().c_str());
-    m_val = TaskPath2ValRef(m_root_field).toMutVal(path);
-    field->getDataType()->accept(m_this);
-    DEBUG_LEAVE("set");
-}
+void SolverBoolectorSetFieldValue::init(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset,
+        const RefPathPtrMap<BoolectorNode>      &field_m) {
+    DEBUG_ENTER("init");
+    m_slots.clear();
+    m_n_words = 0;
+
+    for (RefPathMap<SolveSetFieldType>::iterator
+        it=solveset->getFields().begin(); it.next(); ) {
+        if (it.value() != SolveSetFieldType::Target) {
+            continue;
+        }
 
-void SolverBoolectorSetFieldValue::visitDataTypeBool(dm::IDataTypeBool *t) {
-    DEBUG_ENTER("visitDataTypeBool");
+        BoolectorNode *node = field_m.find(it.path());
+        if (!node) {
+            // Field types without a solver representation are left as-is
+            continue;
+        }
 
-    DEBUG_LEAVE("visitDataTypeBool");
-}
+        TaskPath2Field(root_field).toField(it.path())->getDataType()->accept(m_this);
 
-void SolverBoolectorSetFieldValue::visitDataTypeEnum(dm::IDataTypeEnum *t) {
-    DEBUG_ENTER("visitDataTypeEnum");
+        Slot slot;
+        slot.path = it.path();
+        slot.node = node;
+        slot.kind = m_kind;
+        slot.width = boolector_get_width(m_btor, node);
+        slot.offset = m_n_words;
+        m_n_words += (slot.width-1)/64+1;
+        m_slots.push_back(slot);
+    }
 
-    DEBUG_LEAVE("visitDataTypeEnum");
+    DEBUG_LEAVE("init %d slots ; %d words", m_slots.size(), m_n_words);
 }
 
-void SolverBoolectorSetFieldValue::visitDataTypeInt(dm::IDataTypeInt *t) {
-    DEBUG_ENTER("visitDataTypeInt");
-
-    const char *bits = boolector_get_bits(
-        m_btor, 
-        boolector_get_value(m_btor, m_node));
-    DEBUG("bits: %s\n", bits);
-    if (t->width() <= 64) {
-        uint64_t val = 0;
-        dm::ValRefInt val_i(m_val);
-
-        for (uint32_t i=0; i<t->width() && bits[i]; i++) {
-            val <<= 1;
-            val |= (bits[i] == '1');
+void SolverBoolectorSetFieldValue::read(std::vector<uint64_t> &words) {
+    words.resize(m_n_words);
+    for (std::vector<Slot>::const_iterator
+        it=m_slots.begin();
+        it!=m_slots.end(); it++) {
+        // The assignment string is owned by Boolector, but isn't
+        // copied or parsed character-by-character
+        const char *bits = boolector_bv_assignment(m_btor, it->node);
+        bits2words(bits, it->width, &words.at(it->offset));
+        boolector_free_bv_assignment(m_btor, bits);
+    }
+}
+
+void SolverBoolectorSetFieldValue::write(
+        dm::IModelField                         *root_field,
+        const std::vector<uint64_t>             &words) {
+    DEBUG_ENTER("write");
+    for (std::vector<Slot>::const_iterator
+        it=m_slots.begin();
+        it!=m_slots.end(); it++) {
+        dm::ValRef val(TaskPath2ValRef(root_field).toMutVal(it->path));
+        switch (it->kind) {
+            case Kind::Bool: {
+                dm::ValRefBool val_b(val);
+                val_b.set_val(words.at(it->offset) & 1);
+            } break;
+            case Kind::Enum:
+            case Kind::Int: {
+                dm::ValRefInt val_i(val);
+                ValRefIntWords::set(val_i, &words.at(it->offset));
+            } break;
         }
+    }
+    DEBUG_LEAVE("write");
+}
 
-        val_i.set_val(val);
-    } else {
-        // TODO:
+void SolverBoolectorSetFieldValue::bits2words(
+        const char                              *bits,
+        uint32_t                                width,
+        uint64_t                                *words) {
+    uint32_t n_words = (width-1)/64+1;
+    for (uint32_t i=0; i<n_words; i++) {
+        words[i] = 0;
     }
-    boolector_free_bits(m_btor, bits);
 
-    DEBUG_LEAVE("visitDataTypeInt");
+    // Starting from the LSB, each group of eight characters is packed
+    // with a single multiply. The low bit of '0' and '1' is the bit 
+    // value, so don't-care characters read as 0.
+    uint32_t bit = 0;
+    int32_t end = width;
+    for (; end >= 8; end-=8, bit+=8) {
+        uint64_t c;
+        memcpy(&c, &bits[end-8], sizeof(c));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+        c = __builtin_bswap64(c);
+#endif
+        c &= 0x0101010101010101ULL;
+        uint64_t byte = (c * 0x8040201008040201ULL) >> 56;
+        words[bit/64] |= (byte << (bit%64));
+    }
+
+    // Remaining most-significant bits
+    for (int32_t i=end-1; i>=0; i--, bit++) {
+        words[bit/64] |= (static_cast<uint64_t>(bits[i] & 1) << (bit%64));
+    }
+}
+
+void SolverBoolectorSetFieldValue::visitDataTypeBool(dm::IDataTypeBool *t) {
+    m_kind = Kind::Bool;
+}
+
+void SolverBoolectorSetFieldValue::visitDataTypeEnum(dm::IDataTypeEnum *t) {
+    m_kind = Kind::Enum;
+}
+
+void SolverBoolectorSetFieldValue::visitDataTypeInt(dm::IDataTypeInt *t) {
+    m_kind = Kind::Int;
 }
 
 dmgr::IDebug *SolverBoolectorSetFieldValue::m_dbg = 0;
@@ -19,10 +19,15 @@
  *     Author: 
  */
 #pragma once
+#include <stdint.h>
+#include <memory>
+#include <vector>
 #include "dmgr/IDebugMgr.h"
 #include "vsc/dm/impl/VisitorBase.h"
-#include "vsc/dm/impl/ValRef.h"
+#include "vsc/solvers/ISolveSet.h"
+#include "vsc/solvers/impl/RefPathPtrMap.h"
 
+struct Btor;
 struct BoolectorNode;
 
 namespace vsc {
@@ -30,18 +35,68 @@ namespace solvers {
 
 
 
+/**
+ * Reads back the model values of a solve set's target fields. The
+ * fields are resolved to value slots once per solve set. Values are
+ * read as packed words, least-significant first, such that solutions
+ * can be stored and written back without string conversion.
+ */
+class SolverBoolectorSetFieldValue;
+using SolverBoolectorSetFieldValueUP=std::unique_ptr<SolverBoolectorSetFieldValue>;
 class SolverBoolectorSetFieldValue : public virtual dm::VisitorBase {
 public:
+    enum class Kind {
+        Bool,
+        Enum,
+        Int
+    };
+
+    struct Slot {
+        std::vector<int32_t>        path;
+        struct BoolectorNode        *node;
+        Kind                        kind;
+        uint32_t                    width;
+        // Offset of the slot's first word in a solution
+        uint32_t                    offset;
+    };
+
     SolverBoolectorSetFieldValue(
         dmgr::IDebugMgr     *dmgr,
-        struct Btor         *btor,
-        dm::IModelField     *root_field);
+        struct Btor         *btor);
 
     virtual ~SolverBoolectorSetFieldValue();
 
-    void set(
-        const std::vector<int32_t> &path, 
-        struct BoolectorNode       *node);
+    /**
+     * Resolves the target fields of a solve set to value slots
+     */
+    void init(
+        dm::IModelField                             *root_field,
+        ISolveSet                                   *solveset,
+        const RefPathPtrMap<struct BoolectorNode>   &field_m);
+
+    /**
+     * Reads the current model values of all target fields
+     */
+    void read(std::vector<uint64_t> &words);
+
+    /**
+     * Sets the target fields of 'root_field' from a solution
+     */
+    void write(
+        dm::IModelField                             *root_field,
+        const std::vector<uint64_t>                 &words);
+
+    const std::vector<Slot> &getSlots() const { return m_slots; }
+
+    uint32_t getNumWords() const { return m_n_words; }
+
+    /**
+     * Packs a binary string, MSB first, into words 
+     */
+    static void bits2words(
+        const char                                  *bits,
+        uint32_t                                    width,
+        uint64_t                                    *words);
 
 	virtual void visitDataTypeBool(dm::IDataTypeBool *t) override;
 
@@ -52,9 +107,9 @@ public:
 private:
     static dmgr::IDebug             *m_dbg;
     struct Btor                     *m_btor;
-    dm::IModelField                 *m_root_field;
-    struct BoolectorNode            *m_node;
-    dm::ValRef                      m_val;
+    std::vector<Slot>               m_slots;
+    uint32_t                        m_n_words;
+    Kind                            m_kind;
 
 };
 
@@ -0,0 +1,61 @@
+/*
+ * SolverBoolectorSortCache.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "boolector/boolector.h"
+#include "SolverBoolectorSortCache.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+SolverBoolectorSortCache::SolverBoolectorSortCache(Btor *btor) :
+    m_btor(btor), m_size(0) {
+
+}
+
+SolverBoolectorSortCache::~SolverBoolectorSortCache() {
+
+}
+
+BoolectorSort SolverBoolectorSortCache::mk(uint32_t width) {
+    if (width >= m_sort_l.size()) {
+        m_sort_l.resize(width+1, 0);
+    }
+    m_sort_l[width] = boolector_bitvec_sort(m_btor, width);
+    m_size++;
+    return m_sort_l[width];
+}
+
+void SolverBoolectorSortCache::release() {
+    for (std::vector<BoolectorSort>::const_iterator
+        it=m_sort_l.begin();
+        it!=m_sort_l.end(); it++) {
+        if (*it) {
+            boolector_release_sort(m_btor, *it);
+        }
+    }
+    m_sort_l.clear();
+    m_size = 0;
+}
+
+}
+}
+
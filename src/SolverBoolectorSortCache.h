@@ -0,0 +1,73 @@
+/**
+ * SolverBoolectorSortCache.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+struct Btor;
+struct BoolectorAnonymous;
+
+namespace vsc {
+namespace solvers {
+
+
+
+/**
+ * Bit-vector sorts of a Btor instance, indexed by width. Each sort is
+ * created once, and is shared by all builders of the instance.
+ */
+class SolverBoolectorSortCache;
+using SolverBoolectorSortCacheUP=std::unique_ptr<SolverBoolectorSortCache>;
+class SolverBoolectorSortCache {
+public:
+    SolverBoolectorSortCache(struct Btor *btor);
+
+    virtual ~SolverBoolectorSortCache();
+
+    struct BoolectorAnonymous *get(uint32_t width) {
+        if (width < m_sort_l.size() && m_sort_l[width]) {
+            return m_sort_l[width];
+        }
+        return mk(width);
+    }
+
+    /**
+     * Releases all sorts. Must be called before the instance is deleted
+     */
+    void release();
+
+    uint32_t size() const { return m_size; }
+
+private:
+    struct BoolectorAnonymous *mk(uint32_t width);
+
+private:
+    struct Btor                                 *m_btor;
+    std::vector<struct BoolectorAnonymous *>    m_sort_l;
+    uint32_t                                    m_size;
+
+};
+
+}
+}
+
+
@@ -0,0 +1,120 @@
+/*
+ * SolverBoolectorTemplate.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "boolector/boolector.h"
+#include "dmgr/impl/DebugMacros.h"
+#include "SolverBoolectorConstraintBuilder.h"
+#include "SolverBoolectorFieldBuilder.h"
+#include "SolverBoolectorTemplate.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+SolverBoolectorTemplate::SolverBoolectorTemplate(dmgr::IDebugMgr *dmgr) :
+    m_dmgr(dmgr), m_btor(boolector_new()), m_sorts(m_btor),
+    m_const_f(m_btor, &m_sorts), m_built(false),
+    m_lowered(false) {
+    DEBUG_INIT("vsc::solvers::SolverBoolectorTemplate", dmgr);
+
+    // Options are copied to clones
+	boolector_set_opt(m_btor, BTOR_OPT_INCREMENTAL, 1);
+	boolector_set_opt(m_btor, BTOR_OPT_MODEL_GEN, 1);
+}
+
+SolverBoolectorTemplate::~SolverBoolectorTemplate() {
+    m_sorts.release();
+	boolector_release_all(m_btor);
+	boolector_delete(m_btor);
+}
+
+Btor *SolverBoolectorTemplate::clone(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset,
+        RefPathPtrMap<BoolectorNode>            &field_m) {
+    DEBUG_ENTER("clone");
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_built) {
+        m_lowered = lower(m_dmgr, m_btor, &m_sorts, &m_const_f, root_field, solveset, m_field_m);
+        m_built = true;
+    }
+
+    // Nodes in a clone have the same IDs as in the master
+    Btor *ret = boolector_clone(m_btor);
+    for (RefPathMap<SolveSetFieldType>::iterator
+        it=solveset->getFields().begin(); it.next(); ) {
+        BoolectorNode *node = m_field_m.find(it.path());
+        field_m.add(
+            it.path(),
+            (node)?boolector_match_node(ret, node):0);
+    }
+
+    DEBUG_LEAVE("clone");
+    return ret;
+}
+
+bool SolverBoolectorTemplate::lower(
+        dmgr::IDebugMgr                         *dmgr,
+        Btor                                    *btor,
+        SolverBoolectorSortCache                *sorts,
+        SolverBoolectorConstFactory             *const_f,
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset,
+        RefPathPtrMap<BoolectorNode>            &field_m) {
+    // Solve set will tell us what fields are:
+    // - target
+    // - have a fixed value
+    // All fields are represented by variables. The value of 
+    // fixed fields is bound with an assumption on each solve,
+    // such that the asserted formula remains valid across calls.
+    SolverBoolectorFieldBuilder builder(
+        dmgr, btor, sorts, const_f, root_field);
+    for (RefPathMap<SolveSetFieldType>::iterator
+        it=solveset->getFields().begin(); it.next(); ) {
+        field_m.add(
+            it.path(),
+            builder.build(it.path(), false));
+    }
+
+    // Create and assert all hard constraints. The builder reports
+    // constraints it can't lower, which are not asserted
+    bool ret = true;
+    SolverBoolectorConstraintBuilder c_builder(
+        dmgr, btor, const_f, field_m, root_field);
+    for (RefPathSet::iterator
+        it=solveset->getConstraints().begin(); it.next(); ) {
+        BoolectorNode *c = c_builder.build(it.path());
+        if (c) {
+            boolector_assert(btor, c);
+        } else {
+            ret = false;
+        }
+    }
+
+    return ret;
+}
+
+dmgr::IDebug *SolverBoolectorTemplate::m_dbg = 0;
+
+}
+}
+
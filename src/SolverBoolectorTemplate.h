@@ -0,0 +1,101 @@
+/**
+ * SolverBoolectorTemplate.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <memory>
+#include <mutex>
+#include "dmgr/IDebugMgr.h"
+#include "vsc/dm/IModelField.h"
+#include "vsc/solvers/ISolveSet.h"
+#include "vsc/solvers/impl/RefPathPtrMap.h"
+#include "SolverBoolectorConstFactory.h"
+#include "SolverBoolectorSortCache.h"
+
+struct Btor;
+struct BoolectorNode;
+
+namespace vsc {
+namespace solvers {
+
+
+
+/**
+ * Compiled formula of a solve set, lowered once into a master Btor
+ * instance that is never solved. Solvers of equivalent solve sets
+ * start from a clone of the master, rather than re-lowering fields
+ * and constraints. Cloning is serialized, since a Btor instance 
+ * isn't safe to access from multiple threads.
+ */
+class SolverBoolectorTemplate;
+using SolverBoolectorTemplateUP=std::unique_ptr<SolverBoolectorTemplate>;
+using SolverBoolectorTemplateSP=std::shared_ptr<SolverBoolectorTemplate>;
+class SolverBoolectorTemplate {
+public:
+    SolverBoolectorTemplate(dmgr::IDebugMgr *dmgr);
+
+    virtual ~SolverBoolectorTemplate();
+
+    /**
+     * Returns a clone of the master instance, lowering the solve set 
+     * on first use. Clone nodes of the solve-set fields are added to
+     * 'field_m'
+     */
+    struct Btor *clone(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset,
+        RefPathPtrMap<struct BoolectorNode>     &field_m);
+
+    /**
+     * Returns false if a constraint of the solve set couldn't be
+     * lowered. Only valid once the master has been built
+     */
+    bool isLowered() const { return m_lowered; }
+
+    /**
+     * Creates a variable for each field of the solve set, and asserts
+     * all of its constraints. Returns false if any constraint uses a
+     * construct that can't be lowered. Such constraints are not asserted
+     */
+    static bool lower(
+        dmgr::IDebugMgr                         *dmgr,
+        struct Btor                             *btor,
+        SolverBoolectorSortCache                *sorts,
+        SolverBoolectorConstFactory             *const_f,
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset,
+        RefPathPtrMap<struct BoolectorNode>     &field_m);
+
+private:
+    static dmgr::IDebug                     *m_dbg;
+    dmgr::IDebugMgr                         *m_dmgr;
+    std::mutex                              m_mutex;
+    struct Btor                             *m_btor;
+    SolverBoolectorSortCache                m_sorts;
+    SolverBoolectorConstFactory             m_const_f;
+    RefPathPtrMap<struct BoolectorNode>     m_field_m;
+    bool                                    m_built;
+    bool                                    m_lowered;
+
+};
+
+}
+}
+
+
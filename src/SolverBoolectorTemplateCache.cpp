@@ -0,0 +1,158 @@
+/*
+ * SolverBoolectorTemplateCache.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <algorithm>
+#include <iterator>
+#include "dmgr/impl/DebugMacros.h"
+#include "SolverBoolectorTemplateCache.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+SolverBoolectorTemplateCache::SolverBoolectorTemplateCache(
+    dmgr::IDebugMgr                         *dmgr,
+    uint32_t                                max_size) : m_dmgr(dmgr),
+        m_max_size(max_size), m_hits(0), m_misses(0), m_evictions(0) {
+    DEBUG_INIT("vsc::solvers::SolverBoolectorTemplateCache", dmgr);
+}
+
+SolverBoolectorTemplateCache::~SolverBoolectorTemplateCache() {
+
+}
+
+SolverBoolectorTemplateSP SolverBoolectorTemplateCache::getTemplate(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) {
+    DEBUG_ENTER("getTemplate");
+    Key key;
+    key.type = root_field->getDataType();
+
+    // Fields and constraints are each terminated by -1. Path
+    // elements are never negative, so the encoding is unambiguous
+    for (RefPathMap<SolveSetFieldType>::iterator
+        it=solveset->getFields().begin(); it.next(); ) {
+        appendPath(key.sig, it.path());
+    }
+    key.sig.push_back(-1);
+    for (RefPathSet::iterator
+        it=solveset->getConstraints().begin(); it.next(); ) {
+        appendPath(key.sig, it.path());
+    }
+    key.sig.push_back(-1);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<Key, EntryL::iterator>::const_iterator it = 
+        m_template_m.find(key);
+    EntryL::iterator entry_it;
+    bool hit = (it != m_template_m.end());
+
+    if (hit) {
+        m_hits++;
+        entry_it = it->second;
+        if (entry_it != m_lru.begin()) {
+            m_lru.splice(m_lru.begin(), m_lru, entry_it);
+        }
+    } else {
+        // The formula is lowered by the first clone, outside this lock
+        m_misses++;
+        m_lru.push_front(Entry());
+        entry_it = m_lru.begin();
+        entry_it->key = key;
+        entry_it->tmpl = SolverBoolectorTemplateSP(
+            new SolverBoolectorTemplate(m_dmgr));
+        m_template_m.insert({key, entry_it});
+    }
+
+    // A solve set deleted without being released may leave a stale
+    // association, which is replaced if its address is reused
+    std::unordered_map<ISolveSet *, EntryL::iterator>::iterator ss_it =
+        m_solveset_m.find(solveset);
+    if (ss_it == m_solveset_m.end()) {
+        entry_it->solvesets.push_back(solveset);
+        m_solveset_m.insert({solveset, entry_it});
+    } else if (ss_it->second != entry_it) {
+        std::vector<ISolveSet *> &prev = ss_it->second->solvesets;
+        prev.erase(std::find(prev.begin(), prev.end(), solveset));
+        entry_it->solvesets.push_back(solveset);
+        ss_it->second = entry_it;
+    }
+
+    SolverBoolectorTemplateSP ret = entry_it->tmpl;
+    evict();
+
+    DEBUG_LEAVE("getTemplate -- %s", (hit)?"hit":"miss");
+    return ret;
+}
+
+void SolverBoolectorTemplateCache::release(ISolveSet *solveset) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unordered_map<ISolveSet *, EntryL::iterator>::const_iterator it =
+        m_solveset_m.find(solveset);
+
+    if (it != m_solveset_m.end()) {
+        DEBUG("Dropping template for solve-set %p", solveset);
+        drop(it->second);
+    }
+}
+
+void SolverBoolectorTemplateCache::setMaxSize(uint32_t max_size) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_max_size = max_size;
+    evict();
+}
+
+uint32_t SolverBoolectorTemplateCache::size() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lru.size();
+}
+
+void SolverBoolectorTemplateCache::drop(EntryL::iterator it) {
+    for (std::vector<ISolveSet *>::const_iterator
+        ss_it=it->solvesets.begin();
+        ss_it!=it->solvesets.end(); ss_it++) {
+        m_solveset_m.erase(*ss_it);
+    }
+    m_template_m.erase(it->key);
+    m_lru.erase(it);
+}
+
+void SolverBoolectorTemplateCache::evict() {
+    // Always retain the most-recently-used entry, which was just
+    // requested by the caller
+    while (m_lru.size() > 1 && m_lru.size() > m_max_size) {
+        drop(std::prev(m_lru.end()));
+        m_evictions++;
+    }
+}
+
+void SolverBoolectorTemplateCache::appendPath(
+        std::vector<int32_t>        &sig,
+        const std::vector<int32_t>  &path) {
+    sig.push_back(path.size());
+    sig.insert(sig.end(), path.begin(), path.end());
+}
+
+dmgr::IDebug *SolverBoolectorTemplateCache::m_dbg = 0;
+
+}
+}
+
@@ -0,0 +1,128 @@
+/**
+ * SolverBoolectorTemplateCache.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "dmgr/IDebugMgr.h"
+#include "vsc/dm/IModelField.h"
+#include "vsc/solvers/ISolveSet.h"
+#include "SolverBoolectorTemplate.h"
+
+namespace vsc {
+namespace solvers {
+
+
+
+/**
+ * Compiled formulas keyed on the root datatype and the field and
+ * constraint paths of a solve set. Solve sets are owned by the plan
+ * cache of each compound solver, so equivalent solve sets from 
+ * different compound solvers share a template.
+ *
+ * The cache is bounded with the same LRU policy as the plan cache.
+ * A template is also dropped when any solve set that uses it is 
+ * released, since the datatype it is keyed on may not outlive the 
+ * plan. Templates are returned by shared pointer, such that one being
+ * cloned stays alive if it is dropped concurrently.
+ */
+class SolverBoolectorTemplateCache {
+public:
+    static const uint32_t DefaultMaxSize = 256;
+
+    SolverBoolectorTemplateCache(
+        dmgr::IDebugMgr                         *dmgr,
+        uint32_t                                max_size=DefaultMaxSize);
+
+    virtual ~SolverBoolectorTemplateCache();
+
+    SolverBoolectorTemplateSP getTemplate(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset);
+
+    /**
+     * Drops the template used by 'solveset', if any. Must be called 
+     * before a solve set is deleted
+     */
+    void release(ISolveSet *solveset);
+
+    void setMaxSize(uint32_t max_size);
+
+    uint32_t getMaxSize() const { return m_max_size; }
+
+    uint32_t size();
+
+    uint64_t getNumHits() const { return m_hits; }
+
+    uint64_t getNumMisses() const { return m_misses; }
+
+    uint64_t getNumEvictions() const { return m_evictions; }
+
+private:
+    struct Key {
+        dm::IDataType               *type;
+        std::vector<int32_t>        sig;
+
+        bool operator < (const Key &rhs) const {
+            if (type != rhs.type) {
+                return type < rhs.type;
+            }
+            return sig < rhs.sig;
+        }
+    };
+
+    struct Entry {
+        Key                         key;
+        SolverBoolectorTemplateSP   tmpl;
+        // Solve sets that have requested this template
+        std::vector<ISolveSet *>    solvesets;
+    };
+    using EntryL=std::list<Entry>;
+
+    static void appendPath(
+        std::vector<int32_t>        &sig,
+        const std::vector<int32_t>  &path);
+
+    void drop(EntryL::iterator it);
+
+    void evict();
+
+private:
+    static dmgr::IDebug                                 *m_dbg;
+    dmgr::IDebugMgr                                     *m_dmgr;
+    std::mutex                                          m_mutex;
+    uint32_t                                            m_max_size;
+    // Entries in most-recently-used order
+    EntryL                                              m_lru;
+    std::map<Key, EntryL::iterator>                     m_template_m;
+    std::unordered_map<ISolveSet *, EntryL::iterator>   m_solveset_m;
+    uint64_t                                            m_hits;
+    uint64_t                                            m_misses;
+    uint64_t                                            m_evictions;
+
+};
+
+}
+}
+
+
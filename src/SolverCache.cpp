@@ -0,0 +1,130 @@
+/*
+ * SolverCache.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "dmgr/impl/DebugMacros.h"
+#include "SolverCache.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+SolverCache::SolverCache(
+    dmgr::IDebugMgr         *dmgr,
+    ISolverFactory          *solver_f,
+    uint32_t                max_size) : m_solver_f(solver_f),
+        m_max_size(max_size), m_pool_size(0), m_hits(0), m_misses(0), m_evictions(0),
+        m_stats(0) {
+    DEBUG_INIT("vsc::solvers::SolverCache", dmgr);
+}
+
+SolverCache::~SolverCache() {
+
+}
+
+ISolver *SolverCache::getSolver(ISolveSet *solveset) {
+    std::unordered_map<ISolveSet *, EntryL::iterator>::const_iterator it =
+        m_solver_m.find(solveset);
+
+    if (it != m_solver_m.end()) {
+        m_hits++;
+        if (m_stats) {
+            m_stats->inc(SolverStatsCounter::SolverHit);
+        }
+        // Move to the most-recently-used position
+        if (it->second != m_lru.begin()) {
+            m_lru.splice(m_lru.begin(), m_lru, it->second);
+        }
+        return m_lru.front().second.get();
+    }
+
+    m_misses++;
+    ISolver *solver = m_solver_f->mkSolver(solveset);
+    if (m_stats) {
+        m_stats->inc(SolverStatsCounter::SolverMiss);
+        solver->setStats(m_stats);
+    }
+    if (m_pool_size) {
+        solver->setPoolSize(m_pool_size);
+    }
+    if (m_budget.limited()) {
+        solver->setBudget(m_budget);
+    }
+    m_lru.push_front(Entry(solveset, ISolverUP(solver)));
+    m_solver_m.insert({solveset, m_lru.begin()});
+
+    evict();
+
+    return solver;
+}
+
+void SolverCache::remove(ISolveSet *solveset) {
+    std::unordered_map<ISolveSet *, EntryL::iterator>::iterator it =
+        m_solver_m.find(solveset);
+
+    if (it != m_solver_m.end()) {
+        m_lru.erase(it->second);
+        m_solver_m.erase(it);
+    }
+}
+
+void SolverCache::setMaxSize(uint32_t max_size) {
+    m_max_size = max_size;
+    evict();
+}
+
+void SolverCache::setPoolSize(uint32_t size) {
+    m_pool_size = size;
+    for (EntryL::const_iterator
+        it=m_lru.begin();
+        it!=m_lru.end(); it++) {
+        it->second->setPoolSize(size);
+    }
+}
+
+void SolverCache::setBudget(const SolverBudget &budget) {
+    m_budget = budget;
+    for (EntryL::const_iterator
+        it=m_lru.begin();
+        it!=m_lru.end(); it++) {
+        it->second->setBudget(budget);
+    }
+}
+
+void SolverCache::clear() {
+    m_solver_m.clear();
+    m_lru.clear();
+}
+
+void SolverCache::evict() {
+    // Always retain the most-recently-used entry, since the 
+    // caller holds a reference to it
+    while (m_lru.size() > 1 && m_lru.size() > m_max_size) {
+        DEBUG("Evicting solver for solve-set %p", m_lru.back().first);
+        m_solver_m.erase(m_lru.back().first);
+        m_lru.pop_back();
+        m_evictions++;
+    }
+}
+
+dmgr::IDebug *SolverCache::m_dbg = 0;
+
+}
+}
@@ -0,0 +1,112 @@
+/**
+ * SolverCache.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <list>
+#include <unordered_map>
+#include "dmgr/IDebugMgr.h"
+#include "vsc/solvers/ISolver.h"
+#include "vsc/solvers/ISolverFactory.h"
+#include "vsc/solvers/SolverStats.h"
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * Bounded LRU cache of backend solver instances, keyed by solve set.
+ * Solve sets are owned by cached plans, so their addresses are stable
+ * until the plan is evicted from the plan cache, which removes the
+ * corresponding solvers. Keeping a solver alive allows it to re-solve
+ * incrementally on subsequent randomize calls.
+ */
+class SolverCache {
+public:
+    SolverCache(
+        dmgr::IDebugMgr         *dmgr,
+        ISolverFactory          *solver_f,
+        uint32_t                max_size=256);
+
+    virtual ~SolverCache();
+
+    ISolver *getSolver(ISolveSet *solveset);
+
+    /**
+     * Releases the solver for 'solveset', if one is cached. Must be
+     * called before a solve set is deleted, since a later solve set
+     * may be allocated at the same address
+     */
+    void remove(ISolveSet *solveset);
+
+    void setMaxSize(uint32_t max_size);
+
+    uint32_t getMaxSize() const { return m_max_size; }
+
+    /**
+     * Sets the solution-pool size of cached and future solvers
+     */
+    void setPoolSize(uint32_t size);
+
+    uint32_t getPoolSize() const { return m_pool_size; }
+
+    /**
+     * Sets the time budget of cached and future solvers
+     */
+    void setBudget(const SolverBudget &budget);
+
+    const SolverBudget &getBudget() const { return m_budget; }
+
+    uint32_t size() const { return m_solver_m.size(); }
+
+    uint64_t getNumHits() const { return m_hits; }
+
+    uint64_t getNumMisses() const { return m_misses; }
+
+    uint64_t getNumEvictions() const { return m_evictions; }
+
+    void clear();
+
+    void setStats(SolverStats *stats) { m_stats = stats; }
+
+private:
+    using Entry=std::pair<ISolveSet *, ISolverUP>;
+    using EntryL=std::list<Entry>;
+
+    void evict();
+
+private:
+    static dmgr::IDebug                                 *m_dbg;
+    ISolverFactory                                      *m_solver_f;
+    uint32_t                                            m_max_size;
+    uint32_t                                            m_pool_size;
+    SolverBudget                                        m_budget;
+    EntryL                                              m_lru;
+    std::unordered_map<ISolveSet *, EntryL::iterator>   m_solver_m;
+    uint64_t                                            m_hits;
+    uint64_t                                            m_misses;
+    uint64_t                                            m_evictions;
+    SolverStats                                         *m_stats;
+
+};
+
+}
+}
+
+
@@ -26,8 +26,12 @@ namespace vsc {
 namespace solvers {
 
 
-SolverFactoryBoolector::SolverFactoryBoolector(dmgr::IDebugMgr *dmgr) :
-    m_dmgr(dmgr) {
+SolverFactoryBoolector::SolverFactoryBoolector(
+    dmgr::IDebugMgr                 *dmgr,
+    uint32_t                        swizzle_calls,
+    uint32_t                        swizzle_bits) :
+        m_dmgr(dmgr), m_swizzle_calls(swizzle_calls), 
+        m_swizzle_bits(swizzle_bits), m_templates(dmgr) {
 
 }
 
@@ -36,7 +40,15 @@ SolverFactoryBoolector::~SolverFactoryBoolector() {
 }
 
 ISolver *SolverFactoryBoolector::mkSolver(ISolveSet *solve_set) {
-    return new SolverBoolector(m_dmgr);
+    return new SolverBoolector(
+        m_dmgr, 
+        m_swizzle_calls, 
+        m_swizzle_bits, 
+        &m_templates);
+}
+
+void SolverFactoryBoolector::releaseSolveSet(ISolveSet *solve_set) {
+    m_templates.release(solve_set);
 }
 
 }
@@ -21,22 +21,38 @@
 #pragma once
 #include "dmgr/IDebugMgr.h"
 #include "vsc/solvers/ISolverFactory.h"
+#include "SolverBoolector.h"
+#include "SolverBoolectorTemplateCache.h"
 
 namespace vsc {
 namespace solvers {
 
 
 
+/**
+ * Creates Boolector solvers. Solvers share the factory's compiled
+ * formulas, such that each distinct solve set is only lowered once.
+ */
 class SolverFactoryBoolector : public virtual ISolverFactory {
 public:
-    SolverFactoryBoolector(dmgr::IDebugMgr *dmgr);
+    SolverFactoryBoolector(
+        dmgr::IDebugMgr                 *dmgr,
+        uint32_t                        swizzle_calls=SolverBoolector::DefaultSwizzleCalls,
+        uint32_t                        swizzle_bits=SolverBoolector::DefaultSwizzleBits);
 
     virtual ~SolverFactoryBoolector();
 
     virtual ISolver *mkSolver(ISolveSet *solve_set) override;
 
+    virtual void releaseSolveSet(ISolveSet *solve_set) override;
+
+    SolverBoolectorTemplateCache &getTemplates() { return m_templates; }
+
 private:
     dmgr::IDebugMgr                 *m_dmgr;
+    uint32_t                        m_swizzle_calls;
+    uint32_t                        m_swizzle_bits;
+    SolverBoolectorTemplateCache    m_templates;
 
 };
 
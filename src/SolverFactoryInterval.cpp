@@ -0,0 +1,49 @@
+/*
+ * SolverFactoryInterval.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "SolverFactoryInterval.h"
+#include "SolverIntervalSampler.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+SolverFactoryInterval::SolverFactoryInterval(
+    dmgr::IDebugMgr                 *dmgr,
+    ISolverFactory                  *fallback_f) :
+        m_dmgr(dmgr), m_fallback_f(fallback_f) {
+
+}
+
+SolverFactoryInterval::~SolverFactoryInterval() {
+
+}
+
+ISolver *SolverFactoryInterval::mkSolver(ISolveSet *solve_set) {
+    return new SolverIntervalSampler(m_dmgr, m_fallback_f.get());
+}
+
+void SolverFactoryInterval::releaseSolveSet(ISolveSet *solve_set) {
+    m_fallback_f->releaseSolveSet(solve_set);
+}
+
+}
+}
@@ -0,0 +1,66 @@
+/*
+ * SolverFactoryPortfolio.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "SolverFactoryPortfolio.h"
+#include "SolverPortfolio.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+SolverFactoryPortfolio::SolverFactoryPortfolio(dmgr::IDebugMgr *dmgr) :
+    m_dmgr(dmgr) {
+
+}
+
+SolverFactoryPortfolio::~SolverFactoryPortfolio() {
+
+}
+
+void SolverFactoryPortfolio::addBackend(ISolverFactory *backend_f) {
+    m_backend_l.push_back(ISolverFactoryUP(backend_f));
+}
+
+ISolver *SolverFactoryPortfolio::mkSolver(ISolveSet *solve_set) {
+    if (m_backend_l.size() == 1) {
+        // Nothing to race
+        return m_backend_l.at(0)->mkSolver(solve_set);
+    }
+
+    SolverPortfolio *solver = new SolverPortfolio(m_dmgr);
+    for (std::vector<ISolverFactoryUP>::const_iterator
+        it=m_backend_l.begin();
+        it!=m_backend_l.end(); it++) {
+        solver->addSolver((*it)->mkSolver(solve_set));
+    }
+    return solver;
+}
+
+void SolverFactoryPortfolio::releaseSolveSet(ISolveSet *solve_set) {
+    for (std::vector<ISolverFactoryUP>::const_iterator
+        it=m_backend_l.begin();
+        it!=m_backend_l.end(); it++) {
+        (*it)->releaseSolveSet(solve_set);
+    }
+}
+
+}
+}
@@ -0,0 +1,58 @@
+/**
+ * SolverFactoryPortfolio.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <vector>
+#include "dmgr/IDebugMgr.h"
+#include "vsc/solvers/ISolverFactory.h"
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * Creates portfolio solvers that race one solver from each backend
+ * factory on a solve set. Backend solvers must support racing.
+ */
+class SolverFactoryPortfolio : public virtual ISolverFactory {
+public:
+    SolverFactoryPortfolio(dmgr::IDebugMgr *dmgr);
+
+    virtual ~SolverFactoryPortfolio();
+
+    /**
+     * Adds a backend. The portfolio takes ownership of the factory
+     */
+    void addBackend(ISolverFactory *backend_f);
+
+    virtual ISolver *mkSolver(ISolveSet *solve_set) override;
+
+    virtual void releaseSolveSet(ISolveSet *solve_set) override;
+
+private:
+    dmgr::IDebugMgr                     *m_dmgr;
+    std::vector<ISolverFactoryUP>       m_backend_l;
+
+};
+
+}
+}
+
+
@@ -0,0 +1,75 @@
+/*
+ * SolverFactoryStrategy.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "dmgr/impl/DebugMacros.h"
+#include "SolverFactoryStrategy.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+SolverFactoryStrategy::SolverFactoryStrategy(
+    dmgr::IDebugMgr                 *dmgr,
+    ISolverFactory                  *default_f) :
+        m_dmgr(dmgr), m_default_f(default_f) {
+    DEBUG_INIT("vsc::solvers::SolverFactoryStrategy", dmgr);
+}
+
+SolverFactoryStrategy::~SolverFactoryStrategy() {
+
+}
+
+void SolverFactoryStrategy::addStrategy(
+        SolveSetFlags                   match,
+        ISolverFactory                  *solver_f) {
+    m_strategy_l.push_back({match, ISolverFactoryUP(solver_f)});
+}
+
+ISolver *SolverFactoryStrategy::mkSolver(ISolveSet *solve_set) {
+    SolveSetFlags flags = solve_set->getFlags();
+
+    for (std::vector<std::pair<SolveSetFlags, ISolverFactoryUP>>::const_iterator
+        it=m_strategy_l.begin();
+        it!=m_strategy_l.end(); it++) {
+        if ((flags & it->first) == it->first) {
+            DEBUG("Solve set with flags 0x%08x matches strategy %d",
+                static_cast<uint32_t>(flags), it-m_strategy_l.begin());
+            return it->second->mkSolver(solve_set);
+        }
+    }
+
+    return m_default_f->mkSolver(solve_set);
+}
+
+void SolverFactoryStrategy::releaseSolveSet(ISolveSet *solve_set) {
+    // The solve set may have been handled by any of the factories
+    m_default_f->releaseSolveSet(solve_set);
+    for (std::vector<std::pair<SolveSetFlags, ISolverFactoryUP>>::const_iterator
+        it=m_strategy_l.begin();
+        it!=m_strategy_l.end(); it++) {
+        it->second->releaseSolveSet(solve_set);
+    }
+}
+
+dmgr::IDebug *SolverFactoryStrategy::m_dbg = 0;
+
+}
+}
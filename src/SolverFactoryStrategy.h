@@ -0,0 +1,66 @@
+/**
+ * SolverFactoryStrategy.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <utility>
+#include <vector>
+#include "dmgr/IDebugMgr.h"
+#include "vsc/solvers/ISolverFactory.h"
+
+namespace vsc {
+namespace solvers {
+
+/**
+ * Selects the engine for each solve set based on its flags. Strategies
+ * are checked in the order they were added, and the first whose flags
+ * are all set on the solve set creates the solver. Solve sets that 
+ * match no strategy are handled by the default factory.
+ */
+class SolverFactoryStrategy : public virtual ISolverFactory {
+public:
+    SolverFactoryStrategy(
+        dmgr::IDebugMgr                 *dmgr,
+        ISolverFactory                  *default_f);
+
+    virtual ~SolverFactoryStrategy();
+
+    /**
+     * Adds a strategy. The strategy takes ownership of the factory
+     */
+    void addStrategy(
+        SolveSetFlags                   match,
+        ISolverFactory                  *solver_f);
+
+    virtual ISolver *mkSolver(ISolveSet *solve_set) override;
+
+    virtual void releaseSolveSet(ISolveSet *solve_set) override;
+
+private:
+    static dmgr::IDebug                                     *m_dbg;
+    dmgr::IDebugMgr                                         *m_dmgr;
+    ISolverFactoryUP                                        m_default_f;
+    std::vector<std::pair<SolveSetFlags, ISolverFactoryUP>> m_strategy_l;
+
+};
+
+}
+}
+
+
@@ -0,0 +1,139 @@
+/*
+ * SolverIntervalSampler.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "dmgr/impl/DebugMacros.h"
+#include "vsc/dm/impl/ValRefBool.h"
+#include "vsc/dm/impl/ValRefInt.h"
+#include "vsc/solvers/impl/TaskPath2ValRef.h"
+#include "SolverIntervalSampler.h"
+#include "TaskBuildIntervalDomain.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+SolverIntervalSampler::SolverIntervalSampler(
+    dmgr::IDebugMgr                         *dmgr,
+    ISolverFactory                          *fallback_f) : 
+        m_dmgr(dmgr), m_fallback_f(fallback_f), m_stats(0),
+        m_analyzed(false), m_signed(false), m_kind(ValKind::Int) {
+    DEBUG_INIT("vsc::solvers::SolverIntervalSampler", dmgr);
+}
+
+SolverIntervalSampler::~SolverIntervalSampler() {
+
+}
+
+SolverResult SolverIntervalSampler::randomize(
+        IRandState                              *randstate,
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) {
+    DEBUG_ENTER("randomize");
+    if (!m_analyzed) {
+        analyze(root_field, solveset);
+    }
+
+    if (m_fallback) {
+        DEBUG_LEAVE("randomize -- fallback");
+        return m_fallback->randomize(randstate, root_field, solveset);
+    }
+
+    if (m_domain.empty()) {
+        DEBUG_LEAVE("randomize -- empty domain");
+        return SolverResult::Unsat;
+    }
+
+    uint64_t val = m_domain.sample(randstate);
+    if (m_signed) {
+        val ^= (uint64_t(1) << 63);
+    }
+
+    if (m_kind == ValKind::Bool) {
+        dm::ValRefBool val_b(TaskPath2ValRef(root_field).toMutVal(m_field_path));
+        val_b.set_val(val != 0);
+    } else {
+        dm::ValRefInt val_i(TaskPath2ValRef(root_field).toMutVal(m_field_path));
+        val_i.set_val(val);
+    }
+
+    DEBUG_LEAVE("randomize");
+    return SolverResult::Sat;
+}
+
+SolverResult SolverIntervalSampler::sat(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) {
+    if (!m_analyzed) {
+        analyze(root_field, solveset);
+    }
+
+    if (m_fallback) {
+        return m_fallback->sat(root_field, solveset);
+    }
+
+    return (m_domain.empty())?SolverResult::Unsat:SolverResult::Sat;
+}
+
+void SolverIntervalSampler::setStats(SolverStats *stats) {
+    m_stats = stats;
+    if (m_fallback) {
+        m_fallback->setStats(stats);
+    }
+}
+
+void SolverIntervalSampler::setBudget(const SolverBudget &budget) {
+    // Sampling is bounded, so only the fallback is budgeted
+    m_budget = budget;
+    if (m_fallback) {
+        m_fallback->setBudget(budget);
+    }
+}
+
+void SolverIntervalSampler::analyze(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) {
+    DEBUG_ENTER("analyze");
+    SolverStatsTimer timer((m_stats)?
+        &m_stats->getPhase(SolverStatsPhase::Build):0);
+    m_analyzed = true;
+
+    if (TaskBuildIntervalDomain(m_dmgr, root_field).build(
+            solveset, m_domain, m_signed)) {
+        RefPathMap<SolveSetFieldType>::iterator it = solveset->getFields().begin();
+        it.next();
+        m_field_path = it.path();
+        m_kind = TaskPath2ValKind(root_field).toKind(m_field_path);
+        DEBUG("Sampling from %d intervals", m_domain.getIntervals().size());
+    } else {
+        DEBUG("Constraints don't reduce to intervals");
+        m_fallback = ISolverUP(m_fallback_f->mkSolver(solveset));
+        m_fallback->setStats(m_stats);
+        if (m_budget.limited()) {
+            m_fallback->setBudget(m_budget);
+        }
+    }
+    DEBUG_LEAVE("analyze");
+}
+
+dmgr::IDebug *SolverIntervalSampler::m_dbg = 0;
+
+}
+}
@@ -0,0 +1,88 @@
+/**
+ * SolverIntervalSampler.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include "dmgr/IDebugMgr.h"
+#include "vsc/solvers/ISolver.h"
+#include "vsc/solvers/ISolverFactory.h"
+#include "vsc/solvers/impl/TaskPath2ValKind.h"
+#include "IntervalSet.h"
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * Solves single-field solve sets whose constraints reduce to a set
+ * of intervals by sampling uniformly from the intervals, without 
+ * involving an SMT backend. Solve sets that don't reduce are handed
+ * to a solver from the fallback factory on first use.
+ */
+class SolverIntervalSampler : public virtual ISolver {
+public:
+    SolverIntervalSampler(
+        dmgr::IDebugMgr                         *dmgr,
+        ISolverFactory                          *fallback_f);
+
+    virtual ~SolverIntervalSampler();
+
+    virtual SolverResult randomize(
+        IRandState                              *randstate,
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) override;
+
+    virtual SolverResult sat(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) override;
+
+    virtual void setStats(SolverStats *stats) override;
+
+    virtual void setBudget(const SolverBudget &budget) override;
+
+    /**
+     * Returns whether the solve set was reduced to intervals.
+     * Only valid after the first randomize or sat call
+     */
+    bool isSampled() const { return m_analyzed && !m_fallback; }
+
+private:
+    void analyze(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset);
+
+private:
+    static dmgr::IDebug                     *m_dbg;
+    dmgr::IDebugMgr                         *m_dmgr;
+    ISolverFactory                          *m_fallback_f;
+    ISolverUP                               m_fallback;
+    SolverStats                             *m_stats;
+    SolverBudget                            m_budget;
+    bool                                    m_analyzed;
+    IntervalSet                             m_domain;
+    bool                                    m_signed;
+    ValKind                                 m_kind;
+    std::vector<int32_t>                    m_field_path;
+
+};
+
+}
+}
+
+
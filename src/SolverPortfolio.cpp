@@ -0,0 +1,169 @@
+/*
+ * SolverPortfolio.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <thread>
+#include "dmgr/impl/DebugMacros.h"
+#include "SolverPortfolio.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+SolverPortfolio::SolverPortfolio(dmgr::IDebugMgr *dmgr) :
+    m_dmgr(dmgr), m_winner(-1) {
+    DEBUG_INIT("vsc::solvers::SolverPortfolio", dmgr);
+}
+
+SolverPortfolio::~SolverPortfolio() {
+
+}
+
+void SolverPortfolio::addSolver(ISolver *solver) {
+    m_solver_l.push_back(ISolverUP(solver));
+}
+
+SolverResult SolverPortfolio::randomize(
+        IRandState                              *randstate,
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) {
+    if (m_winner != -1) {
+        return m_solver_l.at(m_winner)->randomize(
+            randstate, 
+            root_field, 
+            solveset);
+    }
+
+    DEBUG_ENTER("randomize -- race %d solvers", m_solver_l.size());
+
+    // Racers can't share a random state, so each draws from 
+    // its own fork
+    std::vector<IRandStateUP> randstate_l;
+    for (uint32_t i=0; i<m_solver_l.size(); i++) {
+        randstate_l.push_back(IRandStateUP(randstate->fork()));
+    }
+
+    SolverResult ret = race([&](int32_t i) {
+        return m_solver_l.at(i)->randomize(
+            randstate_l.at(i).get(),
+            root_field,
+            solveset);
+    });
+
+    DEBUG_LEAVE("randomize -- winner %d", m_winner);
+    return ret;
+}
+
+SolverResult SolverPortfolio::sat(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) {
+    if (m_winner != -1) {
+        return m_solver_l.at(m_winner)->sat(root_field, solveset);
+    }
+
+    DEBUG_ENTER("sat -- race %d solvers", m_solver_l.size());
+    SolverResult ret = race([&](int32_t i) {
+        return m_solver_l.at(i)->sat(root_field, solveset);
+    });
+    DEBUG_LEAVE("sat -- winner %d", m_winner);
+    return ret;
+}
+
+void SolverPortfolio::setStats(SolverStats *stats) {
+    for (std::vector<ISolverUP>::const_iterator
+        it=m_solver_l.begin();
+        it!=m_solver_l.end(); it++) {
+        if (*it) {
+            (*it)->setStats(stats);
+        }
+    }
+}
+
+void SolverPortfolio::setBudget(const SolverBudget &budget) {
+    for (std::vector<ISolverUP>::const_iterator
+        it=m_solver_l.begin();
+        it!=m_solver_l.end(); it++) {
+        if (*it) {
+            (*it)->setBudget(budget);
+        }
+    }
+}
+
+void SolverPortfolio::setPoolSize(uint32_t size) {
+    for (std::vector<ISolverUP>::const_iterator
+        it=m_solver_l.begin();
+        it!=m_solver_l.end(); it++) {
+        if (*it) {
+            (*it)->setPoolSize(size);
+        }
+    }
+}
+
+SolverResult SolverPortfolio::race(const std::function<SolverResult (int32_t)> &f) {
+    SolverRace race;
+    std::vector<SolverResult> result_l(m_solver_l.size(), SolverResult::Timeout);
+    std::vector<std::thread> thread_l;
+
+    for (uint32_t i=0; i<m_solver_l.size(); i++) {
+        m_solver_l.at(i)->setRace(&race, i);
+    }
+
+    // Racers only read fixed-field values, and only the winner
+    // writes target-field values, so they can share the root field.
+    // The first racer runs on the calling thread
+    for (uint32_t i=1; i<m_solver_l.size(); i++) {
+        thread_l.push_back(std::thread([&f,&result_l,i]() {
+            result_l.at(i) = f(i);
+        }));
+    }
+    result_l.at(0) = f(0);
+
+    for (std::vector<std::thread>::iterator
+        it=thread_l.begin();
+        it!=thread_l.end(); it++) {
+        it->join();
+    }
+
+    // A racer only returns without claiming when another racer 
+    // claimed first, or when it exceeded its budget
+    if (race.getWinner() == -1) {
+        for (uint32_t i=0; i<m_solver_l.size(); i++) {
+            m_solver_l.at(i)->setRace(0, -1);
+        }
+        return SolverResult::Timeout;
+    }
+    m_winner = race.getWinner();
+
+    // Later calls only use the winner, so the losers are released
+    for (uint32_t i=0; i<m_solver_l.size(); i++) {
+        if (i == static_cast<uint32_t>(m_winner)) {
+            m_solver_l.at(i)->setRace(0, -1);
+        } else {
+            m_solver_l.at(i).reset();
+        }
+    }
+
+    return result_l.at(m_winner);
+}
+
+dmgr::IDebug *SolverPortfolio::m_dbg = 0;
+
+}
+}
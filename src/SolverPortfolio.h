@@ -0,0 +1,86 @@
+/**
+ * SolverPortfolio.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <functional>
+#include <vector>
+#include "dmgr/IDebugMgr.h"
+#include "vsc/solvers/ISolver.h"
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * Races several backend solvers on the same solve set. Until a winner
+ * is known, each call runs all backends on separate threads. The first
+ * backend to reach a SAT/UNSAT answer writes the result and wins; the 
+ * others are cancelled through their termination callbacks. The winner
+ * is remembered, and later calls only use it. If all backends exceed
+ * their budget, there is no winner, and the next call races again. Solvers are cached per
+ * solve set, so the winner is effectively remembered per plan.
+ */
+class SolverPortfolio : public virtual ISolver {
+public:
+    SolverPortfolio(dmgr::IDebugMgr *dmgr);
+
+    virtual ~SolverPortfolio();
+
+    /**
+     * Adds a racer. The portfolio takes ownership of the solver
+     */
+    void addSolver(ISolver *solver);
+
+    virtual SolverResult randomize(
+        IRandState                              *randstate,
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) override;
+
+    virtual SolverResult sat(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) override;
+
+    virtual void setStats(SolverStats *stats) override;
+
+    virtual void setPoolSize(uint32_t size) override;
+
+    virtual void setBudget(const SolverBudget &budget) override;
+
+    /**
+     * Returns the index of the winning solver, or -1 if 
+     * no race has been run yet
+     */
+    int32_t getWinner() const { return m_winner; }
+
+private:
+    SolverResult race(const std::function<SolverResult (int32_t)> &f);
+
+private:
+    static dmgr::IDebug                 *m_dbg;
+    dmgr::IDebugMgr                     *m_dmgr;
+    std::vector<ISolverUP>              m_solver_l;
+    int32_t                             m_winner;
+
+};
+
+}
+}
+
+
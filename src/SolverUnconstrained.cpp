@@ -45,17 +45,17 @@ bool SolverUnconstrained::randomize(
         const RefPathSet                        &target_fields) {
     DEBUG_ENTER("randomize");
     m_randstate = randstate;
-    for (RefPathSet::iterator it=target_fields.begin(); it.next(); ) {
-        DEBUG("path.size=%d", it.path().size());
-        m_it = it.path().begin();
-        m_it_end = it.path().end();
+    target_fields.forEach([this,root_field](const int32_t *path, uint32_t depth) {
+        DEBUG("path.size=%d", depth);
+        m_it = path;
+        m_it_end = path+depth;
         dm::IDataType *field_t = root_field->getDataType();
         m_val = root_field->getMutVal();
 
         DEBUG("--> randomize field");
         field_t->accept(m_this);
         DEBUG("<-- randomize field");
-    }
+    });
     DEBUG_LEAVE("randomize");
 
     return true;
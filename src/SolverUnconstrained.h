@@ -51,8 +51,8 @@ public:
 private:
     static dmgr::IDebug                         *m_dbg;
     IRandState                                  *m_randstate;
-    std::vector<int32_t>::const_iterator        m_it;
-    std::vector<int32_t>::const_iterator        m_it_end;
+    const int32_t                               *m_it;
+    const int32_t                               *m_it_end;
     dm::ValRef                                  m_val;
 
 };
@@ -0,0 +1,401 @@
+/*
+ * TaskBuildIntervalDomain.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "dmgr/impl/DebugMacros.h"
+#include "vsc/dm/ITypeExprRange.h"
+#include "vsc/dm/ITypeExprRangelist.h"
+#include "vsc/dm/ITypeExprVal.h"
+#include "vsc/dm/impl/ValRefBool.h"
+#include "vsc/dm/impl/ValRefInt.h"
+#include "vsc/solvers/impl/RefPathField.h"
+#include "vsc/solvers/impl/TaskPath2Constraint.h"
+#include "vsc/solvers/impl/TaskPath2Field.h"
+#include "TaskBuildIntervalDomain.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+TaskBuildIntervalDomain::TaskBuildIntervalDomain(
+    dmgr::IDebugMgr                         *dmgr,
+    dm::IModelField                         *root_field) :
+        m_root_field(root_field), m_ok(true), m_in_type(false),
+        m_width(0), m_signed(false), m_kind(Kind::Fail), 
+        m_literal(0), m_literal_signed(false) {
+    DEBUG_INIT("vsc::solvers::TaskBuildIntervalDomain", dmgr);
+}
+
+TaskBuildIntervalDomain::~TaskBuildIntervalDomain() {
+
+}
+
+bool TaskBuildIntervalDomain::build(
+        ISolveSet                               *solveset,
+        IntervalSet                             &domain,
+        bool                                    &is_signed) {
+    DEBUG_ENTER("build");
+
+    // Only a single target field is supported
+    RefPathMap<SolveSetFieldType>::iterator f_it = solveset->getFields().begin();
+    if (solveset->getFields().size() != 1 || !f_it.next() || 
+            f_it.value() != SolveSetFieldType::Target) {
+        DEBUG_LEAVE("build -- not a single target field");
+        return false;
+    }
+    m_field_path = f_it.path();
+
+    // Determine the value range of the field
+    m_ok = false;
+    m_in_type = true;
+    TaskPath2Field(m_root_field).toField(m_field_path)->getDataType()->accept(m_this);
+    m_in_type = false;
+
+    if (!m_ok) {
+        DEBUG_LEAVE("build -- unsupported field type");
+        return false;
+    }
+
+    if (m_signed) {
+        domain = IntervalSet(
+            bias(uint64_t(-1) << (m_width-1), true),
+            bias((uint64_t(1) << (m_width-1)) - 1, true));
+    } else {
+        domain = IntervalSet(0, 
+            (m_width == 64)?UINT64_MAX:((uint64_t(1) << m_width) - 1));
+    }
+
+    for (RefPathSet::iterator 
+        it=solveset->getConstraints().begin(); it.next() && m_ok; ) {
+        const std::vector<int32_t> &path = it.path();
+        int32_t constraint_offset = path.at(0);
+        m_path_prefix.clear();
+        m_path_prefix.insert(
+            m_path_prefix.begin(),
+            path.begin()+1,
+            path.begin()+constraint_offset);
+
+        m_domain = IntervalSet::full();
+        TaskPath2Constraint(m_root_field).toConstraint(path)->accept(m_this);
+
+        if (m_ok) {
+            domain.intersect(m_domain);
+        }
+    }
+
+    is_signed = m_signed;
+
+    DEBUG_LEAVE("build %d", m_ok);
+    return m_ok;
+}
+
+void TaskBuildIntervalDomain::visitDataTypeBool(dm::IDataTypeBool *t) {
+    if (m_in_type) {
+        m_ok = true;
+        m_width = 1;
+        m_signed = false;
+    } else {
+        dm::ValRefBool val(m_val);
+        m_literal = val.get_val()?1:0;
+        m_literal_signed = false;
+    }
+}
+
+void TaskBuildIntervalDomain::visitDataTypeEnum(dm::IDataTypeEnum *t) {
+    m_ok = false;
+}
+
+void TaskBuildIntervalDomain::visitDataTypeInt(dm::IDataTypeInt *t) {
+    if (m_in_type) {
+        m_ok = (t->width() > 0 && t->width() <= 64);
+        m_width = t->width();
+        m_signed = t->isSigned();
+    } else {
+        dm::ValRefInt val(m_val);
+        if (val.bits() > 64) {
+            m_ok = false;
+        } else if (t->isSigned()) {
+            m_literal = static_cast<uint64_t>(val.get_val_s());
+        } else {
+            m_literal = val.get_val_u();
+        }
+        m_literal_signed = t->isSigned();
+    }
+}
+
+void TaskBuildIntervalDomain::visitDataTypeStruct(dm::IDataTypeStruct *t) {
+    m_ok = false;
+}
+
+void TaskBuildIntervalDomain::visitTypeConstraintExpr(dm::ITypeConstraintExpr *c) {
+    DEBUG_ENTER("visitTypeConstraintExpr");
+    m_kind = Kind::Fail;
+    c->expr()->accept(m_this);
+
+    if (m_kind == Kind::Field) {
+        // A bare reference holds when the field is non-zero
+        compare(dm::BinOp::Ne, bias(0, m_signed), m_domain);
+    } else if (m_kind != Kind::Domain) {
+        m_ok = false;
+    }
+    DEBUG_LEAVE("visitTypeConstraintExpr %d", m_ok);
+}
+
+void TaskBuildIntervalDomain::visitTypeConstraintIfElse(dm::ITypeConstraintIfElse *c) {
+    m_ok = false;
+}
+
+void TaskBuildIntervalDomain::visitTypeConstraintImplies(dm::ITypeConstraintImplies *c) {
+    m_ok = false;
+}
+
+void TaskBuildIntervalDomain::visitTypeConstraintScope(dm::ITypeConstraintScope *c) {
+    // All constraints in a scope must hold
+    IntervalSet domain = m_domain;
+    for (std::vector<dm::ITypeConstraintUP>::const_iterator
+        it=c->getConstraints().begin();
+        it!=c->getConstraints().end() && m_ok; it++) {
+        m_domain = IntervalSet::full();
+        (*it)->accept(m_this);
+        domain.intersect(m_domain);
+    }
+    m_domain = domain;
+}
+
+void TaskBuildIntervalDomain::visitTypeConstraintUnique(dm::ITypeConstraintUnique *c) {
+    m_ok = false;
+}
+
+void TaskBuildIntervalDomain::visitTypeExprBin(dm::ITypeExprBin *e) {
+    DEBUG_ENTER("visitTypeExprBin");
+    m_kind = Kind::Fail;
+    e->lhs()->accept(m_this);
+    Kind lhs_k = m_kind;
+    IntervalSet lhs_d = m_domain;
+    uint64_t lhs_v = m_literal;
+    bool lhs_s = m_literal_signed;
+
+    m_kind = Kind::Fail;
+    e->rhs()->accept(m_this);
+    Kind rhs_k = m_kind;
+    IntervalSet rhs_d = m_domain;
+    uint64_t rhs_v = m_literal;
+    bool rhs_s = m_literal_signed;
+
+    m_kind = Kind::Fail;
+    switch (e->op()) {
+        case dm::BinOp::LogAnd:
+        case dm::BinOp::LogOr: {
+            if (lhs_k == Kind::Domain && rhs_k == Kind::Domain) {
+                if (e->op() == dm::BinOp::LogAnd) {
+                    lhs_d.intersect(rhs_d);
+                } else {
+                    lhs_d.unite(rhs_d);
+                }
+                m_domain = lhs_d;
+                m_kind = Kind::Domain;
+            }
+        } break;
+
+        case dm::BinOp::Eq:
+        case dm::BinOp::Ne:
+            // Membership in a rangelist: the field must (Eq) or must 
+            // not (Ne) take one of the listed values
+            if ((lhs_k == Kind::Field && rhs_k == Kind::Set)
+                    || (lhs_k == Kind::Set && rhs_k == Kind::Field)) {
+                m_domain = (lhs_k == Kind::Set)?lhs_d:rhs_d;
+                if (e->op() == dm::BinOp::Ne) {
+                    m_domain.complement();
+                }
+                m_kind = Kind::Domain;
+                break;
+            }
+            // Otherwise, a comparison against a literal
+        case dm::BinOp::Lt:
+        case dm::BinOp::Le:
+        case dm::BinOp::Gt:
+        case dm::BinOp::Ge: {
+            dm::BinOp op = e->op();
+            uint64_t val;
+            bool val_s;
+
+            if (lhs_k == Kind::Field && rhs_k == Kind::Literal) {
+                val = rhs_v;
+                val_s = rhs_s;
+            } else if (lhs_k == Kind::Literal && rhs_k == Kind::Field) {
+                // Normalize to <field> <op> <literal>
+                val = lhs_v;
+                val_s = lhs_s;
+                switch (op) {
+                    case dm::BinOp::Lt: op = dm::BinOp::Gt; break;
+                    case dm::BinOp::Le: op = dm::BinOp::Ge; break;
+                    case dm::BinOp::Gt: op = dm::BinOp::Lt; break;
+                    case dm::BinOp::Ge: op = dm::BinOp::Le; break;
+                    default: break;
+                }
+            } else {
+                break;
+            }
+
+            // Comparisons are signed only when both operands are. Mixed
+            // signedness changes the field's ordering, so is left to 
+            // the SMT backend
+            if (m_signed != val_s) {
+                if (m_signed || static_cast<int64_t>(val) < 0) {
+                    break;
+                }
+            }
+
+            if (compare(op, bias(val, m_signed), m_domain)) {
+                m_kind = Kind::Domain;
+            }
+        } break;
+
+        default:
+            break;
+    }
+
+    if (m_kind == Kind::Fail) {
+        m_ok = false;
+    }
+
+    DEBUG_LEAVE("visitTypeExprBin");
+}
+
+void TaskBuildIntervalDomain::visitTypeExprFieldRef(dm::ITypeExprFieldRef *e) {
+    m_kind = Kind::Fail;
+}
+
+void TaskBuildIntervalDomain::visitTypeExprRangelist(dm::ITypeExprRangelist *e) {
+    DEBUG_ENTER("visitTypeExprRangelist");
+    // The rangelist reduces to the union of its ranges. All bounds
+    // must be literals
+    IntervalSet set;
+
+    for (std::vector<dm::ITypeExprRangeUP>::const_iterator
+        it=e->getRanges().begin();
+        it!=e->getRanges().end(); it++) {
+        uint64_t lo, hi;
+
+        if (!rangeBound((*it)->lower(), lo)) {
+            m_kind = Kind::Fail;
+            DEBUG_LEAVE("visitTypeExprRangelist -- non-literal bound");
+            return;
+        }
+
+        if ((*it)->isSingle() || !(*it)->upper()) {
+            hi = lo;
+        } else if (!rangeBound((*it)->upper(), hi)) {
+            m_kind = Kind::Fail;
+            DEBUG_LEAVE("visitTypeExprRangelist -- non-literal bound");
+            return;
+        }
+
+        // An inverted range holds no values
+        set.unite(IntervalSet(lo, hi));
+    }
+
+    m_domain = set;
+    m_kind = Kind::Set;
+    DEBUG_LEAVE("visitTypeExprRangelist");
+}
+
+void TaskBuildIntervalDomain::visitTypeExprRefPath(dm::ITypeExprRefPath *e) {
+    DEBUG_ENTER("visitTypeExprRefPath");
+    int32_t prefix_sz = m_path_prefix.size();
+    e->getTarget()->accept(m_this);
+
+    m_path_prefix.insert(
+        m_path_prefix.end(),
+        e->getPath().begin(),
+        e->getPath().end());
+
+    m_kind = (m_path_prefix == m_field_path)?Kind::Field:Kind::Fail;
+
+    m_path_prefix.resize(prefix_sz);
+    DEBUG_LEAVE("visitTypeExprRefPath");
+}
+
+void TaskBuildIntervalDomain::visitTypeExprVal(dm::ITypeExprVal *e) {
+    m_val = e->val();
+    m_kind = Kind::Literal;
+    e->val().type()->accept(m_this);
+}
+
+bool TaskBuildIntervalDomain::rangeBound(
+        dm::ITypeExpr                           *expr,
+        uint64_t                                &val) {
+    m_kind = Kind::Fail;
+    expr->accept(m_this);
+
+    if (m_kind != Kind::Literal) {
+        return false;
+    }
+
+    // Same signedness rules as comparisons against the field
+    if (m_signed != m_literal_signed) {
+        if (m_signed || static_cast<int64_t>(m_literal) < 0) {
+            return false;
+        }
+    }
+
+    val = bias(m_literal, m_signed);
+    return true;
+}
+
+bool TaskBuildIntervalDomain::compare(
+        dm::BinOp                               op,
+        uint64_t                                val,
+        IntervalSet                             &domain) {
+    switch (op) {
+        case dm::BinOp::Eq: 
+            domain = IntervalSet(val, val); 
+            break;
+        case dm::BinOp::Ne: 
+            domain = IntervalSet();
+            if (val > 0) {
+                domain.unite(IntervalSet(0, val-1));
+            }
+            if (val < UINT64_MAX) {
+                domain.unite(IntervalSet(val+1, UINT64_MAX));
+            }
+            break;
+        case dm::BinOp::Lt: 
+            domain = (val > 0)?IntervalSet(0, val-1):IntervalSet();
+            break;
+        case dm::BinOp::Le: 
+            domain = IntervalSet(0, val);
+            break;
+        case dm::BinOp::Gt: 
+            domain = (val < UINT64_MAX)?IntervalSet(val+1, UINT64_MAX):IntervalSet();
+            break;
+        case dm::BinOp::Ge: 
+            domain = IntervalSet(val, UINT64_MAX);
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+dmgr::IDebug *TaskBuildIntervalDomain::m_dbg = 0;
+
+}
+}
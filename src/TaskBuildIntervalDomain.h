@@ -0,0 +1,126 @@
+/**
+ * TaskBuildIntervalDomain.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <vector>
+#include "dmgr/IDebugMgr.h"
+#include "vsc/dm/IModelField.h"
+#include "vsc/dm/impl/VisitorBase.h"
+#include "vsc/solvers/ISolveSet.h"
+#include "IntervalSet.h"
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * Computes the domain of a solve set that holds a single integral 
+ * target field, when every constraint only compares that field against
+ * literals (Lt/Le/Gt/Ge/Eq/Ne) or tests its membership in a rangelist
+ * of literals, optionally combined with LogAnd/LogOr. Returns false
+ * when any constraint falls outside that form.
+ */
+class TaskBuildIntervalDomain : public dm::VisitorBase {
+public:
+    TaskBuildIntervalDomain(
+        dmgr::IDebugMgr                         *dmgr,
+        dm::IModelField                         *root_field);
+
+    virtual ~TaskBuildIntervalDomain();
+
+    bool build(
+        ISolveSet                               *solveset,
+        IntervalSet                             &domain,
+        bool                                    &is_signed);
+
+	virtual void visitDataTypeBool(dm::IDataTypeBool *t) override;
+
+	virtual void visitDataTypeEnum(dm::IDataTypeEnum *t) override;
+
+	virtual void visitDataTypeInt(dm::IDataTypeInt *t) override;
+
+	virtual void visitDataTypeStruct(dm::IDataTypeStruct *t) override;
+
+	virtual void visitTypeConstraintExpr(dm::ITypeConstraintExpr *c) override;
+
+	virtual void visitTypeConstraintIfElse(dm::ITypeConstraintIfElse *c) override;
+
+	virtual void visitTypeConstraintImplies(dm::ITypeConstraintImplies *c) override;
+
+	virtual void visitTypeConstraintScope(dm::ITypeConstraintScope *c) override;
+
+	virtual void visitTypeConstraintUnique(dm::ITypeConstraintUnique *c) override;
+
+	virtual void visitTypeExprBin(dm::ITypeExprBin *e) override;
+
+	virtual void visitTypeExprFieldRef(dm::ITypeExprFieldRef *e) override;
+
+	virtual void visitTypeExprRangelist(dm::ITypeExprRangelist *e) override;
+
+	virtual void visitTypeExprRefPath(dm::ITypeExprRefPath *e) override;
+
+	virtual void visitTypeExprVal(dm::ITypeExprVal *e) override;
+
+private:
+    enum class Kind {
+        Fail,       // Not representable as an interval set
+        Field,      // Reference to the solve-set field
+        Literal,    // Constant value
+        Set,        // Rangelist of constant values
+        Domain      // Boolean sub-expression over the field
+    };
+
+    // Maps a value to the order-preserving unsigned domain
+    uint64_t bias(uint64_t v, bool is_signed) const {
+        return (is_signed)?(v ^ (uint64_t(1) << 63)):v;
+    }
+
+    /**
+     * Evaluates a rangelist bound to a biased literal
+     */
+    bool rangeBound(
+        dm::ITypeExpr                           *expr,
+        uint64_t                                &val);
+
+    bool compare(
+        dm::BinOp                               op,
+        uint64_t                                val,
+        IntervalSet                             &domain);
+
+private:
+    static dmgr::IDebug                         *m_dbg;
+    dm::IModelField                             *m_root_field;
+    std::vector<int32_t>                        m_field_path;
+    std::vector<int32_t>                        m_path_prefix;
+    bool                                        m_ok;
+    bool                                        m_in_type;
+    int32_t                                     m_width;
+    bool                                        m_signed;
+    Kind                                        m_kind;
+    IntervalSet                                 m_domain;
+    uint64_t                                    m_literal;
+    bool                                        m_literal_signed;
+    dm::ValRef                                  m_val;
+};
+
+}
+}
+
+
@@ -18,10 +18,10 @@
  * Created on:
  *     Author:
  */
+#include <utility>
 #include "dmgr/impl/DebugMacros.h"
-#include "vsc/dm/ITypeExprFieldRef.h"
-#include "vsc/solvers/impl/RefPathConstraint.h"
 #include "TaskBuildSolveSets.h"
+#include "TaskBuildTypeDepGraph.h"
 
 
 namespace vsc {
@@ -34,12 +34,13 @@ TaskBuildSolveSets::TaskBuildSolveSets(
         const RefPathSet                        &target_fields,
         const RefPathSet                        &fixed_fields,
         const RefPathSet                        &include_constraints,
-        const RefPathSet                        &exclude_constraints
-        ) : m_phase(0), m_root_field(root_field), 
+        const RefPathSet                        &exclude_constraints,
+        TypeDepGraph                            *graph
+        ) : m_dmgr(dmgr), m_root_field(root_field), 
         m_target_fields(target_fields), m_fixed_fields(fixed_fields),
         m_include_constraints(include_constraints), 
         m_exclude_constraints(exclude_constraints),
-        m_ref_depth(0) {
+        m_graph(graph) {
     DEBUG_INIT("vsc::solvers::TaskBuildSolveSets", dmgr);
 }
 
@@ -51,22 +52,108 @@ void TaskBuildSolveSets::build(
     std::vector<ISolveSetUP>        &solvesets,
     RefPathSet                      &unconstrained) {
     DEBUG_ENTER("build");
-    m_active_ss_idx = -1;
-    m_constraint_depth = 0;
-    m_unconstrained = &unconstrained;
+    TypeDepGraphUP graph_l;
+    TypeDepGraph *graph = m_graph;
 
-    m_phase = 0; // Collect variable references from constraints
-    m_root_field->getDataType()->accept(m_this);
+    if (!graph) {
+        graph_l = TypeDepGraphUP(TaskBuildTypeDepGraph(m_dmgr).build(
+            m_root_field->getDataType()));
+        graph = graph_l.get();
+    }
+
+    const std::vector<std::vector<int32_t>> &fields = graph->getFields();
+    const std::vector<TypeDepGraph::Constraint> &constraints = graph->getConstraints();
 
-    m_phase = 1; // Collect unreferenced random fields
-    m_root_field->getDataType()->accept(m_this);
+    m_parent_l.resize(fields.size());
+    m_size_l.assign(fields.size(), 1);
+    for (uint32_t id=0; id<fields.size(); id++) {
+        m_parent_l.at(id) = id;
+    }
 
-    // Now, move the active solvesets to the destination
-    for (std::vector<SolveSetUP>::iterator
-        it=m_solveset_l.begin();
-        it!=m_solveset_l.end(); it++) {
-        if (it->get()) {
-            solvesets.push_back(ISolveSetUP(it->release()));
+    // Apply the include/exclude masks, and join the fields 
+    // referenced by each active constraint
+    std::vector<char> referenced(fields.size(), 0);
+    std::vector<uint32_t> active_l;
+    for (uint32_t i=0; i<constraints.size(); i++) {
+        const TypeDepGraph::Constraint &c = constraints.at(i);
+        if (c.fields.size() == 0) {
+            continue;
+        }
+        const std::vector<int32_t> &c_path = graph->getConstraintPath(c.id);
+        if (m_include_constraints.size() && !m_include_constraints.find(c_path)) {
+            continue;
+        }
+        if (m_exclude_constraints.size() && m_exclude_constraints.find(c_path)) {
+            continue;
+        }
+        active_l.push_back(i);
+        for (std::vector<int32_t>::const_iterator
+            it=c.fields.begin();
+            it!=c.fields.end(); it++) {
+            referenced.at(*it) = 1;
+            unite(c.fields.front(), *it);
+        }
+    }
+
+    // Materialize one solve set per partition. Solve sets are 
+    // ordered by the first-referenced field in each partition
+    uint32_t base = solvesets.size();
+    std::vector<int32_t> root_ss_idx(fields.size(), -1);
+    for (uint32_t id=0; id<fields.size(); id++) {
+        if (!referenced.at(id)) {
+            continue;
+        }
+        int32_t root = find(id);
+        if (root_ss_idx.at(root) == -1) {
+            root_ss_idx.at(root) = solvesets.size();
+            solvesets.push_back(ISolveSetUP(new SolveSet()));
+        }
+        SolveSet *ss = dynamic_cast<SolveSet *>(
+            solvesets.at(root_ss_idx.at(root)).get());
+        int32_t width = graph->getFieldWidth(id);
+        ss->addField(fields.at(id), getFieldType(fields.at(id)), width, id);
+        if (width > 64) {
+            ss->setFlag(SolveSetFlags::Wide);
+        }
+    }
+
+    // A solve set is non-linear if any of its constraints are. It is a
+    // domain only if all of its constraints bound its single target field
+    std::vector<char> domain(solvesets.size()-base, 1);
+    for (std::vector<uint32_t>::const_iterator
+        it=active_l.begin();
+        it!=active_l.end(); it++) {
+        const TypeDepGraph::Constraint &c = constraints.at(*it);
+        int32_t ss_idx = root_ss_idx.at(find(c.fields.front()));
+        SolveSet *ss = dynamic_cast<SolveSet *>(solvesets.at(ss_idx).get());
+        ss->addConstraint(graph->getConstraintPath(c.id), c.id);
+        ss->setFlag(c.flags & SolveSetFlags::NonLinear);
+        if ((c.flags & SolveSetFlags::Domain) == SolveSetFlags::NoFlags) {
+            domain.at(ss_idx-base) = 0;
+        }
+    }
+
+    for (uint32_t i=base; i<solvesets.size(); i++) {
+        SolveSet *ss = dynamic_cast<SolveSet *>(solvesets.at(i).get());
+        if ((ss->getFlags() & SolveSetFlags::NonLinear) == SolveSetFlags::NoFlags) {
+            ss->setFlag(SolveSetFlags::Linear);
+        }
+        if (domain.at(i-base) 
+            && ss->getFields().size() == 1 
+            && ss->size(SolveSetFieldType::Target) == 1) {
+            ss->setFlag(SolveSetFlags::Domain);
+        }
+    }
+    DEBUG("Partitioned %d fields into %d solve sets", 
+        fields.size(), solvesets.size()-base);
+
+    // Leaf fields not referenced by an active constraint are unconstrained
+    for (std::vector<TypeDepGraph::Leaf>::const_iterator
+        it=graph->getLeaves().begin();
+        it!=graph->getLeaves().end(); it++) {
+        if (it->field == -1 || !referenced.at(it->field)) {
+            DEBUG("Adding as unconstrained");
+            unconstrained.add(it->path);
         }
     }
 
@@ -94,260 +181,54 @@ void TaskBuildSolveSets::build(
     DEBUG_LEAVE("build");
 }
 
-void TaskBuildSolveSets::visitTypeConstraintExpr(dm::ITypeConstraintExpr *c) {
-    DEBUG_ENTER("visitTypeConstraintExpr");
-    enterConstraint();
-    VisitorBase::visitTypeConstraintExpr(c);
-    leaveConstraint();
-    DEBUG_LEAVE("visitTypeConstraintExpr");
-}
-
-void TaskBuildSolveSets::visitTypeConstraintIfElse(dm::ITypeConstraintIfElse *c) {
-    DEBUG_ENTER("visitTypeConstraintIfElse");
-    enterConstraint();
-    VisitorBase::visitTypeConstraintIfElse(c);
-    leaveConstraint();
-    DEBUG_LEAVE("visitTypeConstraintIfElse");
-}
-
-void TaskBuildSolveSets::visitTypeConstraintImplies(dm::ITypeConstraintImplies *c) {
-    DEBUG_ENTER("visitTypeConstraintImplies");
-    enterConstraint();
-    VisitorBase::visitTypeConstraintImplies(c);
-    leaveConstraint();
-    DEBUG_LEAVE("visitTypeConstraintImplies");
-}
-
-void TaskBuildSolveSets::visitTypeConstraintScope(dm::ITypeConstraintScope *c) {
-    DEBUG_ENTER("visitTypeConstraintScope");
-    for (uint32_t i=0; i<c->getConstraints().size(); i++) {
-        m_constraint_path.push_back(i);
-        c->getConstraints().at(i)->accept(m_this);
-        m_constraint_path.pop_back();
-    }
-    DEBUG_LEAVE("visitTypeConstraintScope");
-}
-
-void TaskBuildSolveSets::visitDataTypeBool(dm::IDataTypeBool *t) {
-    // TODO: need to be careful to only do this selectively
-    if (m_phase == 1) {
-        int32_t idx;
-        if (!m_field_ss_m.find(m_field_path, idx)) {
-            DEBUG("Adding as unconstrained");
-            m_unconstrained->add(m_field_path);
-        } else {
-            DEBUG("Already referenced");
-        }
-    }
-}
+SolveSetFieldType TaskBuildSolveSets::getFieldType(const std::vector<int32_t> &path) {
+    bool is_target = (m_target_fields.size() == 0 || m_target_fields.find(path));
+    bool is_fixed = ((m_target_fields.size() && !is_target) 
+                        || (m_fixed_fields.size() && m_fixed_fields.find(path)));
 
-void TaskBuildSolveSets::visitDataTypeEnum(dm::IDataTypeEnum *t) {
-    // TODO: need to be careful to only do this selectively
-    if (m_phase == 1) {
-        int32_t idx;
-        if (!m_field_ss_m.find(m_field_path, idx)) {
-            DEBUG("Adding as unconstrained");
-            m_unconstrained->add(m_field_path);
-        } else {
-            DEBUG("Already referenced");
-        }
+    // A field is a non-fixed non-target if either target or
+    // fixed fields are specified and the field is not part of either
+    if (is_fixed) {
+        return SolveSetFieldType::Fixed;
+    } else if (is_target) {
+        return SolveSetFieldType::Target;
+    } else {
+        return SolveSetFieldType::NonTarget;
     }
 }
 
-void TaskBuildSolveSets::visitDataTypeInt(dm::IDataTypeInt *t) {
-    DEBUG_ENTER("visitDataTypeInt");
-
-    // TODO: need to be careful to only do this selectively
-    if (m_phase == 1) {
-        int32_t idx;
-        if (!m_field_ss_m.find(m_field_path, idx)) {
-            DEBUG("Adding as unconstrained");
-            m_unconstrained->add(m_field_path);
-        } else {
-            DEBUG("Already referenced");
-        }
+int32_t TaskBuildSolveSets::find(int32_t id) {
+    int32_t root = id;
+    while (m_parent_l.at(root) != root) {
+        root = m_parent_l.at(root);
     }
-    DEBUG_LEAVE("visitDataTypeInt");
-}
 
-void TaskBuildSolveSets::visitDataTypeStruct(dm::IDataTypeStruct *t) {
-    DEBUG_ENTER("visitDataTypeStruct nFields=%d", t->getFields().size());
-    for (uint32_t i=0; i<t->getFields().size(); i++) {
-        m_field_path.push_back(i);
-        t->getFields().at(i)->accept(m_this);
-        m_field_path.pop_back();
+    // Compress the path, such that later lookups are direct
+    while (m_parent_l.at(id) != root) {
+        int32_t next = m_parent_l.at(id);
+        m_parent_l.at(id) = root;
+        id = next;
     }
-    if (m_phase == 0) {
-        // Constraint paths start with the crossover index
-        // between datatype and constraint hierarchy
-        m_constraint_path.clear();
-        m_constraint_path.push_back(m_field_path.size()+1);
-        m_constraint_path.insert(
-            m_constraint_path.begin()+m_constraint_path.size(),
-            m_field_path.begin(),
-            m_field_path.end());
-        for (uint32_t i=0; i<t->getConstraints().size(); i++) {
-            m_constraint_path.push_back(i);
-            t->getConstraints().at(i)->accept(m_this);
-            m_constraint_path.pop_back();
-        }
-        m_constraint_path.clear();
-    }
-    DEBUG_LEAVE("visitDataTypeStruct");
-}
-
-void TaskBuildSolveSets::visitTypeExprBin(dm::ITypeExprBin *e) {
-    DEBUG_ENTER("visitTypeExprBin");
-    e->lhs()->accept(m_this);
-    e->rhs()->accept(m_this);
-    DEBUG_LEAVE("visitTypeExprBin");
-}
-
-void TaskBuildSolveSets::visitTypeExprRefBottomUp(dm::ITypeExprRefBottomUp *e) {
-    DEBUG_ENTER("visitTypeExprRefBottomUp");
 
-    DEBUG_LEAVE("visitTypeExprRefBottomUp");
+    return root;
 }
 
-void TaskBuildSolveSets::visitTypeExprRefPath(dm::ITypeExprRefPath *e) {
-    DEBUG_ENTER("visitTypeExprRefPath");
-    uint32_t sz = m_field_path.size();
+void TaskBuildSolveSets::unite(int32_t id1, int32_t id2) {
+    int32_t r1 = find(id1);
+    int32_t r2 = find(id2);
 
-    m_ref_depth++;
-    e->getTarget()->accept(m_this);
-    m_ref_depth--;
-
-    m_field_path.insert(
-        m_field_path.end(), 
-        e->getPath().begin(), 
-        e->getPath().end());
-
-    if (!m_ref_depth) {
-        processFieldRef(m_field_path);
+    if (r1 == r2) {
+        return;
     }
 
-    m_field_path.resize(sz);
-
-    DEBUG_LEAVE("visitTypeExprRefPath");
-}
-
-void TaskBuildSolveSets::visitTypeExprRefTopDown(dm::ITypeExprRefTopDown *e) {
-    DEBUG_ENTER("visitTypeExprRefTopDown");
-
-    DEBUG_LEAVE("visitTypeExprRefTopDown");
-}
-
-void TaskBuildSolveSets::visitTypeExprFieldRef(dm::ITypeExprFieldRef *e) {
-    DEBUG_ENTER("visitTypeExprFieldRef");
-    uint32_t sz = m_field_path.size();
-    /* TODO:
-    m_field_path.insert(
-        m_field_path.end(), 
-        e->getPath().begin(), 
-        e->getPath().end());
-     */
-    processFieldRef(m_field_path);
-    m_field_path.resize(sz);
-    DEBUG_LEAVE("visitTypeExprFieldRef");
-}
-
-void TaskBuildSolveSets::visitTypeFieldPhy(dm::ITypeFieldPhy *f) {
-    DEBUG_ENTER("visitTypeFieldPhy %s (%s)", 
-        f->name().c_str(),
-        m_field_path.toString().c_str());
-
-    m_field_s.push_back(f);
-    f->getDataType()->accept(m_this);
-    m_field_s.pop_back();
-
-
-    DEBUG_LEAVE("visitTypeFieldPhy");
-}
-
-void TaskBuildSolveSets::processFieldRef(const RefPathField &ref) {
-    DEBUG_ENTER("processFieldRef %s", ref.toString().c_str());
-    int32_t ex_ss_idx;
-    SolveSet *ex_ss;
-
-    if (m_field_ss_m.find(ref, ex_ss_idx)) {
-        ex_ss = m_solveset_l.at(ex_ss_idx).get();
-        // We've previously processed this field.
-
-        if (m_active_ss_idx == -1) {
-            // This becomes our active solve-set, but nothing
-            // else to do
-            m_active_ss_idx = ex_ss_idx;
-        } else if (m_active_ss_idx != ex_ss_idx) {
-            // Need to combine two solvesets. Try to move the 
-            // least data by merging the smaller into the
-            // currently-larger
-            int32_t src_idx, dst_idx;
-
-            if (m_solveset_l.at(m_active_ss_idx)->size() > ex_ss->size()) {
-                dst_idx = m_active_ss_idx;
-                src_idx = ex_ss_idx;
-            } else {
-                dst_idx = ex_ss_idx;
-                src_idx = m_active_ss_idx;
-            }
-
-            DEBUG("Merging randset %d <- %d", dst_idx, src_idx);
-
-            m_solveset_l.at(dst_idx)->merge(m_solveset_l.at(src_idx).get());
-
-            // Now, all field paths in the source must be updated to the dest
-            for (RefPathMap<SolveSetFieldType>::iterator 
-                it=m_solveset_l.at(src_idx)->getFields().begin(); 
-                it.next(); ) {
-                m_field_ss_m.add(it.path(), dst_idx, true);
-            }
-
-            // Finally, remove the source from the list and update the active set
-            m_solveset_l.at(src_idx).reset();
-            m_active_ss_idx = dst_idx;
-        }
-    } else {
-        // Field not-yet seen
-        if (m_active_ss_idx == -1) {
-            DEBUG("Creating a new randset");
-            m_active_ss_idx = m_solveset_l.size();
-            m_solveset_l.push_back(SolveSetUP(new SolveSet()));
-        }
-
-        bool is_target = (m_target_fields.size() == 0 || m_target_fields.find(ref));
-        bool is_fixed = ((m_target_fields.size() && !is_target) 
-                            || (m_fixed_fields.size() && m_fixed_fields.find(ref)));
-
-        // A field is a non-fixed non-target if either target or
-        // fixed fields are specified and the field is not part of either
-        if (is_fixed) {
-            m_solveset_l.at(m_active_ss_idx)->addField(
-                ref, SolveSetFieldType::Fixed);
-        } else if (is_target) {
-            m_solveset_l.at(m_active_ss_idx)->addField(
-                ref, SolveSetFieldType::Target);
-        } else {
-            m_solveset_l.at(m_active_ss_idx)->addField(
-                ref, SolveSetFieldType::NonTarget);
-        }
-        DEBUG("Add field to randset");
-        m_field_ss_m.add(ref, m_active_ss_idx);
+    // Attach the smaller tree below the larger
+    if (m_size_l.at(r1) < m_size_l.at(r2)) {
+        std::swap(r1, r2);
     }
-    DEBUG_LEAVE("processFieldRef");
-}
-
-void TaskBuildSolveSets::enterConstraint() {
-    m_constraint_depth++;
-}
 
-void TaskBuildSolveSets::leaveConstraint() {
-    m_constraint_depth--;
-
-    if (!m_constraint_depth && m_active_ss_idx != -1) {
-        DEBUG("Add constraint: %s", 
-            RefPathConstraint(m_constraint_path).toString().c_str());
-        m_solveset_l.at(m_active_ss_idx)->addConstraint(m_constraint_path);
-    }
+    DEBUG("Merging partition %d <- %d", r1, r2);
+    m_parent_l.at(r2) = r1;
+    m_size_l.at(r1) += m_size_l.at(r2);
 }
 
 dmgr::IDebug *TaskBuildSolveSets::m_dbg = 0;
@@ -20,21 +20,24 @@
  */
 #pragma once
 #include <vector>
+#include "dmgr/IDebugMgr.h"
 #include "vsc/dm/IModelField.h"
-#include "vsc/dm/impl/VisitorBase.h"
-#include "vsc/solvers/IFactory.h"
 #include "vsc/solvers/ISolveSet.h"
-#include "vsc/solvers/impl/RefPathField.h"
 #include "vsc/solvers/impl/RefPathSet.h"
-#include "vsc/solvers/impl/RefPathMap.h"
 #include "SolveSet.h"
+#include "TypeDepGraph.h"
 
 namespace vsc {
 namespace solvers {
 
 
 
-class TaskBuildSolveSets : public virtual dm::VisitorBase {
+/**
+ * Partitions the fields of a root field into independent solve sets,
+ * applying the target/fixed/include/exclude sets to the dependency
+ * graph of the root type. When no graph is supplied, one is built.
+ */
+class TaskBuildSolveSets {
 public:
     TaskBuildSolveSets(
         dmgr::IDebugMgr                         *dmgr,
@@ -42,7 +45,8 @@ public:
         const RefPathSet                        &target_fields,
         const RefPathSet                        &fixed_fields,
         const RefPathSet                        &include_constraints,
-        const RefPathSet                        &exclude_constraints);
+        const RefPathSet                        &exclude_constraints,
+        TypeDepGraph                            *graph=0);
 
     virtual ~TaskBuildSolveSets();
 
@@ -50,60 +54,27 @@ public:
         std::vector<ISolveSetUP>        &solvesets,
         RefPathSet                      &unconstrained);
 
-	virtual void visitDataTypeBool(dm::IDataTypeBool *t) override;
-
-	virtual void visitDataTypeEnum(dm::IDataTypeEnum *t) override;
-
-	virtual void visitDataTypeInt(dm::IDataTypeInt *t) override;
-
-	virtual void visitDataTypeStruct(dm::IDataTypeStruct *t) override;
-
-	virtual void visitTypeConstraintExpr(dm::ITypeConstraintExpr *c) override;
-
-	virtual void visitTypeConstraintIfElse(dm::ITypeConstraintIfElse *c) override;
-
-	virtual void visitTypeConstraintImplies(dm::ITypeConstraintImplies *c) override;
-
-	virtual void visitTypeConstraintScope(dm::ITypeConstraintScope *c) override;
-
-	virtual void visitTypeExprBin(dm::ITypeExprBin *e) override;
-
-	virtual void visitTypeExprRefBottomUp(dm::ITypeExprRefBottomUp *e) override;
-
-	virtual void visitTypeExprRefPath(dm::ITypeExprRefPath *e) override;
-
-	virtual void visitTypeExprRefTopDown(dm::ITypeExprRefTopDown *e) override;
-
-	virtual void visitTypeExprFieldRef(dm::ITypeExprFieldRef *e) override;
-
-	virtual void visitTypeFieldPhy(dm::ITypeFieldPhy *f) override;
-
 protected:
 
-    void processFieldRef(const RefPathField &ref);
+    SolveSetFieldType getFieldType(const std::vector<int32_t> &path);
 
-    void enterConstraint();
+    int32_t find(int32_t id);
 
-    void leaveConstraint();
+    void unite(int32_t id1, int32_t id2);
 
 protected:
     static dmgr::IDebug                         *m_dbg;
-    uint32_t                                    m_phase;
+    dmgr::IDebugMgr                             *m_dmgr;
     dm::IModelField                             *m_root_field;
     const RefPathSet                            &m_target_fields;
     const RefPathSet                            &m_fixed_fields;
     const RefPathSet                            &m_include_constraints;
     const RefPathSet                            &m_exclude_constraints;
-    std::vector<dm::ITypeField *>               m_field_s;
-    int32_t                                     m_ref_depth;
-    RefPathField                                m_field_path;
-    std::vector<int32_t>                        m_constraint_path;
+    TypeDepGraph                                *m_graph;
 
-    RefPathMap<int32_t>                         m_field_ss_m;
-    int32_t                                     m_active_ss_idx;
-    int32_t                                     m_constraint_depth;
-    std::vector<SolveSetUP>                     m_solveset_l;
-    RefPathSet                                  *m_unconstrained;
+    // Union-find over the field IDs of the dependency graph
+    std::vector<int32_t>                        m_parent_l;
+    std::vector<int32_t>                        m_size_l;
 };
 
 }
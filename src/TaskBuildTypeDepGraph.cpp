@@ -0,0 +1,338 @@
+/*
+ * TaskBuildTypeDepGraph.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "dmgr/impl/DebugMacros.h"
+#include "vsc/dm/ITypeExprFieldRef.h"
+#include "vsc/dm/ITypeExprRange.h"
+#include "vsc/dm/ITypeExprRangelist.h"
+#include "vsc/solvers/impl/RefPathConstraint.h"
+#include "TaskBuildTypeDepGraph.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+TaskBuildTypeDepGraph::TaskBuildTypeDepGraph(dmgr::IDebugMgr *dmgr) :
+        m_phase(0), m_ref_depth(0), m_constraint_depth(0),
+        m_flags(SolveSetFlags::NoFlags), m_bound(false),
+        m_expr_kind(ExprKind::Other), m_num_refs(0) {
+    DEBUG_INIT("vsc::solvers::TaskBuildTypeDepGraph", dmgr);
+}
+
+TaskBuildTypeDepGraph::~TaskBuildTypeDepGraph() {
+
+}
+
+TypeDepGraph *TaskBuildTypeDepGraph::build(dm::IDataType *type) {
+    DEBUG_ENTER("build");
+    m_graph = new TypeDepGraph(type);
+    m_constraint_depth = 0;
+
+    m_phase = 0; // Collect variable references from constraints
+    type->accept(m_this);
+
+    m_phase = 1; // Collect leaf fields
+    type->accept(m_this);
+
+    DEBUG_LEAVE("build %d fields %d constraints %d leaves",
+        m_graph->getFields().size(),
+        m_graph->getConstraints().size(),
+        m_graph->getLeaves().size());
+    return m_graph;
+}
+
+void TaskBuildTypeDepGraph::visitTypeConstraintExpr(dm::ITypeConstraintExpr *c) {
+    DEBUG_ENTER("visitTypeConstraintExpr");
+    enterConstraint();
+    m_expr_kind = ExprKind::Other;
+    VisitorBase::visitTypeConstraintExpr(c);
+    if (m_expr_kind != ExprKind::Ref && m_expr_kind != ExprKind::Bound) {
+        m_bound = false;
+    }
+    leaveConstraint();
+    DEBUG_LEAVE("visitTypeConstraintExpr");
+}
+
+void TaskBuildTypeDepGraph::visitTypeConstraintIfElse(dm::ITypeConstraintIfElse *c) {
+    DEBUG_ENTER("visitTypeConstraintIfElse");
+    enterConstraint();
+    m_bound = false;
+    VisitorBase::visitTypeConstraintIfElse(c);
+    leaveConstraint();
+    DEBUG_LEAVE("visitTypeConstraintIfElse");
+}
+
+void TaskBuildTypeDepGraph::visitTypeConstraintImplies(dm::ITypeConstraintImplies *c) {
+    DEBUG_ENTER("visitTypeConstraintImplies");
+    enterConstraint();
+    m_bound = false;
+    VisitorBase::visitTypeConstraintImplies(c);
+    leaveConstraint();
+    DEBUG_LEAVE("visitTypeConstraintImplies");
+}
+
+void TaskBuildTypeDepGraph::visitTypeConstraintScope(dm::ITypeConstraintScope *c) {
+    DEBUG_ENTER("visitTypeConstraintScope");
+    for (uint32_t i=0; i<c->getConstraints().size(); i++) {
+        m_constraint_path.push_back(i);
+        c->getConstraints().at(i)->accept(m_this);
+        m_constraint_path.pop_back();
+    }
+    DEBUG_LEAVE("visitTypeConstraintScope");
+}
+
+void TaskBuildTypeDepGraph::visitDataTypeBool(dm::IDataTypeBool *t) {
+    // TODO: need to be careful to only do this selectively
+    if (m_phase == 1) {
+        m_graph->addLeaf(m_field_path, 1);
+    }
+}
+
+void TaskBuildTypeDepGraph::visitDataTypeEnum(dm::IDataTypeEnum *t) {
+    // TODO: need to be careful to only do this selectively
+    if (m_phase == 1) {
+        m_graph->addLeaf(m_field_path);
+    }
+}
+
+void TaskBuildTypeDepGraph::visitDataTypeInt(dm::IDataTypeInt *t) {
+    DEBUG_ENTER("visitDataTypeInt");
+
+    // TODO: need to be careful to only do this selectively
+    if (m_phase == 1) {
+        m_graph->addLeaf(m_field_path, t->width());
+    }
+    DEBUG_LEAVE("visitDataTypeInt");
+}
+
+void TaskBuildTypeDepGraph::visitDataTypeStruct(dm::IDataTypeStruct *t) {
+    DEBUG_ENTER("visitDataTypeStruct nFields=%d", t->getFields().size());
+    for (uint32_t i=0; i<t->getFields().size(); i++) {
+        m_field_path.push_back(i);
+        t->getFields().at(i)->accept(m_this);
+        m_field_path.pop_back();
+    }
+    if (m_phase == 0) {
+        // Constraint paths start with the crossover index
+        // between datatype and constraint hierarchy
+        m_constraint_path.clear();
+        m_constraint_path.push_back(m_field_path.size()+1);
+        m_constraint_path.insert(
+            m_constraint_path.begin()+m_constraint_path.size(),
+            m_field_path.begin(),
+            m_field_path.end());
+        for (uint32_t i=0; i<t->getConstraints().size(); i++) {
+            m_constraint_path.push_back(i);
+            t->getConstraints().at(i)->accept(m_this);
+            m_constraint_path.pop_back();
+        }
+        m_constraint_path.clear();
+    }
+    DEBUG_LEAVE("visitDataTypeStruct");
+}
+
+void TaskBuildTypeDepGraph::visitTypeExprBin(dm::ITypeExprBin *e) {
+    DEBUG_ENTER("visitTypeExprBin");
+    uint32_t n_refs = m_num_refs;
+    e->lhs()->accept(m_this);
+    ExprKind lhs_k = m_expr_kind;
+    uint32_t n_lhs_refs = m_num_refs - n_refs;
+
+    e->rhs()->accept(m_this);
+    ExprKind rhs_k = m_expr_kind;
+    uint32_t n_rhs_refs = m_num_refs - n_refs - n_lhs_refs;
+
+    m_expr_kind = ExprKind::Other;
+    switch (e->op()) {
+        case dm::BinOp::Eq:
+        case dm::BinOp::Ne:
+            if ((lhs_k == ExprKind::Ref && rhs_k == ExprKind::Set)
+                || (lhs_k == ExprKind::Set && rhs_k == ExprKind::Ref)) {
+                m_expr_kind = ExprKind::Bound;
+                break;
+            }
+            // Otherwise, a comparison against a literal
+        case dm::BinOp::Gt:
+        case dm::BinOp::Ge:
+        case dm::BinOp::Lt:
+        case dm::BinOp::Le:
+            if ((lhs_k == ExprKind::Ref && rhs_k == ExprKind::Val)
+                || (lhs_k == ExprKind::Val && rhs_k == ExprKind::Ref)) {
+                m_expr_kind = ExprKind::Bound;
+            }
+            break;
+        case dm::BinOp::LogAnd:
+        case dm::BinOp::LogOr:
+            if ((lhs_k == ExprKind::Ref || lhs_k == ExprKind::Bound)
+                && (rhs_k == ExprKind::Ref || rhs_k == ExprKind::Bound)) {
+                m_expr_kind = ExprKind::Bound;
+            }
+            break;
+        case dm::BinOp::Mul:
+        case dm::BinOp::Div:
+        case dm::BinOp::Mod:
+        case dm::BinOp::Sll:
+        case dm::BinOp::Srl:
+            // Only a product of two variable terms is non-linear
+            if (n_lhs_refs && n_rhs_refs) {
+                m_flags = m_flags | SolveSetFlags::NonLinear;
+            }
+            break;
+        default:
+            break;
+    }
+    DEBUG_LEAVE("visitTypeExprBin");
+}
+
+void TaskBuildTypeDepGraph::visitTypeExprRefBottomUp(dm::ITypeExprRefBottomUp *e) {
+    DEBUG_ENTER("visitTypeExprRefBottomUp");
+
+    DEBUG_LEAVE("visitTypeExprRefBottomUp");
+}
+
+void TaskBuildTypeDepGraph::visitTypeExprRefPath(dm::ITypeExprRefPath *e) {
+    DEBUG_ENTER("visitTypeExprRefPath");
+    uint32_t sz = m_field_path.size();
+
+    m_ref_depth++;
+    e->getTarget()->accept(m_this);
+    m_ref_depth--;
+
+    m_field_path.insert(
+        m_field_path.end(), 
+        e->getPath().begin(), 
+        e->getPath().end());
+
+    if (!m_ref_depth) {
+        processFieldRef(m_field_path);
+        m_expr_kind = ExprKind::Ref;
+    }
+
+    m_field_path.resize(sz);
+
+    DEBUG_LEAVE("visitTypeExprRefPath");
+}
+
+void TaskBuildTypeDepGraph::visitTypeExprRefTopDown(dm::ITypeExprRefTopDown *e) {
+    DEBUG_ENTER("visitTypeExprRefTopDown");
+
+    DEBUG_LEAVE("visitTypeExprRefTopDown");
+}
+
+void TaskBuildTypeDepGraph::visitTypeExprFieldRef(dm::ITypeExprFieldRef *e) {
+    DEBUG_ENTER("visitTypeExprFieldRef");
+    uint32_t sz = m_field_path.size();
+    /* TODO:
+    m_field_path.insert(
+        m_field_path.end(), 
+        e->getPath().begin(), 
+        e->getPath().end());
+     */
+    processFieldRef(m_field_path);
+    m_expr_kind = ExprKind::Ref;
+    m_field_path.resize(sz);
+    DEBUG_LEAVE("visitTypeExprFieldRef");
+}
+
+void TaskBuildTypeDepGraph::visitTypeExprRangelist(dm::ITypeExprRangelist *e) {
+    DEBUG_ENTER("visitTypeExprRangelist");
+    // Bounds may reference fields, which are dependencies
+    bool is_set = true;
+    for (std::vector<dm::ITypeExprRangeUP>::const_iterator
+        it=e->getRanges().begin();
+        it!=e->getRanges().end(); it++) {
+        (*it)->lower()->accept(m_this);
+        is_set &= (m_expr_kind == ExprKind::Val);
+        if (!(*it)->isSingle() && (*it)->upper()) {
+            (*it)->upper()->accept(m_this);
+            is_set &= (m_expr_kind == ExprKind::Val);
+        }
+    }
+    m_expr_kind = (is_set)?ExprKind::Set:ExprKind::Other;
+    DEBUG_LEAVE("visitTypeExprRangelist");
+}
+
+void TaskBuildTypeDepGraph::visitTypeExprVal(dm::ITypeExprVal *e) {
+    m_expr_kind = ExprKind::Val;
+}
+
+void TaskBuildTypeDepGraph::visitTypeFieldPhy(dm::ITypeFieldPhy *f) {
+    DEBUG_ENTER("visitTypeFieldPhy %s (%s)", 
+        f->name().c_str(),
+        m_field_path.toString().c_str());
+
+    m_field_s.push_back(f);
+    f->getDataType()->accept(m_this);
+    m_field_s.pop_back();
+
+
+    DEBUG_LEAVE("visitTypeFieldPhy");
+}
+
+void TaskBuildTypeDepGraph::processFieldRef(const RefPathField &ref) {
+    DEBUG_ENTER("processFieldRef %s", ref.toString().c_str());
+    int32_t id = m_graph->addField(ref);
+    m_num_refs++;
+
+    bool found = false;
+    for (std::vector<int32_t>::const_iterator
+        it=m_ref_l.begin();
+        it!=m_ref_l.end(); it++) {
+        if (*it == id) {
+            found = true;
+            break;
+        }
+    }
+
+    if (!found) {
+        m_ref_l.push_back(id);
+    }
+    DEBUG_LEAVE("processFieldRef");
+}
+
+void TaskBuildTypeDepGraph::enterConstraint() {
+    if (!m_constraint_depth) {
+        m_flags = SolveSetFlags::NoFlags;
+        m_bound = true;
+    }
+    m_constraint_depth++;
+}
+
+void TaskBuildTypeDepGraph::leaveConstraint() {
+    m_constraint_depth--;
+
+    if (!m_constraint_depth) {
+        DEBUG("Add constraint: %s (%d refs)", 
+            RefPathConstraint(m_constraint_path).toString().c_str(),
+            m_ref_l.size());
+        // A domain constraint only bounds the value of a single field
+        if (m_bound && m_ref_l.size() == 1) {
+            m_flags = m_flags | SolveSetFlags::Domain;
+        }
+        m_graph->addConstraint(m_constraint_path, m_ref_l, m_flags);
+        m_ref_l.clear();
+    }
+}
+
+dmgr::IDebug *TaskBuildTypeDepGraph::m_dbg = 0;
+
+}
+}
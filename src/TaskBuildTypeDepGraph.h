@@ -0,0 +1,117 @@
+/**
+ * TaskBuildTypeDepGraph.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <vector>
+#include "dmgr/IDebugMgr.h"
+#include "vsc/dm/IDataType.h"
+#include "vsc/dm/impl/VisitorBase.h"
+#include "vsc/solvers/impl/RefPathField.h"
+#include "TypeDepGraph.h"
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * Builds the field/constraint dependency graph of a root datatype
+ */
+class TaskBuildTypeDepGraph : public virtual dm::VisitorBase {
+public:
+    TaskBuildTypeDepGraph(dmgr::IDebugMgr *dmgr);
+
+    virtual ~TaskBuildTypeDepGraph();
+
+    TypeDepGraph *build(dm::IDataType *type);
+
+	virtual void visitDataTypeBool(dm::IDataTypeBool *t) override;
+
+	virtual void visitDataTypeEnum(dm::IDataTypeEnum *t) override;
+
+	virtual void visitDataTypeInt(dm::IDataTypeInt *t) override;
+
+	virtual void visitDataTypeStruct(dm::IDataTypeStruct *t) override;
+
+	virtual void visitTypeConstraintExpr(dm::ITypeConstraintExpr *c) override;
+
+	virtual void visitTypeConstraintIfElse(dm::ITypeConstraintIfElse *c) override;
+
+	virtual void visitTypeConstraintImplies(dm::ITypeConstraintImplies *c) override;
+
+	virtual void visitTypeConstraintScope(dm::ITypeConstraintScope *c) override;
+
+	virtual void visitTypeExprBin(dm::ITypeExprBin *e) override;
+
+	virtual void visitTypeExprRefBottomUp(dm::ITypeExprRefBottomUp *e) override;
+
+	virtual void visitTypeExprRefPath(dm::ITypeExprRefPath *e) override;
+
+	virtual void visitTypeExprRefTopDown(dm::ITypeExprRefTopDown *e) override;
+
+	virtual void visitTypeExprFieldRef(dm::ITypeExprFieldRef *e) override;
+
+	virtual void visitTypeExprRangelist(dm::ITypeExprRangelist *e) override;
+
+	virtual void visitTypeExprVal(dm::ITypeExprVal *e) override;
+
+	virtual void visitTypeFieldPhy(dm::ITypeFieldPhy *f) override;
+
+protected:
+    // Shape of the most-recently visited expression
+    enum class ExprKind {
+        Ref,        // Bare field reference
+        Val,        // Literal
+        Set,        // Rangelist of literals
+        Bound,      // Comparison between a field and a literal, 
+                    // membership of a field in a rangelist, or
+                    // a logical combination of bounds
+        Other
+    };
+
+protected:
+
+    void processFieldRef(const RefPathField &ref);
+
+    void enterConstraint();
+
+    void leaveConstraint();
+
+protected:
+    static dmgr::IDebug                         *m_dbg;
+    uint32_t                                    m_phase;
+    TypeDepGraph                                *m_graph;
+    std::vector<dm::ITypeField *>               m_field_s;
+    int32_t                                     m_ref_depth;
+    RefPathField                                m_field_path;
+    std::vector<int32_t>                        m_constraint_path;
+    int32_t                                     m_constraint_depth;
+    // Field IDs referenced by the current top-level constraint
+    std::vector<int32_t>                        m_ref_l;
+    // Classification of the current top-level constraint
+    SolveSetFlags                               m_flags;
+    bool                                        m_bound;
+    ExprKind                                    m_expr_kind;
+    uint32_t                                    m_num_refs;
+};
+
+}
+}
+
+
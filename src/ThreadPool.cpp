@@ -0,0 +1,140 @@
+/*
+ * ThreadPool.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "ThreadPool.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+ThreadPool::ThreadPool(uint32_t n_threads) : 
+    m_generation(0), m_pending(0), m_shutdown(false) {
+    if (!n_threads) {
+        n_threads = 1;
+    }
+    for (uint32_t i=0; i<n_threads; i++) {
+        m_workers.push_back(std::unique_ptr<Worker>(new Worker()));
+    }
+    for (uint32_t i=0; i<n_threads; i++) {
+        m_threads.push_back(std::thread(&ThreadPool::worker, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_work_cv.notify_all();
+    for (std::vector<std::thread>::iterator
+        it=m_threads.begin();
+        it!=m_threads.end(); it++) {
+        it->join();
+    }
+}
+
+void ThreadPool::run(const std::vector<Task> &tasks) {
+    if (!tasks.size()) {
+        return;
+    }
+
+    // Account for the tasks before they become visible. A worker 
+    // finishing up the previous batch may pick up a new task as
+    // soon as it is queued.
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_pending = tasks.size();
+    }
+
+    // Deal tasks round-robin, preserving submission order within
+    // each worker's queue
+    for (uint32_t i=0; i<tasks.size(); i++) {
+        Worker *w = m_workers.at(i % m_workers.size()).get();
+        std::unique_lock<std::mutex> lock(w->mutex);
+        w->tasks.push_back(&tasks.at(i));
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_generation++;
+    m_work_cv.notify_all();
+
+    while (m_pending) {
+        m_done_cv.wait(lock);
+    }
+}
+
+void ThreadPool::worker(uint32_t idx) {
+    uint64_t generation = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_shutdown && m_generation == generation) {
+                m_work_cv.wait(lock);
+            }
+            if (m_shutdown) {
+                break;
+            }
+            generation = m_generation;
+        }
+
+        const Task *task;
+        while ((task = take(idx))) {
+            (*task)();
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!(--m_pending)) {
+                m_done_cv.notify_all();
+            }
+        }
+    }
+}
+
+const ThreadPool::Task *ThreadPool::take(uint32_t idx) {
+    const Task *ret = 0;
+
+    // First, look at our own queue
+    {
+        Worker *w = m_workers.at(idx).get();
+        std::unique_lock<std::mutex> lock(w->mutex);
+        if (w->tasks.size()) {
+            ret = w->tasks.front();
+            w->tasks.pop_front();
+            return ret;
+        }
+    }
+
+    // Otherwise, try stealing from another worker
+    for (uint32_t i=1; i<m_workers.size(); i++) {
+        Worker *w = m_workers.at((idx+i) % m_workers.size()).get();
+        std::unique_lock<std::mutex> lock(w->mutex);
+        if (w->tasks.size()) {
+            ret = w->tasks.back();
+            w->tasks.pop_back();
+            return ret;
+        }
+    }
+
+    return ret;
+}
+
+}
+}
@@ -0,0 +1,86 @@
+/**
+ * ThreadPool.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * Fixed-size pool of worker threads that executes batches of tasks.
+ * Tasks are dealt round-robin, in submission order, to per-worker 
+ * queues. A worker takes tasks from the front of its own queue and,
+ * once that is empty, steals from the back of other workers' queues.
+ * Submitting tasks in decreasing order of cost thus has workers start 
+ * on the most-expensive tasks first.
+ */
+class ThreadPool;
+using ThreadPoolUP=std::unique_ptr<ThreadPool>;
+class ThreadPool {
+public:
+    using Task=std::function<void()>;
+
+    ThreadPool(uint32_t n_threads);
+
+    virtual ~ThreadPool();
+
+    uint32_t size() const { return m_threads.size(); }
+
+    /**
+     * Runs all tasks to completion. Blocks the caller until done.
+     * Only one thread may submit tasks at a time.
+     */
+    void run(const std::vector<Task> &tasks);
+
+private:
+    struct Worker {
+        std::mutex                  mutex;
+        std::deque<const Task *>    tasks;
+    };
+
+    void worker(uint32_t idx);
+
+    const Task *take(uint32_t idx);
+
+private:
+    std::vector<std::unique_ptr<Worker>>        m_workers;
+    std::vector<std::thread>                    m_threads;
+    std::mutex                                  m_mutex;
+    std::condition_variable                     m_work_cv;
+    std::condition_variable                     m_done_cv;
+    uint64_t                                    m_generation;
+    uint32_t                                    m_pending;
+    bool                                        m_shutdown;
+
+};
+
+}
+}
+
+
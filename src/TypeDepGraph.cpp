@@ -0,0 +1,66 @@
+/*
+ * TypeDepGraph.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "TypeDepGraph.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+TypeDepGraph::TypeDepGraph(dm::IDataType *type) : m_type(type) {
+
+}
+
+TypeDepGraph::~TypeDepGraph() {
+
+}
+
+int32_t TypeDepGraph::addField(const std::vector<int32_t> &path) {
+    int32_t id = m_field_t.intern(path);
+    if (m_field_width_l.size() < m_field_t.size()) {
+        m_field_width_l.push_back(-1);
+    }
+    return id;
+}
+
+int32_t TypeDepGraph::findField(const std::vector<int32_t> &path) {
+    return m_field_t.find(path);
+}
+
+void TypeDepGraph::addConstraint(
+        const std::vector<int32_t>      &path,
+        const std::vector<int32_t>      &fields,
+        SolveSetFlags                   flags) {
+    m_constraint_l.push_back({m_constraint_t.intern(path), fields, flags});
+}
+
+void TypeDepGraph::addLeaf(
+        const std::vector<int32_t>      &path,
+        int32_t                         width) {
+    int32_t id = findField(path);
+    if (id != -1) {
+        m_field_width_l.at(id) = width;
+    }
+    m_leaf_l.push_back({path, id});
+}
+
+}
+}
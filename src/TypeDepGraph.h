@@ -0,0 +1,124 @@
+/**
+ * TypeDepGraph.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <memory>
+#include <vector>
+#include "vsc/dm/IDataType.h"
+#include "vsc/solvers/ISolveSet.h"
+#include "RefPathTable.h"
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * Field/constraint connectivity of a root datatype. Referenced fields
+ * and top-level constraints are interned to dense IDs, and each
+ * constraint records the IDs of the fields it references. The graph only depends on the type,
+ * so it is computed once and re-used to partition any instance.
+ * Constraints are also classified here (eg linear vs non-linear),
+ * such that solve-set flags don't require re-visiting constraints.
+ */
+class TypeDepGraph;
+using TypeDepGraphUP=std::unique_ptr<TypeDepGraph>;
+class TypeDepGraph {
+public:
+    struct Constraint {
+        // ID of the constraint path
+        int32_t                         id;
+        std::vector<int32_t>            fields;
+        // Only NonLinear and Domain are classified per constraint
+        SolveSetFlags                   flags;
+    };
+
+    struct Leaf {
+        std::vector<int32_t>            path;
+        // ID of the field, or -1 if no constraint references it
+        int32_t                         field;
+    };
+
+public:
+    TypeDepGraph(dm::IDataType *type);
+
+    virtual ~TypeDepGraph();
+
+    dm::IDataType *getType() const { return m_type; }
+
+    /**
+     * Returns the ID of a field, interning it if needed
+     */
+    int32_t addField(const std::vector<int32_t> &path);
+
+    /**
+     * Returns the ID of a field, or -1 if it is unreferenced
+     */
+    int32_t findField(const std::vector<int32_t> &path);
+
+    void addConstraint(
+        const std::vector<int32_t>      &path,
+        const std::vector<int32_t>      &fields,
+        SolveSetFlags                   flags=SolveSetFlags::NoFlags);
+
+    void addLeaf(
+        const std::vector<int32_t>      &path,
+        int32_t                         width=-1);
+
+    /**
+     * Returns the width (bits) of a field, or -1 if unknown
+     */
+    int32_t getFieldWidth(int32_t id) const {
+        return m_field_width_l.at(id);
+    }
+
+    const std::vector<int32_t> &getFieldPath(int32_t id) const {
+        return m_field_t.getPath(id);
+    }
+
+    const std::vector<int32_t> &getConstraintPath(int32_t id) const {
+        return m_constraint_t.getPath(id);
+    }
+
+    const std::vector<std::vector<int32_t>> &getFields() const {
+        return m_field_t.getPaths();
+    }
+
+    const std::vector<Constraint> &getConstraints() const {
+        return m_constraint_l;
+    }
+
+    const std::vector<Leaf> &getLeaves() const {
+        return m_leaf_l;
+    }
+
+private:
+    dm::IDataType                               *m_type;
+    RefPathTable                                m_field_t;
+    RefPathTable                                m_constraint_t;
+    std::vector<int32_t>                        m_field_width_l;
+    std::vector<Constraint>                     m_constraint_l;
+    std::vector<Leaf>                           m_leaf_l;
+
+};
+
+}
+}
+
+
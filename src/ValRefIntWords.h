@@ -0,0 +1,134 @@
+/**
+ * ValRefIntWords.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <stdint.h>
+#include <string>
+#include "vsc/dm/impl/ValRefInt.h"
+
+namespace vsc {
+namespace solvers {
+
+
+
+/**
+ * Accesses integer values of any width as words, least-significant 
+ * first. Values up to 64 bits are held in the reference itself, while
+ * wider values are held out-of-line, least-significant word first.
+ */
+class ValRefIntWords {
+public:
+
+    static uint32_t numWords(uint32_t width) {
+        return (width-1)/64+1;
+    }
+
+    /**
+     * Reads numWords(width) words. Values narrower than 'width' are
+     * sign- or zero-extended, and bits above 'width' are cleared
+     */
+    static void get(
+        const dm::ValRefInt     &val,
+        uint32_t                width,
+        bool                    is_signed,
+        uint64_t                *words) {
+        uint32_t n_words = numWords(width);
+        uint32_t n_val_words;
+
+        if (val.bits() <= 64) {
+            words[0] = (is_signed)?
+                static_cast<uint64_t>(val.get_val_s()):val.get_val_u();
+            n_val_words = 1;
+        } else {
+            const uint64_t *vp = reinterpret_cast<const uint64_t *>(val.vp());
+            n_val_words = numWords(val.bits());
+            if (n_val_words > n_words) {
+                n_val_words = n_words;
+            }
+            for (uint32_t i=0; i<n_val_words; i++) {
+                words[i] = vp[i];
+            }
+        }
+
+        uint64_t ext = (is_signed && (words[n_val_words-1] >> 63))?~0ULL:0ULL;
+        for (uint32_t i=n_val_words; i<n_words; i++) {
+            words[i] = ext;
+        }
+
+        if (width%64) {
+            words[n_words-1] &= ((1ULL << (width%64)) - 1);
+        }
+    }
+
+    /**
+     * Writes the value from numWords(val.bits()) words
+     */
+    static void set(
+        dm::ValRefInt           &val,
+        const uint64_t          *words) {
+        if (val.bits() <= 64) {
+            val.set_val(words[0]);
+        } else {
+            uint64_t *vp = reinterpret_cast<uint64_t *>(val.vp());
+            uint32_t n_words = numWords(val.bits());
+            for (uint32_t i=0; i<n_words; i++) {
+                vp[i] = words[i];
+            }
+        }
+    }
+
+    /**
+     * Formats numWords(width) words as a binary string, MSB first
+     */
+    static std::string toBits(
+        uint32_t                width,
+        const uint64_t          *words) {
+        std::string bits(width, '0');
+        for (uint32_t i=0; i<width; i++) {
+            if ((words[i/64] >> (i%64)) & 1) {
+                bits[width-i-1] = '1';
+            }
+        }
+        return bits;
+    }
+
+    /**
+     * Parses a binary string, MSB first, into numWords(width) words
+     */
+    static void fromBits(
+        const char              *bits,
+        uint32_t                width,
+        uint64_t                *words) {
+        for (uint32_t i=0; i<numWords(width); i++) {
+            words[i] = 0;
+        }
+        for (uint32_t i=0; i<width; i++) {
+            if (bits[width-i-1] == '1') {
+                words[i/64] |= (1ULL << (i%64));
+            }
+        }
+    }
+
+};
+
+} /* namespace solvers */
+} /* namespace vsc */
+
+
@@ -7,10 +7,14 @@
 
 #pragma once
 #include <memory>
+#include <vector>
 #include "vsc/dm/IModelField.h"
 #include "vsc/dm/ITypeConstraint.h"
 #include "vsc/solvers/IRandState.h"
+#include "vsc/solvers/SolverBudget.h"
+#include "vsc/solvers/SolverStats.h"
 #include "vsc/solvers/impl/RefPathSet.h"
+#include "vsc/solvers/impl/RefPathSnapshot.h"
 
 namespace vsc {
 namespace solvers {
@@ -71,6 +75,44 @@ public:
             const RefPathSet                            &exclude_constraints,
 			SolveFlags								    flags) = 0;
 
+	/**
+	 * Equivalent to randomize() with path sets. Snapshots can be
+	 * shared across threads and cheaply derived from one another,
+	 * and plans are looked up by their precomputed hashes.
+	 */
+	virtual bool randomize(
+			IRandState								    *randstate,
+            dm::IModelField                             *root_field,
+            const RefPathSnapshot                       &target_fields,
+            const RefPathSnapshot                       &fixed_fields,
+            const RefPathSnapshot                       &include_constraints,
+            const RefPathSnapshot                       &exclude_constraints,
+			SolveFlags								    flags) = 0;
+
+	/**
+	 * Produces 'count' solutions with a single prepared plan and
+	 * set of solver instances. After each solution, the value of
+	 * each field in 'columns' is stored to 'data' in column-major
+	 * order: data[col*count + i] holds solution 'i' of column 'col'.
+	 * 'data' must hold columns.size()*count elements. Column fields
+	 * must be boolean, enum or integral, and no wider than 64 bits.
+	 * Booleans are stored as 0/1 and signed values sign-extended.
+	 * 'flags' are applied as for randomize(). Returns false if any
+	 * solution fails or a column isn't a scalar field, leaving the
+	 * failing row and all rows after it unspecified.
+	 */
+	virtual bool randomizeN(
+			IRandState								    *randstate,
+            dm::IModelField                             *root_field,
+            uint32_t                                    count,
+            const RefPathSet                            &target_fields,
+            const RefPathSet                            &fixed_fields,
+            const RefPathSet                            &include_constraints,
+            const RefPathSet                            &exclude_constraints,
+			SolveFlags								    flags,
+            const std::vector<std::vector<int32_t>>     &columns,
+            uint64_t                                    *data) = 0;
+
 	virtual bool sat(
             dm::IModelField                             *root_field,
             const RefPathSet                            &target_fields,
@@ -78,6 +120,44 @@ public:
             const RefPathSet                            &include_constraints,
             const RefPathSet                            &exclude_constraints,
 			SolveFlags								    flags) = 0;
+
+	/**
+	 * Sets the number of worker threads used to solve independent
+	 * solve sets. 0 (the default) solves on the calling thread.
+	 * When non-zero, each solve set uses a random state forked from
+	 * 'randstate', such that results don't depend on thread count.
+	 */
+	virtual void setNumThreads(uint32_t n_threads) = 0;
+
+	virtual uint32_t getNumThreads() const = 0;
+
+	/**
+	 * Sets the number of distinct solutions that backends harvest
+	 * per SAT session. Later randomize calls are served from the pool
+	 * until it is empty or the values of fixed fields change.
+	 * 0 (the default) disables pooling.
+	 */
+	virtual void setPoolSize(uint32_t size) = 0;
+
+	virtual uint32_t getPoolSize() const = 0;
+
+	/**
+	 * Sets the time budget of backend calls. When a solve set 
+	 * exceeds its budget, the budget's fallback is applied. If the
+	 * fallback doesn't produce a solution, randomization fails and
+	 * a diagnostic is reported. The default budget is unlimited.
+	 */
+	virtual void setBudget(const SolverBudget &budget) = 0;
+
+	virtual const SolverBudget &getBudget() const = 0;
+
+	/**
+	 * Returns the counters and latency histograms that this solver
+	 * collects. Collection is always enabled.
+	 */
+	virtual SolverStats &getStats() = 0;
+
+	virtual void resetStats() = 0;
 };
 
 }
@@ -39,6 +39,13 @@ public:
 
 	virtual IRandState *next() = 0;
 
+	/**
+	 * Returns an independent random state, seeded from a draw of
+	 * this one. Unlike next(), the sequence of the returned state 
+	 * doesn't overlap with that of this state or of other forks
+	 */
+	virtual IRandState *fork() = 0;
+
 };
 
 }
@@ -32,9 +32,27 @@ enum class SolveSetFlags {
     NonLinear = (1 << 1),
     Iterative = (1 << 2),
     ArraySize = (1 << 3),
-    Soft      = (1 << 4)
+    Soft      = (1 << 4),
+    // Single field, with constraints that only bound its value
+    Domain    = (1 << 5),
+    // Holds a field wider than 64 bits
+    Wide      = (1 << 6)
 };
 
+static inline SolveSetFlags operator | (const SolveSetFlags lhs, const SolveSetFlags rhs) {
+	return static_cast<SolveSetFlags>(
+			static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs));
+}
+
+static inline SolveSetFlags operator & (const SolveSetFlags lhs, const SolveSetFlags rhs) {
+	return static_cast<SolveSetFlags>(
+			static_cast<uint32_t>(lhs) & static_cast<uint32_t>(rhs));
+}
+
+static inline SolveSetFlags operator ~ (const SolveSetFlags lhs) {
+	return static_cast<SolveSetFlags>(~static_cast<uint32_t>(lhs));
+}
+
 enum class SolveSetFieldType {
     Target,
     NonTarget,
@@ -55,6 +73,11 @@ public:
 
     virtual const RefPathSet &getConstraints() const = 0;
 
+    /**
+     * Returns a relative estimate of the effort required to solve
+     */
+    virtual uint64_t getCost() const = 0;
+
 };
 
 } /* namespace solvers */
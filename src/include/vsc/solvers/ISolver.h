@@ -29,6 +29,9 @@
 #include "vsc/dm/IModelField.h"
 #include "vsc/solvers/IRandState.h"
 #include "vsc/solvers/ISolveSet.h"
+#include "vsc/solvers/SolverBudget.h"
+#include "vsc/solvers/SolverRace.h"
+#include "vsc/solvers/SolverStats.h"
 
 namespace vsc {
 namespace solvers {
@@ -44,13 +47,53 @@ public:
 
 	virtual ~ISolver() { }
 
-    virtual bool randomize(
+    /**
+     * Produces a solution for the solve set, and writes the values
+     * of its target fields. Target fields are unmodified unless the
+     * result is Sat
+     */
+    virtual SolverResult randomize(
         IRandState                              *randstate,
         dm::IModelField                         *root_field,
         ISolveSet                               *solveset
     ) = 0;
 
-//    virtual bool sat() = 0;
+    /**
+     * Checks satisfiability of the solve set with the current
+     * values of its fixed fields. Field values are not modified.
+     * A check that exceeds its budget returns Timeout
+     */
+    virtual SolverResult sat(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset
+    ) = 0;
+
+    /**
+     * Sets the statistics object that the solver records to.
+     * Backends that don't collect statistics may ignore it
+     */
+    virtual void setStats(SolverStats *stats) { }
+
+    /**
+     * Sets the number of solutions to harvest per SAT session.
+     * Backends that don't support pooling may ignore it
+     */
+    virtual void setPoolSize(uint32_t size) { }
+
+    /**
+     * Sets the time budget of backend calls. Backends that can't
+     * be interrupted ignore it
+     */
+    virtual void setBudget(const SolverBudget &budget) { }
+
+    /**
+     * Enters the solver in a race as racer 'id'. While a race is set,
+     * the solver only writes field values after claiming the race, and
+     * abandons solving once another racer has claimed it. A null race
+     * returns the solver to normal operation. Backends that can't be
+     * cancelled ignore it, and must not be used in a portfolio
+     */
+    virtual void setRace(SolverRace *race, int32_t id) { }
 
 };
 
@@ -46,6 +46,12 @@ public:
 
     virtual ISolver *mkSolver(ISolveSet *solve_set) = 0;
 
+    /**
+     * Notifies the factory that 'solve_set' is about to be deleted,
+     * such that state derived from it can be released
+     */
+    virtual void releaseSolveSet(ISolveSet *solve_set) { }
+
 };
 
 }
@@ -0,0 +1,67 @@
+/**
+ * SolverBudget.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <stdint.h>
+
+namespace vsc {
+namespace solvers {
+
+enum class SolverResult {
+    Sat,
+    Unsat,
+    Timeout,        // The solve exceeded its budget. Satisfiability is unknown
+    Unsupported     // The backend can't lower the solve set. Satisfiability is unknown
+};
+
+enum class SolverFallback {
+    Fail,           // Report the timeout
+    Previous,       // Re-use the previous solution if fixed-field values are unchanged
+    Engine          // Re-solve with a cheaper engine
+};
+
+/**
+ * Limits applied to backend solver calls. A limit of 0 is
+ * unlimited. 'call_ms' bounds a single backend call, while 
+ * 'solveset_ms' bounds all backend calls made to produce one
+ * solution of a solve set. 'conflicts' bounds the SAT conflicts 
+ * of a single backend call, and is only enforced by Boolector.
+ * 'fallback' selects what happens when a limit is reached.
+ */
+struct SolverBudget {
+    uint32_t                call_ms;
+    uint32_t                solveset_ms;
+    SolverFallback          fallback;
+    uint32_t                conflicts;
+
+    SolverBudget(
+        uint32_t            call_ms=0,
+        uint32_t            solveset_ms=0,
+        SolverFallback      fallback=SolverFallback::Fail,
+        uint32_t            conflicts=0) :
+            call_ms(call_ms), solveset_ms(solveset_ms), fallback(fallback),
+            conflicts(conflicts) { }
+
+    bool limited() const { return (call_ms || solveset_ms || conflicts); }
+};
+
+}
+}
+
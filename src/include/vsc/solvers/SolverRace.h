@@ -0,0 +1,60 @@
+/**
+ * SolverRace.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * Coordinates backend solvers racing on the same solve set. The
+ * first racer to reach a SAT/UNSAT answer claims the race, and is 
+ * the only one that may write field values. Losers poll done() from
+ * their backend's termination callback, such that they stop early.
+ */
+class SolverRace {
+public:
+    SolverRace() : m_winner(-1) { }
+
+    /**
+     * Attempts to claim the race for racer 'id'. Returns true if
+     * 'id' is (or already was) the winner
+     */
+    bool claim(int32_t id) {
+        int32_t expected = -1;
+        return (m_winner.compare_exchange_strong(expected, id) ||
+            expected == id);
+    }
+
+    bool done() const { return (m_winner.load() != -1); }
+
+    int32_t getWinner() const { return m_winner.load(); }
+
+private:
+    std::atomic<int32_t>            m_winner;
+
+};
+
+}
+}
+
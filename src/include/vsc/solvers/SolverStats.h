@@ -0,0 +1,309 @@
+/**
+ * SolverStats.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace vsc {
+namespace solvers {
+
+class ISolveSet;
+
+enum class SolverStatsPhase {
+    Partition,      // Splitting a root type into solve sets (plan-cache misses)
+    Build,          // Building and asserting the backend formula
+    Solve,          // Backend satisfiability calls
+    Readback,       // Writing solved values back to fields
+    Randomize,      // Producing one solution, after plan lookup
+    Sat,            // Complete ICompoundSolver::sat calls
+    NumPhases
+};
+
+enum class SolverStatsCounter {
+    PlanHit,
+    PlanMiss,
+    SolverHit,
+    SolverMiss,
+    Unsat,
+    SwizzleRetry,   // Extra backend calls after randomization preferences conflict
+    PoolHit,        // Solutions served from a solution pool
+    Timeout,        // Backend solves that exceeded their budget
+    Fallback,       // Timed-out solves answered by a fallback
+    TemplateClone,  // Backend instances cloned from a compiled formula
+    NumCounters
+};
+
+/**
+ * Latency histogram with log2-spaced nanosecond buckets. Recording
+ * is lock-free, such that it is safe to record from worker threads.
+ * Percentiles are reported as the upper bound of the bucket holding
+ * the requested sample, so they are accurate to within a factor of 2.
+ */
+class SolverStatsHist {
+public:
+    static const uint32_t NumBuckets = 65;
+
+    SolverStatsHist() { reset(); }
+
+    void record(uint64_t ns) {
+        m_buckets[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_total.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t max = m_max.load(std::memory_order_relaxed);
+        while (ns > max && !m_max.compare_exchange_weak(
+            max, ns, std::memory_order_relaxed)) { }
+    }
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+
+    uint64_t total() const { return m_total.load(std::memory_order_relaxed); }
+
+    uint64_t max() const { return m_max.load(std::memory_order_relaxed); }
+
+    uint64_t mean() const {
+        uint64_t n = count();
+        return (n)?(total()/n):0;
+    }
+
+    /**
+     * Returns the upper bound (ns) of the bucket holding the
+     * sample at fraction 'p' (0.0-1.0) of recorded samples
+     */
+    uint64_t percentile(double p) const {
+        uint64_t n = count();
+        if (!n) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(p * n + 0.5);
+        if (!rank) {
+            rank = 1;
+        }
+        uint64_t cumulative = 0;
+        for (uint32_t i=0; i<NumBuckets; i++) {
+            cumulative += m_buckets[i].load(std::memory_order_relaxed);
+            if (cumulative >= rank) {
+                return upper(i);
+            }
+        }
+        return max();
+    }
+
+    uint64_t p50() const { return percentile(0.50); }
+
+    uint64_t p99() const { return percentile(0.99); }
+
+    void reset() {
+        for (uint32_t i=0; i<NumBuckets; i++) {
+            m_buckets[i].store(0, std::memory_order_relaxed);
+        }
+        m_count.store(0, std::memory_order_relaxed);
+        m_total.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static uint32_t bucket(uint64_t ns) {
+        uint32_t b = 0;
+        while (ns) {
+            ns >>= 1;
+            b++;
+        }
+        return b;
+    }
+
+    static uint64_t upper(uint32_t b) {
+        return (b >= 64)?UINT64_MAX:((uint64_t(1) << b) - 1);
+    }
+
+private:
+    std::atomic<uint64_t>           m_buckets[NumBuckets];
+    std::atomic<uint64_t>           m_count;
+    std::atomic<uint64_t>           m_total;
+    std::atomic<uint64_t>           m_max;
+};
+
+/**
+ * Scoped timer that records its lifetime to a histogram. A null
+ * histogram disables timing.
+ */
+class SolverStatsTimer {
+public:
+    SolverStatsTimer(SolverStatsHist *hist) : m_hist(hist) {
+        if (m_hist) {
+            m_start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~SolverStatsTimer() {
+        if (m_hist) {
+            m_hist->record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - m_start).count());
+        }
+    }
+
+private:
+    SolverStatsHist                                 *m_hist;
+    std::chrono::steady_clock::time_point           m_start;
+};
+
+/**
+ * Per-solve-set statistics. 'solve' covers a complete backend
+ * randomize or sat call on the solve set.
+ */
+struct SolverStatsSolveSet {
+    uint32_t                        n_fields;
+    uint32_t                        n_constraints;
+    uint64_t                        cost;
+    SolverStatsHist                 solve;
+};
+
+/**
+ * Always-on counters and latency histograms for a compound solver,
+ * broken down by phase, by backend, and by solve set. Backend and
+ * solve-set entries are created on first use, and are never removed
+ * by reset(), so references to them remain valid.
+ */
+class SolverStats {
+public:
+
+    SolverStats() {
+        reset();
+    }
+
+    SolverStatsHist &getPhase(SolverStatsPhase phase) {
+        return m_phases[static_cast<uint32_t>(phase)];
+    }
+
+    const SolverStatsHist &getPhase(SolverStatsPhase phase) const {
+        return m_phases[static_cast<uint32_t>(phase)];
+    }
+
+    void inc(SolverStatsCounter c) {
+        m_counters[static_cast<uint32_t>(c)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t getCount(SolverStatsCounter c) const {
+        return m_counters[static_cast<uint32_t>(c)].load(std::memory_order_relaxed);
+    }
+
+    SolverStatsHist &getBackend(const std::string &name) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (uint32_t i=0; i<m_backends.size(); i++) {
+            if (m_backends.at(i).first == name) {
+                return *m_backends.at(i).second;
+            }
+        }
+        m_backends.push_back({name, SolverStatsHistUP(new SolverStatsHist())});
+        return *m_backends.back().second;
+    }
+
+    uint32_t getNumBackends() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_backends.size();
+    }
+
+    const std::string &getBackendName(uint32_t i) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_backends.at(i).first;
+    }
+
+    const SolverStatsHist &getBackendAt(uint32_t i) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return *m_backends.at(i).second;
+    }
+
+    SolverStatsSolveSet &getSolveSet(
+            ISolveSet           *solveset,
+            uint32_t            n_fields,
+            uint32_t            n_constraints,
+            uint64_t            cost) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::map<ISolveSet *, uint32_t>::const_iterator it =
+            m_solveset_m.find(solveset);
+        if (it != m_solveset_m.end()) {
+            return *m_solvesets.at(it->second);
+        }
+        SolverStatsSolveSet *ss = new SolverStatsSolveSet();
+        ss->n_fields = n_fields;
+        ss->n_constraints = n_constraints;
+        ss->cost = cost;
+        m_solveset_m.insert({solveset, m_solvesets.size()});
+        m_solvesets.push_back(std::unique_ptr<SolverStatsSolveSet>(ss));
+        return *ss;
+    }
+
+    /**
+     * Detaches 'solveset' from its entry before the solve set is
+     * deleted. The entry itself is retained for reporting
+     */
+    void releaseSolveSet(ISolveSet *solveset) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_solveset_m.erase(solveset);
+    }
+
+    uint32_t getNumSolveSets() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_solvesets.size();
+    }
+
+    const SolverStatsSolveSet &getSolveSetAt(uint32_t i) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return *m_solvesets.at(i);
+    }
+
+    void reset() {
+        for (uint32_t i=0; i<static_cast<uint32_t>(SolverStatsPhase::NumPhases); i++) {
+            m_phases[i].reset();
+        }
+        for (uint32_t i=0; i<static_cast<uint32_t>(SolverStatsCounter::NumCounters); i++) {
+            m_counters[i].store(0, std::memory_order_relaxed);
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (uint32_t i=0; i<m_backends.size(); i++) {
+            m_backends.at(i).second->reset();
+        }
+        for (uint32_t i=0; i<m_solvesets.size(); i++) {
+            m_solvesets.at(i)->solve.reset();
+        }
+    }
+
+private:
+    using SolverStatsHistUP=std::unique_ptr<SolverStatsHist>;
+
+private:
+    SolverStatsHist                 m_phases[static_cast<uint32_t>(SolverStatsPhase::NumPhases)];
+    std::atomic<uint64_t>           m_counters[static_cast<uint32_t>(SolverStatsCounter::NumCounters)];
+    mutable std::mutex              m_mutex;
+    std::vector<std::pair<std::string, SolverStatsHistUP>>     m_backends;
+    std::vector<std::unique_ptr<SolverStatsSolveSet>>          m_solvesets;
+    std::map<ISolveSet *, uint32_t>                            m_solveset_m;
+
+};
+
+}
+}
+
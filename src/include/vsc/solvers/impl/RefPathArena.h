@@ -0,0 +1,135 @@
+/**
+ * RefPathArena.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * Bump allocator for the nodes of path tries. Individual allocations
+ * are never freed. Instead, all memory is released when the arena is
+ * deleted, and reset() rewinds the arena while retaining its blocks
+ * such that re-populating a trie of similar size allocates nothing.
+ */
+class RefPathArena;
+using RefPathArenaUP=std::unique_ptr<RefPathArena>;
+class RefPathArena {
+public:
+    static const uint32_t DefaultBlockSize = 1024;
+    static const uint32_t MaxBlockSize = 65536;
+
+    RefPathArena(uint32_t block_sz=DefaultBlockSize) :
+        m_block_sz(block_sz), m_idx(0), m_off(0), m_used(0) { }
+
+    virtual ~RefPathArena() {
+        for (std::vector<Block>::const_iterator
+            it=m_blocks.begin();
+            it!=m_blocks.end(); it++) {
+            ::operator delete(it->base);
+        }
+    }
+
+    RefPathArena(const RefPathArena &) = delete;
+    RefPathArena &operator =(const RefPathArena &) = delete;
+
+    void *alloc(size_t sz) {
+        sz = (sz + Align - 1) & ~(Align - 1);
+        m_used += sz;
+
+        // Re-use blocks retained by reset() before adding more
+        while (m_idx < m_blocks.size()) {
+            Block &b = m_blocks[m_idx];
+            if (m_off + sz <= b.sz) {
+                void *ret = b.base + m_off;
+                m_off += sz;
+                return ret;
+            }
+            m_idx++;
+            m_off = 0;
+        }
+
+        size_t block_sz = (sz > m_block_sz)?sz:m_block_sz;
+        if (m_block_sz < MaxBlockSize) {
+            m_block_sz *= 2;
+        }
+        Block b;
+        b.base = reinterpret_cast<uint8_t *>(::operator new(block_sz));
+        b.sz = block_sz;
+        m_blocks.push_back(b);
+        m_idx = m_blocks.size()-1;
+        m_off = sz;
+
+        return b.base;
+    }
+
+    /**
+     * Invalidates all allocations. Blocks are retained for re-use
+     */
+    void reset() {
+        m_idx = 0;
+        m_off = 0;
+        m_used = 0;
+    }
+
+    /**
+     * Returns the number of bytes allocated since the last reset
+     */
+    size_t used() const { return m_used; }
+
+    /**
+     * Returns the number of bytes held by the arena
+     */
+    size_t capacity() const {
+        size_t ret = 0;
+        for (std::vector<Block>::const_iterator
+            it=m_blocks.begin();
+            it!=m_blocks.end(); it++) {
+            ret += it->sz;
+        }
+        return ret;
+    }
+
+private:
+    static const size_t Align = sizeof(void *);
+
+    struct Block {
+        uint8_t         *base;
+        size_t          sz;
+    };
+
+private:
+    size_t                  m_block_sz;
+    uint32_t                m_idx;
+    size_t                  m_off;
+    size_t                  m_used;
+    std::vector<Block>      m_blocks;
+
+};
+
+}
+}
+
+
@@ -19,8 +19,11 @@
  *     Author: 
  */
 #pragma once
+#include <assert.h>
 #include <stdint.h>
+#include <string.h>
 #include <vector>
+#include "vsc/solvers/impl/RefPathArena.h"
 
 namespace vsc {
 namespace solvers {
@@ -28,6 +31,10 @@ namespace solvers {
 
 
 template <class T> class RefPathMap {
+public:
+    // Maximum number of elements in a path
+    static const uint32_t MaxDepth = 64;
+
 public:
 /*
     struct const_iterator {
@@ -38,17 +45,46 @@ public:
 
 
 public:
-    RefPathMap(int sz=2) : m_root(allocNonLeaf(sz)), m_size(0) { }
+    RefPathMap(int sz=2, RefPathArena *arena=0) : m_root_sz(sz), m_size(0) {
+        if (arena) {
+            m_arena = arena;
+        } else {
+            m_arena_u = RefPathArenaUP(new RefPathArena());
+            m_arena = m_arena_u.get();
+        }
+        m_root = allocNonLeaf(m_root_sz);
+    }
 
     virtual ~RefPathMap() {}
 
+    RefPathMap(const RefPathMap &) = delete;
+    RefPathMap &operator =(const RefPathMap &) = delete;
+
+    /**
+     * Removes all entries. When the map owns its arena, memory is
+     * retained for re-use rather than being returned to the heap.
+     */
+    void reset() {
+        if (m_arena_u) {
+            m_arena->reset();
+        }
+        m_root = allocNonLeaf(m_root_sz);
+        m_size = 0;
+    }
+
     int32_t size() const { return m_size; }
 
 
+    /**
+     * Adds 'path', returning false if it is already present and 
+     * 'overwrite' is not set. Paths may be at most MaxDepth elements long
+     */
     bool add(
         const std::vector<int32_t>  &path,
         const T                     &data,
         bool                        overwrite=false) {
+        assert(path.size() <= MaxDepth);
+
         LeafNode *node = findLeaf(path, true);
 
         if (!node->leaves[path.back()].valid || overwrite) {
@@ -99,84 +135,98 @@ private:
     };
 
 public:
+    /**
+     * Cursor over the entries in the map. The node stack and path are
+     * fixed-size arrays, as in forEach(), so neither construction nor
+     * next() allocates. path() copies the current path into a vector
+     * whose capacity is retained across calls.
+     */
     struct iterator {
-        iterator(NonLeafNode *root) {
-            m_node_s.push_back(&root->base);
-            m_path.push_back(-1);
+        iterator(NonLeafNode *root) : m_depth(1) {
+            m_node_s[0] = &root->base;
+            m_path[0] = -1;
         }
         iterator(const iterator &rhs) :
-            m_node_s(rhs.m_node_s.begin(), rhs.m_node_s.end()),
-            m_path(rhs.m_path.begin(), rhs.m_path.end()),
-            m_value(rhs.m_value) { }
+            m_value(rhs.m_value), m_depth(rhs.m_depth) {
+            memcpy(m_node_s, rhs.m_node_s, m_depth*sizeof(Node *));
+            memcpy(m_path, rhs.m_path, m_depth*sizeof(int32_t));
+        }
         void operator =(const iterator &rhs) {
-            m_node_s.clear();
-            m_node_s.insert(m_node_s.begin(), 
-                rhs.m_node_s.begin(), rhs.m_node_s.end());
-            m_path.clear();
-            m_path.insert(m_path.begin(), rhs.m_path.begin(), rhs.m_path.end());
+            m_depth = rhs.m_depth;
+            memcpy(m_node_s, rhs.m_node_s, m_depth*sizeof(Node *));
+            memcpy(m_path, rhs.m_path, m_depth*sizeof(int32_t));
+            m_value = rhs.m_value;
         }
 
-        std::vector<int32_t>                    m_path;
         T                                       m_value;
-        std::vector<Node *>                     m_node_s;
-
+        Node                                    *m_node_s[MaxDepth];
+        int32_t                                 m_path[MaxDepth];
+        uint32_t                                m_depth;
+        mutable std::vector<int32_t>            m_path_v;
+
+        /**
+         * Returns the current path. The reference is only refreshed by
+         * calls to path(), so must not be held across next()
+         */
         const std::vector<int32_t> &path() const {
-            return m_path;
+            m_path_v.assign(m_path, m_path+m_depth);
+            return m_path_v;
         }
 
+        const int32_t *data() const { return m_path; }
+
+        uint32_t depth() const { return m_depth; }
+
         T value() const {
             return m_value;
         }
 
         bool next() {
             bool found = false;
-            while (m_node_s.size()) {
+            while (m_depth) {
+                int32_t &idx = m_path[m_depth-1];
                 // If we're at leaf level, see if there's more for us
-                if (m_node_s.back()->isLeaf) {
-                    LeafNode *leaf = reinterpret_cast<LeafNode *>(m_node_s.back());
-                    m_path.back()++;
-                    while (m_path.back() < leaf->base.sz) {
-                        if (leaf->leaves[m_path.back()].valid) {
+                if (m_node_s[m_depth-1]->isLeaf) {
+                    LeafNode *leaf = reinterpret_cast<LeafNode *>(m_node_s[m_depth-1]);
+                    idx++;
+                    while (idx < leaf->base.sz) {
+                        if (leaf->leaves[idx].valid) {
                             found = true;
-                            m_value = leaf->leaves[m_path.back()].value;
+                            m_value = leaf->leaves[idx].value;
                             break;
                         } else {
-                            m_path.back()++;
+                            idx++;
                         }
                     }
 
                     if (!found) {
-                        m_node_s.pop_back();
-                        m_path.pop_back();
+                        m_depth--;
                     }
                 } else {
-                    NonLeafNode *nleaf = reinterpret_cast<NonLeafNode *>(m_node_s.back());
+                    NonLeafNode *nleaf = reinterpret_cast<NonLeafNode *>(m_node_s[m_depth-1]);
                     bool have_subnode = false;
 
-                    m_path.back()++;
-                    while (m_path.back() < nleaf->base.sz) {
-                        if (nleaf->nodes[m_path.back()]) {
-                            m_node_s.push_back(nleaf->nodes[m_path.back()]);
-                            m_path.push_back(-1);
+                    idx++;
+                    while (idx < nleaf->base.sz) {
+                        if (nleaf->nodes[idx]) {
+                            m_node_s[m_depth] = nleaf->nodes[idx];
+                            m_path[m_depth++] = -1;
                             have_subnode = true;
                             break;
                         } else {
-                            m_path.back()++;
+                            idx++;
                         }
                     }
 
                     if (!have_subnode) {
                         if (nleaf->leafNode) {
                             // Replace the compound node with a leaf node
-                            m_node_s.pop_back();
-                            m_path.pop_back();
-                            m_node_s.push_back(&nleaf->leafNode->base);
-                            m_path.push_back(-1);
+                            m_node_s[m_depth-1] = &nleaf->leafNode->base;
+                            idx = -1;
                         } else {
                             // Nothing more to do in the compound node, so
                             // move back up the stack
-                            m_node_s.pop_back();
-                            m_path.pop_back();
+                            m_depth--;
                         }
                     }
                 }
@@ -193,6 +243,52 @@ public:
         return iterator(m_root);
     }
 
+    /**
+     * Calls f(path, depth, value) for each entry, in iterator order.
+     * 'path' points to 'depth' elements, and is only valid during the
+     * call. Traversal state is held on the stack, so nothing is allocated.
+     */
+    template <class F> void forEach(const F &f) const {
+        const Node *node_s[MaxDepth];
+        int32_t path[MaxDepth];
+        uint32_t depth = 1;
+
+        node_s[0] = &m_root->base;
+        path[0] = -1;
+        while (depth) {
+            if (node_s[depth-1]->isLeaf) {
+                const LeafNode *leaf = reinterpret_cast<const LeafNode *>(node_s[depth-1]);
+                for (uint32_t i=0; i<leaf->base.sz; i++) {
+                    if (leaf->leaves[i].valid) {
+                        path[depth-1] = i;
+                        f(path, depth, leaf->leaves[i].value);
+                    }
+                }
+                depth--;
+            } else {
+                const NonLeafNode *nleaf = reinterpret_cast<const NonLeafNode *>(node_s[depth-1]);
+                int32_t &idx = path[depth-1];
+
+                idx++;
+                while (static_cast<uint32_t>(idx) < nleaf->base.sz && !nleaf->nodes[idx]) {
+                    idx++;
+                }
+
+                if (static_cast<uint32_t>(idx) < nleaf->base.sz) {
+                    node_s[depth] = nleaf->nodes[idx];
+                    path[depth] = -1;
+                    depth++;
+                } else if (nleaf->leafNode) {
+                    // Sub-trees are visited before entries ending here
+                    node_s[depth-1] = &nleaf->leafNode->base;
+                    idx = -1;
+                } else {
+                    depth--;
+                }
+            }
+        }
+    }
+
 private:
 
     LeafNode *findLeaf(
@@ -292,7 +388,7 @@ private:
     NonLeafNode *allocNonLeaf(uint32_t max) {
         uint32_t max_t = pow2(max);
 
-        NonLeafNode *node = reinterpret_cast<NonLeafNode *>(::operator new(
+        NonLeafNode *node = reinterpret_cast<NonLeafNode *>(m_arena->alloc(
             sizeof(NonLeafNode) + ((max_t)*sizeof(Node *))
         ));
 
@@ -306,7 +402,7 @@ private:
     LeafNode *allocLeaf(uint32_t max) {
         uint32_t max_t = pow2(max);
 
-        LeafNode *node = reinterpret_cast<LeafNode *>(::operator new(
+        LeafNode *node = reinterpret_cast<LeafNode *>(m_arena->alloc(
             sizeof(LeafNode)+((max_t)*sizeof(Value))
         ));
 
@@ -320,7 +416,7 @@ private:
     NonLeafNode *reallocNonLeaf(NonLeafNode *node, uint32_t max) {
         uint32_t max_t = pow2(max);
 
-        NonLeafNode *nnode = reinterpret_cast<NonLeafNode *>(::operator new(
+        NonLeafNode *nnode = reinterpret_cast<NonLeafNode *>(m_arena->alloc(
             sizeof(NonLeafNode) + ((max_t)*sizeof(Node *))
         ));
 
@@ -335,7 +431,7 @@ private:
         }
         nnode->base.sz = max_t+1;
 
-        ::operator delete(node);
+        // The superseded node is reclaimed along with the arena
 
         return nnode;
     }
@@ -343,7 +439,7 @@ private:
     LeafNode *reallocLeaf(LeafNode *node, uint32_t max) {
         uint32_t max_t = pow2(max);
 
-        LeafNode *nnode = reinterpret_cast<LeafNode *>(::operator new(
+        LeafNode *nnode = reinterpret_cast<LeafNode *>(m_arena->alloc(
             sizeof(LeafNode)+((max_t)*sizeof(Value))
         ));
 
@@ -357,13 +453,16 @@ private:
             nnode->leaves[i].valid = false;
         }
 
-        ::operator delete(node);
+        // The superseded node is reclaimed along with the arena
 
         return nnode;
     }
 
 
 private:
+    RefPathArenaUP  m_arena_u;
+    RefPathArena    *m_arena;
+    uint32_t        m_root_sz;
     NonLeafNode     *m_root;
     int32_t         m_size;
 
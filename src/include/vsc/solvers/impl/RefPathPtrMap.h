@@ -21,6 +21,7 @@
 #pragma once
 #include <stdint.h>
 #include <vector>
+#include "vsc/solvers/impl/RefPathArena.h"
 
 namespace vsc {
 namespace solvers {
@@ -50,10 +51,32 @@ public:
     };
  */
 public:
-    RefPathPtrMap(int sz=2) : m_root(allocNonLeaf(sz)) { }
+    RefPathPtrMap(int sz=2, RefPathArena *arena=0) : m_root_sz(sz) {
+        if (arena) {
+            m_arena = arena;
+        } else {
+            m_arena_u = RefPathArenaUP(new RefPathArena());
+            m_arena = m_arena_u.get();
+        }
+        m_root = allocNonLeaf(m_root_sz);
+    }
 
     virtual ~RefPathPtrMap() {}
 
+    RefPathPtrMap(const RefPathPtrMap &) = delete;
+    RefPathPtrMap &operator =(const RefPathPtrMap &) = delete;
+
+    /**
+     * Removes all entries. When the map owns its arena, memory is
+     * retained for re-use rather than being returned to the heap.
+     */
+    void reset() {
+        if (m_arena_u) {
+            m_arena->reset();
+        }
+        m_root = allocNonLeaf(m_root_sz);
+    }
+
     bool add(
         const std::vector<int32_t>  &path,
         T                           *data) {
@@ -242,7 +265,7 @@ private:
     NonLeafNode *allocNonLeaf(uint32_t max) {
         uint32_t max_t = pow2(max);
 
-        NonLeafNode *node = reinterpret_cast<NonLeafNode *>(::operator new(
+        NonLeafNode *node = reinterpret_cast<NonLeafNode *>(m_arena->alloc(
             sizeof(NonLeafNode) + ((max_t-1)*sizeof(Node *))
         ));
 
@@ -256,7 +279,7 @@ private:
     LeafNode *allocLeaf(uint32_t max) {
         uint32_t max_t = pow2(max);
 
-        LeafNode *node = reinterpret_cast<LeafNode *>(::operator new(
+        LeafNode *node = reinterpret_cast<LeafNode *>(m_arena->alloc(
             sizeof(LeafNode)+((max_t)*sizeof(T *))
         ));
 
@@ -270,7 +293,7 @@ private:
     NonLeafNode *reallocNonLeaf(NonLeafNode *node, uint32_t max) {
         uint32_t max_t = pow2(max);
 
-        NonLeafNode *nnode = reinterpret_cast<NonLeafNode *>(::operator new(
+        NonLeafNode *nnode = reinterpret_cast<NonLeafNode *>(m_arena->alloc(
             sizeof(NonLeafNode) + ((max_t)*sizeof(Node *))
         ));
 
@@ -285,7 +308,7 @@ private:
             nnode->nodes[i] = 0;
         }
 
-        ::operator delete(node);
+        // The superseded node is reclaimed along with the arena
 
         return nnode;
     }
@@ -293,7 +316,7 @@ private:
     LeafNode *reallocLeaf(LeafNode *node, uint32_t max) {
         uint32_t max_t = pow2(max);
 
-        LeafNode *nnode = reinterpret_cast<LeafNode *>(::operator new(
+        LeafNode *nnode = reinterpret_cast<LeafNode *>(m_arena->alloc(
             sizeof(LeafNode)+((max_t)*sizeof(T *))
         ));
 
@@ -307,13 +330,16 @@ private:
             nnode->leaves[i] = 0;
         }
 
-        ::operator delete(node);
+        // The superseded node is reclaimed along with the arena
 
         return nnode;
     }
 
 
 private:
+    RefPathArenaUP  m_arena_u;
+    RefPathArena    *m_arena;
+    uint32_t        m_root_sz;
     NonLeafNode     *m_root;
 
 };
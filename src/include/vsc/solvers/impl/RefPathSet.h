@@ -19,29 +19,65 @@
  *     Author: 
  */
 #pragma once
+#include <assert.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "vsc/solvers/impl/RefPathArena.h"
 
 namespace vsc {
 namespace solvers {
 
 
 
+/**
+ * Set of reference paths, stored as a trie. Nodes are allocated from
+ * an arena, which is either owned by the set or supplied by the caller.
+ * When the arena is shared, nodes are released along with the arena.
+ * An owned arena and the root node are only created by the first add,
+ * so empty temporary sets don't touch the heap.
+ */
 class RefPathSet {
 public:
+    // Maximum number of elements in a path
+    static const uint32_t MaxDepth = 64;
+
 public:
-    RefPathSet() : m_size(0) {
-        m_root = allocNonLeaf(8);
-    }
+    RefPathSet(RefPathArena *arena=0) : 
+        m_arena(arena), m_root(emptyRoot()), m_size(0) { }
 
     virtual ~RefPathSet() {
 
     }
 
+    RefPathSet(const RefPathSet &) = delete;
+    RefPathSet &operator =(const RefPathSet &) = delete;
+
+    /**
+     * Removes all paths. When the set owns its arena, memory is
+     * retained for re-use rather than being returned to the heap.
+     */
+    void reset() {
+        if (m_arena_u) {
+            m_arena->reset();
+        }
+        m_root = emptyRoot();
+        m_size = 0;
+    }
+
+    /**
+     * Adds 'path', returning false if it is already present. Paths 
+     * may be at most MaxDepth elements long
+     */
     bool add(const std::vector<int32_t> &path) {
         bool ret = true;
+
+        assert(path.size() <= MaxDepth);
+        ensureRoot();
         Node    **npp = reinterpret_cast<Node **>(&m_root);
 
         for (std::vector<int32_t>::const_iterator 
@@ -122,7 +158,7 @@ public:
         return ret;
     }
 
-    bool remove(const std::vector<int32_t> &path) const {
+    bool remove(const std::vector<int32_t> &path) {
         Node *n = &m_root->base;
         for (std::vector<int32_t>::const_iterator
             it=path.begin();
@@ -138,7 +174,9 @@ public:
                     uint32_t idx = *it/(8*sizeof(uintptr_t));
                     uint32_t off = *it % (8*sizeof(uintptr_t));
                     if (idx < leaf->base.sz && (leaf->leaves[idx]&(1ULL << off))) {
-                        leaf->leaves[idx] &= (1ULL << off);
+                        leaf->leaves[idx] &= ~(1ULL << off);
+                        m_size--;
+                        return true;
                     } else {
                         break;
                     }
@@ -204,6 +242,75 @@ public:
         return false;
     }
 
+    /**
+     * Adds all paths in 'rhs'
+     */
+    void unionWith(const RefPathSet &rhs) {
+        if (rhs.m_root == emptyRoot()) {
+            return;
+        }
+        ensureRoot();
+        unionNode(reinterpret_cast<Node **>(&m_root), &rhs.m_root->base);
+        m_size = count(&m_root->base);
+    }
+
+    /**
+     * Removes all paths not in 'rhs'
+     */
+    void intersectWith(const RefPathSet &rhs) {
+        intersectNode(&m_root->base, &rhs.m_root->base);
+        m_size = count(&m_root->base);
+    }
+
+    /**
+     * Removes all paths in 'rhs'
+     */
+    void subtract(const RefPathSet &rhs) {
+        subtractNode(&m_root->base, &rhs.m_root->base);
+        m_size = count(&m_root->base);
+    }
+
+    /**
+     * Replaces the content of this set with the union of 'a' and 'b'.
+     * Neither operand may be this set
+     */
+    void setUnion(const RefPathSet &a, const RefPathSet &b) {
+        reset();
+        unionWith(a);
+        unionWith(b);
+    }
+
+    /**
+     * Replaces the content of this set with the intersection of 'a' 
+     * and 'b'. Neither operand may be this set
+     */
+    void setIntersection(const RefPathSet &a, const RefPathSet &b) {
+        reset();
+        unionWith(a);
+        intersectWith(b);
+    }
+
+    /**
+     * Replaces the content of this set with the paths in 'a' that 
+     * are not in 'b'. Neither operand may be this set
+     */
+    void setDifference(const RefPathSet &a, const RefPathSet &b) {
+        reset();
+        unionWith(a);
+        subtract(b);
+    }
+
+    bool isSubsetOf(const RefPathSet &rhs) const {
+        return (m_size <= rhs.m_size) && subsetNode(&m_root->base, &rhs.m_root->base);
+    }
+
+    /**
+     * Returns the number of paths, counted from the leaf bitmaps
+     */
+    int32_t popcount() const {
+        return count(&m_root->base);
+    }
+
 private:
 
     struct Node {
@@ -223,6 +330,29 @@ private:
     };
 
 private:
+    /**
+     * Returns the root shared by all empty sets. It has no slots, so
+     * lookups and traversals end immediately and it is never written
+     */
+    static NonLeafNode *emptyRoot() {
+        static NonLeafNode root = {{false, 0}, 0, {0}};
+        return &root;
+    }
+
+    void ensureRoot() {
+        if (m_root == emptyRoot()) {
+            m_root = allocNonLeaf(8);
+        }
+    }
+
+    RefPathArena *arena() {
+        if (!m_arena) {
+            m_arena_u = RefPathArenaUP(new RefPathArena());
+            m_arena = m_arena_u.get();
+        }
+        return m_arena;
+    }
+
     bool empty(Node *n) const {
         if (n->isLeaf) {
             LeafNode *leaf = reinterpret_cast<LeafNode *>(n);
@@ -250,77 +380,357 @@ private:
         return true;
     }
 
+private:
+    // Bulk operations walk both tries in lockstep, combining the
+    // bitmaps of corresponding leaves a word (or vector) at a time
+
+    static const LeafNode *leafOf(const Node *n) {
+        return (n->isLeaf)?
+            reinterpret_cast<const LeafNode *>(n):
+            reinterpret_cast<const NonLeafNode *>(n)->leafNode;
+    }
+
+    void unionNode(Node **dst, const Node *src) {
+        if (src->isLeaf) {
+            LeafNode **leaf_np;
+            if ((*dst)->isLeaf) {
+                leaf_np = reinterpret_cast<LeafNode **>(dst);
+            } else {
+                leaf_np = &reinterpret_cast<NonLeafNode *>(*dst)->leafNode;
+                if (!*leaf_np) {
+                    *leaf_np = allocLeaf(src->sz);
+                }
+            }
+            if ((*leaf_np)->base.sz < src->sz) {
+                *leaf_np = reallocLeaf(*leaf_np, src->sz);
+            }
+            wordsOr((*leaf_np)->leaves, 
+                reinterpret_cast<const LeafNode *>(src)->leaves, src->sz);
+        } else {
+            const NonLeafNode *src_n = reinterpret_cast<const NonLeafNode *>(src);
+            if ((*dst)->isLeaf) {
+                // Push the leaf down, as add() does
+                NonLeafNode *n = allocNonLeaf(src->sz);
+                n->leafNode = reinterpret_cast<LeafNode *>(*dst);
+                *dst = &n->base;
+            }
+            NonLeafNode **dst_np = reinterpret_cast<NonLeafNode **>(dst);
+            if ((*dst_np)->base.sz < src->sz) {
+                *dst_np = reallocNonLeaf(*dst_np, src->sz);
+            }
+            for (uint32_t i=0; i<src->sz; i++) {
+                if (!src_n->nodes[i]) {
+                    continue;
+                }
+                if (!(*dst_np)->nodes[i]) {
+                    (*dst_np)->nodes[i] = clone(src_n->nodes[i]);
+                } else {
+                    unionNode(&(*dst_np)->nodes[i], src_n->nodes[i]);
+                }
+            }
+            if (src_n->leafNode) {
+                unionNode(dst, &src_n->leafNode->base);
+            }
+        }
+    }
+
+    void intersectNode(Node *dst, const Node *src) {
+        if (dst->isLeaf) {
+            LeafNode *leaf = reinterpret_cast<LeafNode *>(dst);
+            const LeafNode *src_l = leafOf(src);
+            uint32_t n = (src_l && src_l->base.sz < leaf->base.sz)?
+                src_l->base.sz:leaf->base.sz;
+            if (src_l) {
+                wordsAnd(leaf->leaves, src_l->leaves, n);
+            } else {
+                n = 0;
+            }
+            memset(&leaf->leaves[n], 0, (leaf->base.sz-n)*sizeof(uintptr_t));
+        } else {
+            NonLeafNode *dst_n = reinterpret_cast<NonLeafNode *>(dst);
+            const NonLeafNode *src_n = (src->isLeaf)?0:
+                reinterpret_cast<const NonLeafNode *>(src);
+            for (uint32_t i=0; i<dst->sz; i++) {
+                if (!dst_n->nodes[i]) {
+                    continue;
+                }
+                // Sub-trees absent from 'src' are dropped. Their nodes 
+                // are reclaimed along with the arena
+                if (src_n && i < src->sz && src_n->nodes[i]) {
+                    intersectNode(dst_n->nodes[i], src_n->nodes[i]);
+                } else {
+                    dst_n->nodes[i] = 0;
+                }
+            }
+            if (dst_n->leafNode) {
+                intersectNode(&dst_n->leafNode->base, src);
+            }
+        }
+    }
+
+    void subtractNode(Node *dst, const Node *src) {
+        if (dst->isLeaf) {
+            LeafNode *leaf = reinterpret_cast<LeafNode *>(dst);
+            const LeafNode *src_l = leafOf(src);
+            if (src_l) {
+                wordsAndNot(leaf->leaves, src_l->leaves, 
+                    (src_l->base.sz < leaf->base.sz)?src_l->base.sz:leaf->base.sz);
+            }
+        } else {
+            NonLeafNode *dst_n = reinterpret_cast<NonLeafNode *>(dst);
+            if (!src->isLeaf) {
+                const NonLeafNode *src_n = reinterpret_cast<const NonLeafNode *>(src);
+                uint32_t n = (src->sz < dst->sz)?src->sz:dst->sz;
+                for (uint32_t i=0; i<n; i++) {
+                    if (dst_n->nodes[i] && src_n->nodes[i]) {
+                        subtractNode(dst_n->nodes[i], src_n->nodes[i]);
+                    }
+                }
+            }
+            if (dst_n->leafNode) {
+                subtractNode(&dst_n->leafNode->base, src);
+            }
+        }
+    }
+
+    bool subsetNode(const Node *n, const Node *rhs) const {
+        if (n->isLeaf) {
+            const LeafNode *leaf = reinterpret_cast<const LeafNode *>(n);
+            const LeafNode *rhs_l = leafOf(rhs);
+            uint32_t sz = 0;
+            if (rhs_l) {
+                sz = (rhs_l->base.sz < leaf->base.sz)?rhs_l->base.sz:leaf->base.sz;
+                if (!wordsSubset(leaf->leaves, rhs_l->leaves, sz)) {
+                    return false;
+                }
+            }
+            for (uint32_t i=sz; i<leaf->base.sz; i++) {
+                if (leaf->leaves[i]) {
+                    return false;
+                }
+            }
+        } else {
+            const NonLeafNode *nleaf = reinterpret_cast<const NonLeafNode *>(n);
+            const NonLeafNode *rhs_n = (rhs->isLeaf)?0:
+                reinterpret_cast<const NonLeafNode *>(rhs);
+            for (uint32_t i=0; i<n->sz; i++) {
+                if (!nleaf->nodes[i]) {
+                    continue;
+                }
+                if (rhs_n && i < rhs->sz && rhs_n->nodes[i]) {
+                    if (!subsetNode(nleaf->nodes[i], rhs_n->nodes[i])) {
+                        return false;
+                    }
+                } else if (!empty(nleaf->nodes[i])) {
+                    return false;
+                }
+            }
+            if (nleaf->leafNode && !subsetNode(&nleaf->leafNode->base, rhs)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static int32_t count(const Node *n) {
+        int32_t ret = 0;
+        if (n->isLeaf) {
+            const LeafNode *leaf = reinterpret_cast<const LeafNode *>(n);
+            for (uint32_t i=0; i<leaf->base.sz; i++) {
+                ret += bitCount(leaf->leaves[i]);
+            }
+        } else {
+            const NonLeafNode *nleaf = reinterpret_cast<const NonLeafNode *>(n);
+            for (uint32_t i=0; i<n->sz; i++) {
+                if (nleaf->nodes[i]) {
+                    ret += count(nleaf->nodes[i]);
+                }
+            }
+            if (nleaf->leafNode) {
+                ret += count(&nleaf->leafNode->base);
+            }
+        }
+        return ret;
+    }
+
+    Node *clone(const Node *n) {
+        if (n->isLeaf) {
+            LeafNode *ret = allocLeaf(n->sz);
+            memcpy(ret->leaves, reinterpret_cast<const LeafNode *>(n)->leaves,
+                n->sz*sizeof(uintptr_t));
+            return &ret->base;
+        } else {
+            const NonLeafNode *nleaf = reinterpret_cast<const NonLeafNode *>(n);
+            NonLeafNode *ret = allocNonLeaf(n->sz);
+            for (uint32_t i=0; i<n->sz; i++) {
+                if (nleaf->nodes[i]) {
+                    ret->nodes[i] = clone(nleaf->nodes[i]);
+                }
+            }
+            if (nleaf->leafNode) {
+                ret->leafNode = reinterpret_cast<LeafNode *>(
+                    clone(&nleaf->leafNode->base));
+            }
+            return &ret->base;
+        }
+    }
+
+    static void wordsOr(uintptr_t *dst, const uintptr_t *src, uint32_t n) {
+        uint32_t i=0;
+#if defined(__SSE2__)
+        for (; i+WordsPerVec<=n; i+=WordsPerVec) {
+            __m128i *d = reinterpret_cast<__m128i *>(&dst[i]);
+            _mm_storeu_si128(d, _mm_or_si128(_mm_loadu_si128(d),
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(&src[i]))));
+        }
+#endif
+        for (; i<n; i++) {
+            dst[i] |= src[i];
+        }
+    }
+
+    static void wordsAnd(uintptr_t *dst, const uintptr_t *src, uint32_t n) {
+        uint32_t i=0;
+#if defined(__SSE2__)
+        for (; i+WordsPerVec<=n; i+=WordsPerVec) {
+            __m128i *d = reinterpret_cast<__m128i *>(&dst[i]);
+            _mm_storeu_si128(d, _mm_and_si128(_mm_loadu_si128(d),
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(&src[i]))));
+        }
+#endif
+        for (; i<n; i++) {
+            dst[i] &= src[i];
+        }
+    }
+
+    static void wordsAndNot(uintptr_t *dst, const uintptr_t *src, uint32_t n) {
+        uint32_t i=0;
+#if defined(__SSE2__)
+        for (; i+WordsPerVec<=n; i+=WordsPerVec) {
+            __m128i *d = reinterpret_cast<__m128i *>(&dst[i]);
+            // andnot computes ~a & b
+            _mm_storeu_si128(d, _mm_andnot_si128(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(&src[i])),
+                _mm_loadu_si128(d)));
+        }
+#endif
+        for (; i<n; i++) {
+            dst[i] &= ~src[i];
+        }
+    }
+
+    static bool wordsSubset(const uintptr_t *a, const uintptr_t *b, uint32_t n) {
+        uint32_t i=0;
+#if defined(__SSE2__)
+        for (; i+WordsPerVec<=n; i+=WordsPerVec) {
+            __m128i r = _mm_andnot_si128(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(&b[i])),
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(&a[i])));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(r, _mm_setzero_si128())) != 0xFFFF) {
+                return false;
+            }
+        }
+#endif
+        for (; i<n; i++) {
+            if (a[i] & ~b[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static uint32_t bitCount(uintptr_t word) {
+#if defined(__GNUC__)
+        return (sizeof(uintptr_t) == 8)?
+            __builtin_popcountll(word):__builtin_popcount(word);
+#else
+        uint32_t ret = 0;
+        while (word) {
+            word &= (word - 1);
+            ret++;
+        }
+        return ret;
+#endif
+    }
+
+#if defined(__SSE2__)
+    static const uint32_t WordsPerVec = sizeof(__m128i)/sizeof(uintptr_t);
+#endif
+
 public:
+    /**
+     * Cursor over the paths in the set. The node stack and path are 
+     * fixed-size arrays, as in forEach(), so neither construction nor
+     * next() allocates. path() copies the current path into a vector
+     * whose capacity is retained across calls.
+     */
     class iterator {
     public:
-        iterator(NonLeafNode *root) {
-            m_node_s.push_back(&root->base);
-            m_path.push_back(-1);
+        iterator(NonLeafNode *root) : m_depth(1) {
+            m_node_s[0] = &root->base;
+            m_path[0] = -1;
         }
 
-        iterator(const iterator &rhs) :
-            m_node_s(rhs.m_node_s.begin(), rhs.m_node_s.end()),
-            m_path(rhs.m_path.begin(), rhs.m_path.end()) { }
+        iterator(const iterator &rhs) : m_depth(rhs.m_depth) {
+            memcpy(m_node_s, rhs.m_node_s, m_depth*sizeof(Node *));
+            memcpy(m_path, rhs.m_path, m_depth*sizeof(int32_t));
+        }
 
         void operator =(const iterator &rhs) {
-            m_node_s.clear();
-            m_node_s.insert(m_node_s.begin(), rhs.m_node_s.begin(), rhs.m_node_s.end());
-            m_path.clear();
-            m_path.insert(m_path.begin(), rhs.m_path.begin(), rhs.m_path.end());
+            m_depth = rhs.m_depth;
+            memcpy(m_node_s, rhs.m_node_s, m_depth*sizeof(Node *));
+            memcpy(m_path, rhs.m_path, m_depth*sizeof(int32_t));
         }
 
         bool next() {
             bool found = false;
-            while (m_node_s.size()) {
+            while (m_depth) {
+                int32_t &idx = m_path[m_depth-1];
                 // If we're at leaf level, see if there's more for us
-                if (m_node_s.back()->isLeaf) {
-                    LeafNode *leaf = reinterpret_cast<LeafNode *>(m_node_s.back());
-                    m_path.back()++;
-                    while (m_path.back() < (8*sizeof(uintptr_t)*leaf->base.sz)) {
-                        uint32_t word_idx = m_path.back()/(8*sizeof(uintptr_t));
-                        uint32_t bit_idx = m_path.back()%(8*sizeof(uintptr_t));
+                if (m_node_s[m_depth-1]->isLeaf) {
+                    LeafNode *leaf = reinterpret_cast<LeafNode *>(m_node_s[m_depth-1]);
+                    idx++;
+                    while (idx < (8*sizeof(uintptr_t)*leaf->base.sz)) {
+                        uint32_t word_idx = idx/(8*sizeof(uintptr_t));
+                        uint32_t bit_idx = idx%(8*sizeof(uintptr_t));
                         if (!leaf->leaves[word_idx]) {
-                            m_path.back() += (8*sizeof(uintptr_t));
+                            idx += (8*sizeof(uintptr_t));
                         } else if (leaf->leaves[word_idx] & (1ULL << bit_idx)) {
                             found = true;
                             break;
                         } else {
-                            m_path.back()++;
+                            idx++;
                         }
                     }
 
                     if (!found) {
-                        m_node_s.pop_back();
-                        m_path.pop_back();
+                        m_depth--;
                     }
                 } else {
-                    NonLeafNode *nleaf = reinterpret_cast<NonLeafNode *>(m_node_s.back());
+                    NonLeafNode *nleaf = reinterpret_cast<NonLeafNode *>(m_node_s[m_depth-1]);
                     bool have_subnode = false;
 
-                    m_path.back()++;
-                    while (m_path.back() < nleaf->base.sz) {
-                        if (nleaf->nodes[m_path.back()]) {
-                            m_node_s.push_back(nleaf->nodes[m_path.back()]);
-                            m_path.push_back(-1);
+                    idx++;
+                    while (idx < nleaf->base.sz) {
+                        if (nleaf->nodes[idx]) {
+                            m_node_s[m_depth] = nleaf->nodes[idx];
+                            m_path[m_depth++] = -1;
                             have_subnode = true;
                             break;
                         } else {
-                            m_path.back()++;
+                            idx++;
                         }
                     }
 
                     if (!have_subnode) {
                         if (nleaf->leafNode) {
                             // Replace the compound node with a leaf node
-                            m_node_s.pop_back();
-                            m_path.pop_back();
-                            m_node_s.push_back(&nleaf->leafNode->base);
-                            m_path.push_back(-1);
+                            m_node_s[m_depth-1] = &nleaf->leafNode->base;
+                            idx = -1;
                         } else {
                             // Nothing more to do in the compound node, so
                             // move back up the stack
-                            m_node_s.pop_back();
-                            m_path.pop_back();
+                            m_depth--;
                         }
                     }
                 }
@@ -332,20 +742,94 @@ public:
             return found;
         }
 
+        /**
+         * Returns the current path. The reference is only refreshed by
+         * calls to path(), so must not be held across next()
+         */
         const std::vector<int32_t> &path() const {
-            return m_path;
+            m_path_v.assign(m_path, m_path+m_depth);
+            return m_path_v;
         }
 
+        const int32_t *data() const { return m_path; }
+
+        uint32_t depth() const { return m_depth; }
+
     private:
-        std::vector<Node *>         m_node_s;
-        std::vector<int32_t>        m_path;
+        Node                            *m_node_s[MaxDepth];
+        int32_t                         m_path[MaxDepth];
+        uint32_t                        m_depth;
+        mutable std::vector<int32_t>    m_path_v;
     };
 
     iterator begin() const {
         return iterator(m_root);
     }
 
+    /**
+     * Calls f(path, depth) for each path, in iterator order. 'path' 
+     * points to 'depth' elements, and is only valid during the call.
+     * Traversal state is held on the stack, so nothing is allocated.
+     */
+    template <class F> void forEach(const F &f) const {
+        const Node *node_s[MaxDepth];
+        int32_t path[MaxDepth];
+        uint32_t depth = 1;
+
+        node_s[0] = &m_root->base;
+        path[0] = -1;
+        while (depth) {
+            if (node_s[depth-1]->isLeaf) {
+                const LeafNode *leaf = reinterpret_cast<const LeafNode *>(node_s[depth-1]);
+                // Visit the set bits of each word, lowest first
+                for (uint32_t i=0; i<leaf->base.sz; i++) {
+                    uintptr_t word = leaf->leaves[i];
+                    while (word) {
+                        path[depth-1] = 8*sizeof(uintptr_t)*i + ctz(word);
+                        f(path, depth);
+                        word &= (word - 1);
+                    }
+                }
+                depth--;
+            } else {
+                const NonLeafNode *nleaf = reinterpret_cast<const NonLeafNode *>(node_s[depth-1]);
+                int32_t &idx = path[depth-1];
+
+                idx++;
+                while (static_cast<uint32_t>(idx) < nleaf->base.sz && !nleaf->nodes[idx]) {
+                    idx++;
+                }
+
+                if (static_cast<uint32_t>(idx) < nleaf->base.sz) {
+                    node_s[depth] = nleaf->nodes[idx];
+                    path[depth] = -1;
+                    depth++;
+                } else if (nleaf->leafNode) {
+                    // Sub-trees are visited before paths ending here
+                    node_s[depth-1] = &nleaf->leafNode->base;
+                    idx = -1;
+                } else {
+                    depth--;
+                }
+            }
+        }
+    }
+
 private:
+    static uint32_t ctz(uintptr_t word) {
+#if defined(__GNUC__)
+        return (sizeof(uintptr_t) == 8)?
+            __builtin_ctzll(word):__builtin_ctz(word);
+#else
+        uint32_t ret = 0;
+        while (!(word & 1)) {
+            word >>= 1;
+            ret++;
+        }
+        return ret;
+#endif
+    }
+
     NonLeafNode *allocNonLeaf(uint32_t max) {
         uint32_t sz_p2 = 0;
         uint32_t max_t = max-1;
@@ -357,7 +841,7 @@ private:
         } 
         max_t = (1ULL << sz_p2);
 
-        NonLeafNode *node = reinterpret_cast<NonLeafNode *>(::operator new(
+        NonLeafNode *node = reinterpret_cast<NonLeafNode *>(arena()->alloc(
             sizeof(NonLeafNode) + ((max_t-1)*sizeof(Node *))
         ));
 
@@ -379,7 +863,7 @@ private:
         } 
         max_t = (1ULL << sz_p2);
 
-        LeafNode *node = reinterpret_cast<LeafNode *>(::operator new(
+        LeafNode *node = reinterpret_cast<LeafNode *>(arena()->alloc(
             sizeof(LeafNode)+((max_t-1)*sizeof(uintptr_t))
         ));
 
@@ -401,7 +885,7 @@ private:
         } 
         max_t = (1ULL << sz_p2);
 
-        NonLeafNode *nnode = reinterpret_cast<NonLeafNode *>(::operator new(
+        NonLeafNode *nnode = reinterpret_cast<NonLeafNode *>(arena()->alloc(
             sizeof(NonLeafNode) + ((max_t-1)*sizeof(Node *))
         ));
 
@@ -416,7 +900,7 @@ private:
             nnode->nodes[i] = 0;
         }
 
-        ::operator delete(node);
+        // The superseded node is reclaimed along with the arena
 
         return nnode;
     }
@@ -432,7 +916,7 @@ private:
         } 
         max_t = (1ULL << sz_p2);
 
-        LeafNode *nnode = reinterpret_cast<LeafNode *>(::operator new(
+        LeafNode *nnode = reinterpret_cast<LeafNode *>(arena()->alloc(
             sizeof(LeafNode)+((max_t-1)*sizeof(uintptr_t))
         ));
 
@@ -446,13 +930,15 @@ private:
             nnode->leaves[i] = 0;
         }
 
-        ::operator delete(node);
+        // The superseded node is reclaimed along with the arena
 
         return nnode;
     }
 
 
 private:
+    RefPathArenaUP  m_arena_u;
+    RefPathArena    *m_arena;
     NonLeafNode     *m_root;
     int32_t         m_size;
 
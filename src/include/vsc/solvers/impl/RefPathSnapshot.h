@@ -0,0 +1,299 @@
+/**
+ * RefPathSnapshot.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <stdint.h>
+#include <memory>
+#include <vector>
+#include "vsc/solvers/impl/RefPathSet.h"
+
+namespace vsc {
+namespace solvers {
+
+
+/**
+ * Immutable set of reference paths. Updates return a new snapshot
+ * that shares all nodes off the updated path with the original, so
+ * deriving a variant copies O(depth) nodes. Nodes are never modified
+ * once published, such that any number of threads may read a snapshot
+ * without locking.
+ *
+ * Each snapshot carries a 64-bit hash of its content, maintained
+ * incrementally. Equal sets have equal hashes regardless of the order
+ * in which paths were added, so the hash can key plan caches.
+ */
+class RefPathSnapshot {
+public:
+    // Maximum number of elements in a path
+    static const uint32_t MaxDepth = RefPathSet::MaxDepth;
+
+    RefPathSnapshot() : m_size(0), m_hash(0) { }
+
+    /**
+     * Returns a snapshot that also holds 'path'
+     */
+    RefPathSnapshot add(const std::vector<int32_t> &path) const {
+        if (path.size() == 0 || path.size() > MaxDepth || find(path)) {
+            return *this;
+        }
+
+        RefPathSnapshot ret;
+        ret.m_root = insert(m_root.get(), path.data(), path.size());
+        ret.m_size = m_size + 1;
+        ret.m_hash = m_hash + pathHash(path.data(), path.size());
+        return ret;
+    }
+
+    /**
+     * Returns a snapshot that does not hold 'path'
+     */
+    RefPathSnapshot remove(const std::vector<int32_t> &path) const {
+        if (!find(path)) {
+            return *this;
+        }
+
+        RefPathSnapshot ret;
+        ret.m_root = erase(m_root.get(), path.data(), path.size());
+        ret.m_size = m_size - 1;
+        ret.m_hash = m_hash - pathHash(path.data(), path.size());
+        return ret;
+    }
+
+    bool find(const std::vector<int32_t> &path) const {
+        const Node *n = m_root.get();
+
+        if (!n || path.size() == 0) {
+            return false;
+        }
+
+        for (uint32_t i=0; i+1<path.size(); i++) {
+            if (static_cast<uint32_t>(path[i]) >= n->nodes.size()
+                    || !n->nodes[path[i]]) {
+                return false;
+            }
+            n = n->nodes[path[i]].get();
+        }
+
+        uint32_t idx = path.back()/64;
+        uint32_t off = path.back()%64;
+        return (idx < n->leaves.size() && (n->leaves[idx] & (1ULL << off)));
+    }
+
+    bool empty() const { return m_size == 0; }
+
+    int32_t size() const { return m_size; }
+
+    uint64_t hash() const { return m_hash; }
+
+    bool operator ==(const RefPathSnapshot &rhs) const {
+        return (m_size == rhs.m_size && m_hash == rhs.m_hash
+            && equal(m_root.get(), rhs.m_root.get()));
+    }
+
+    bool operator !=(const RefPathSnapshot &rhs) const {
+        return !(*this == rhs);
+    }
+
+    /**
+     * Calls f(path, depth) for each path, in the same order as
+     * RefPathSet. 'path' points to 'depth' elements, and is only
+     * valid during the call. Nothing is allocated.
+     */
+    template <class F> void forEach(const F &f) const {
+        int32_t path[MaxDepth];
+        if (m_root) {
+            forEachNode(m_root.get(), path, 0, f);
+        }
+    }
+
+    /**
+     * Adds all paths to 'set'
+     */
+    void toSet(RefPathSet &set) const {
+        std::vector<int32_t> path_v;
+        path_v.reserve(MaxDepth);
+        forEach([&set, &path_v](const int32_t *path, uint32_t depth) {
+            path_v.assign(path, path+depth);
+            set.add(path_v);
+        });
+    }
+
+    static RefPathSnapshot fromSet(const RefPathSet &set) {
+        RefPathSnapshot ret;
+        NodeMP root;
+
+        // Nodes are private until the snapshot is returned, so
+        // they are built in place rather than copied per path
+        set.forEach([&ret, &root](const int32_t *path, uint32_t depth) {
+            insertInPlace(root, path, depth);
+            ret.m_size++;
+            ret.m_hash += pathHash(path, depth);
+        });
+        ret.m_root = root;
+
+        return ret;
+    }
+
+private:
+    struct Node;
+    using NodeP=std::shared_ptr<const Node>;
+    using NodeMP=std::shared_ptr<Node>;
+
+    struct Node {
+        // Sub-trees, indexed by path element
+        std::vector<NodeP>          nodes;
+        // Bitmap of paths ending at this node
+        std::vector<uint64_t>       leaves;
+    };
+
+    // Nodes are kept canonical: empty nodes are never referenced,
+    // and neither vector has trailing null/zero entries. Equal sets
+    // therefore have structurally-equal tries.
+
+    static NodeP insert(const Node *n, const int32_t *path, uint32_t depth) {
+        NodeMP ret = (n)?std::make_shared<Node>(*n):std::make_shared<Node>();
+
+        if (depth == 1) {
+            uint32_t idx = path[0]/64;
+            if (ret->leaves.size() <= idx) {
+                ret->leaves.resize(idx+1, 0);
+            }
+            ret->leaves[idx] |= (1ULL << (path[0]%64));
+        } else {
+            if (ret->nodes.size() <= static_cast<uint32_t>(path[0])) {
+                ret->nodes.resize(path[0]+1);
+            }
+            ret->nodes[path[0]] = insert(
+                ret->nodes[path[0]].get(), path+1, depth-1);
+        }
+
+        return ret;
+    }
+
+    static void insertInPlace(NodeMP &n, const int32_t *path, uint32_t depth) {
+        if (!n) {
+            n = std::make_shared<Node>();
+        }
+
+        if (depth == 1) {
+            uint32_t idx = path[0]/64;
+            if (n->leaves.size() <= idx) {
+                n->leaves.resize(idx+1, 0);
+            }
+            n->leaves[idx] |= (1ULL << (path[0]%64));
+        } else {
+            if (n->nodes.size() <= static_cast<uint32_t>(path[0])) {
+                n->nodes.resize(path[0]+1);
+            }
+            NodeMP sub = std::const_pointer_cast<Node>(n->nodes[path[0]]);
+            insertInPlace(sub, path+1, depth-1);
+            n->nodes[path[0]] = sub;
+        }
+    }
+
+    static NodeP erase(const Node *n, const int32_t *path, uint32_t depth) {
+        NodeMP ret = std::make_shared<Node>(*n);
+
+        if (depth == 1) {
+            ret->leaves[path[0]/64] &= ~(1ULL << (path[0]%64));
+            while (ret->leaves.size() && !ret->leaves.back()) {
+                ret->leaves.pop_back();
+            }
+        } else {
+            ret->nodes[path[0]] = erase(
+                ret->nodes[path[0]].get(), path+1, depth-1);
+            while (ret->nodes.size() && !ret->nodes.back()) {
+                ret->nodes.pop_back();
+            }
+        }
+
+        if (!ret->nodes.size() && !ret->leaves.size()) {
+            return NodeP();
+        }
+        return ret;
+    }
+
+    static bool equal(const Node *a, const Node *b) {
+        if (a == b) {
+            return true;
+        }
+        if (!a || !b || a->leaves != b->leaves
+                || a->nodes.size() != b->nodes.size()) {
+            return false;
+        }
+        for (uint32_t i=0; i<a->nodes.size(); i++) {
+            if (!equal(a->nodes[i].get(), b->nodes[i].get())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <class F> static void forEachNode(
+            const Node      *n,
+            int32_t         *path,
+            uint32_t        depth,
+            const F         &f) {
+        // Sub-trees are visited before paths ending here
+        for (uint32_t i=0; i<n->nodes.size(); i++) {
+            if (n->nodes[i]) {
+                path[depth] = i;
+                forEachNode(n->nodes[i].get(), path, depth+1, f);
+            }
+        }
+        for (uint32_t i=0; i<n->leaves.size(); i++) {
+            for (uint32_t j=0; j<64; j++) {
+                if (n->leaves[i] & (1ULL << j)) {
+                    path[depth] = 64*i+j;
+                    f(path, depth+1);
+                }
+            }
+        }
+    }
+
+    /**
+     * Hash of a single path. The set hash is the sum over its paths,
+     * which is independent of order and can be updated incrementally
+     */
+    static uint64_t pathHash(const int32_t *path, uint32_t depth) {
+        uint64_t h = 0x9e3779b97f4a7c15ULL * (depth + 1);
+        for (uint32_t i=0; i<depth; i++) {
+            h ^= static_cast<uint32_t>(path[i]);
+            // splitmix64 finalizer
+            h ^= (h >> 30);
+            h *= 0xbf58476d1ce4e5b9ULL;
+            h ^= (h >> 27);
+            h *= 0x94d049bb133111ebULL;
+            h ^= (h >> 31);
+        }
+        return h;
+    }
+
+private:
+    NodeP                   m_root;
+    int32_t                 m_size;
+    uint64_t                m_hash;
+
+};
+
+}
+}
+
+
@@ -0,0 +1,81 @@
+/**
+ * TaskPath2ValKind.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <vector>
+#include "vsc/dm/impl/VisitorBase.h"
+#include "vsc/solvers/impl/TaskPath2Field.h"
+
+namespace vsc {
+namespace solvers {
+
+enum class ValKind {
+    Bool,
+    Enum,
+    Int,
+    Other           // No scalar value (eg struct)
+};
+
+
+/**
+ * Resolves the path of a field to the kind of value it holds, such 
+ * that values can be accessed through the matching ValRef class
+ */
+class TaskPath2ValKind : dm::VisitorBase {
+public:
+
+    TaskPath2ValKind(dm::IModelField *root_field) : m_root_field(root_field) { }
+
+    virtual ~TaskPath2ValKind() { }
+
+    ValKind toKind(
+        const std::vector<int32_t>  &path,
+        bool                        *is_signed=0) {
+        m_kind = ValKind::Other;
+        m_signed = false;
+        TaskPath2Field(m_root_field).toField(path)->getDataType()->accept(m_this);
+        if (is_signed) {
+            *is_signed = m_signed;
+        }
+        return m_kind;
+    }
+
+	virtual void visitDataTypeBool(dm::IDataTypeBool *t) override {
+        m_kind = ValKind::Bool;
+    }
+
+	virtual void visitDataTypeEnum(dm::IDataTypeEnum *t) override {
+        m_kind = ValKind::Enum;
+    }
+
+	virtual void visitDataTypeInt(dm::IDataTypeInt *t) override {
+        m_kind = ValKind::Int;
+        m_signed = t->isSigned();
+    }
+
+private:
+    dm::IModelField                 *m_root_field;
+    ValKind                         m_kind;
+    bool                            m_signed;
+
+};
+
+} /* namespace solvers */
+} /* namespace vsc */
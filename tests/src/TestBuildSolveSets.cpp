@@ -20,6 +20,7 @@
  */
 #include "TestBuildSolveSets.h"
 #include "TaskBuildSolveSets.h"
+#include "TaskBuildTypeDepGraph.h"
 
 
 namespace vsc {
@@ -234,5 +235,209 @@ TEST_F(TestBuildSolveSets, nested_struct_local_constraints_nested_unconstrained)
     ASSERT_EQ(path.at(1), 2);
 }
 
+TEST_F(TestBuildSolveSets, independent_pairs) {
+    VSC_DATACLASSES(TestBuildSolveSets_independent_pairs, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint32_t 
+            b : vdc.rand_uint32_t 
+            c : vdc.rand_uint32_t 
+            d : vdc.rand_uint32_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+                self.c < self.d
+    )");
+    #include "TestBuildSolveSets_independent_pairs.h"
+
+    enableDebug(false);
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    RefPathSet unconstrained;
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    std::vector<ISolveSetUP> solvesets;
+
+    TaskBuildSolveSets(
+        m_factory->getDebugMgr(),
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints).build(solvesets, unconstrained);
+    
+    ASSERT_EQ(solvesets.size(), 2);
+    ASSERT_EQ(solvesets.at(0)->getFields().size(), 2);
+    ASSERT_EQ(solvesets.at(0)->getConstraints().size(), 1);
+    ASSERT_EQ(solvesets.at(1)->getFields().size(), 2);
+    ASSERT_EQ(solvesets.at(1)->getConstraints().size(), 1);
+    ASSERT_EQ(unconstrained.size(), 0);
+}
+
+TEST_F(TestBuildSolveSets, chain_merge) {
+    VSC_DATACLASSES(TestBuildSolveSets_chain_merge, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint32_t 
+            b : vdc.rand_uint32_t 
+            c : vdc.rand_uint32_t 
+            d : vdc.rand_uint32_t 
+            e : vdc.rand_uint32_t 
+            f : vdc.rand_uint32_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+                self.c < self.d
+                self.e < self.f
+                self.b < self.c
+                self.d < self.e
+    )");
+    #include "TestBuildSolveSets_chain_merge.h"
+
+    enableDebug(false);
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    RefPathSet unconstrained;
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    std::vector<ISolveSetUP> solvesets;
+
+    TaskBuildSolveSets(
+        m_factory->getDebugMgr(),
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints).build(solvesets, unconstrained);
+    
+    // Three partitions are created, then joined by later constraints
+    ASSERT_EQ(solvesets.size(), 1);
+    ASSERT_EQ(solvesets.at(0)->getFields().size(), 6);
+    ASSERT_EQ(solvesets.at(0)->getConstraints().size(), 5);
+    ASSERT_EQ(unconstrained.size(), 0);
+}
+
+TEST_F(TestBuildSolveSets, dep_graph_exclude) {
+    VSC_DATACLASSES(TestBuildSolveSets_dep_graph_exclude, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint32_t 
+            b : vdc.rand_uint32_t 
+            c : vdc.rand_uint32_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+                self.b < self.c
+    )");
+    #include "TestBuildSolveSets_dep_graph_exclude.h"
+
+    enableDebug(false);
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    TypeDepGraphUP graph(TaskBuildTypeDepGraph(
+        m_factory->getDebugMgr()).build(MyC_t));
+    ASSERT_EQ(graph->getFields().size(), 3);
+    ASSERT_EQ(graph->getConstraints().size(), 2);
+    ASSERT_EQ(graph->getLeaves().size(), 3);
+
+    {
+        std::vector<ISolveSetUP> solvesets;
+        RefPathSet unconstrained;
+        TaskBuildSolveSets(
+            m_factory->getDebugMgr(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            graph.get()).build(solvesets, unconstrained);
+        ASSERT_EQ(solvesets.size(), 1);
+        ASSERT_EQ(solvesets.at(0)->getFields().size(), 3);
+        ASSERT_EQ(unconstrained.size(), 0);
+    }
+
+    // Excluding 'b < c' leaves 'c' unconstrained
+    exclude_constraints.add(graph->getConstraintPath(
+        graph->getConstraints().at(1).id));
+    {
+        std::vector<ISolveSetUP> solvesets;
+        RefPathSet unconstrained;
+        TaskBuildSolveSets(
+            m_factory->getDebugMgr(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            graph.get()).build(solvesets, unconstrained);
+        ASSERT_EQ(solvesets.size(), 1);
+        ASSERT_EQ(solvesets.at(0)->getFields().size(), 2);
+        ASSERT_EQ(solvesets.at(0)->getConstraints().size(), 1);
+        ASSERT_EQ(unconstrained.size(), 1);
+
+        // Fields and constraints carry their graph IDs
+        SolveSet *ss = dynamic_cast<SolveSet *>(solvesets.at(0).get());
+        ASSERT_EQ(ss->getFieldIds().size(), 2);
+        ASSERT_EQ(ss->getConstraintIds().size(), 1);
+        ASSERT_EQ(ss->getConstraintIds().at(0), graph->getConstraints().at(0).id);
+        // 'c' is the last field referenced
+        ASSERT_EQ(ss->getFieldIds().at(0), 0);
+        ASSERT_EQ(ss->getFieldIds().at(1), 1);
+    }
+}
+
+TEST_F(TestBuildSolveSets, flags_classify) {
+    VSC_DATACLASSES(TestBuildSolveSets_flags_classify, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint8_t 
+            b : vdc.rand_uint32_t 
+            c : vdc.rand_uint32_t 
+            d : vdc.rand_uint32_t 
+            e : vdc.rand_uint32_t 
+
+            @vdc.constraint
+            def a_c(self):
+                self.a > 10
+                self.a < 100
+
+            @vdc.constraint
+            def bc_c(self):
+                self.b * self.c < 50
+
+            @vdc.constraint
+            def de_c(self):
+                self.d < self.e
+    )");
+    #include "TestBuildSolveSets_flags_classify.h"
+
+    enableDebug(false);
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    std::vector<ISolveSetUP> solvesets;
+    RefPathSet unconstrained;
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    TaskBuildSolveSets(
+        m_factory->getDebugMgr(),
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints).build(solvesets, unconstrained);
+
+    ASSERT_EQ(solvesets.size(), 3);
+    ASSERT_EQ(solvesets.at(0)->getFlags(), 
+        SolveSetFlags::Linear | SolveSetFlags::Domain);
+    ASSERT_EQ(solvesets.at(1)->getFlags(), SolveSetFlags::NonLinear);
+    ASSERT_EQ(solvesets.at(2)->getFlags(), SolveSetFlags::Linear);
+    ASSERT_EQ(dynamic_cast<SolveSet *>(solvesets.at(0).get())->getMaxBits(), 8);
+}
+
 }
 }
@@ -18,7 +18,10 @@
  * Created on:
  *     Author:
  */
+#include <set>
 #include "TestConstraintsLinear.h"
+#include "SolverBoolector.h"
+#include "ValRefIntWords.h"
 
 
 namespace vsc {
@@ -111,6 +114,617 @@ TEST_F(TestConstraintsLinear, ult_2var_8bit) {
     }
 }
 
+TEST_F(TestConstraintsLinear, ult_2var_swizzle) {
+    VSC_DATACLASSES(TestConstraintsLinear_ult_2var_swizzle, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint32_t 
+            b : vdc.rand_uint32_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+                self.b < 1000
+    )");
+    #include "TestConstraintsLinear_ult_2var_swizzle.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    ICompoundSolverUP solver(m_factory->mkCompoundSolver());
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+    std::set<uint64_t> a_s;
+
+    for (uint32_t i=0; i<100; i++) {
+        ASSERT_TRUE(solver->randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        dm::ValRefStruct field_v(field->getImmVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        dm::ValRefInt val_b(field_v.getFieldRef(1));
+        ASSERT_LT(val_a.get_val_u(), val_b.get_val_u());
+        ASSERT_LT(val_b.get_val_u(), 1000u);
+        a_s.insert(val_a.get_val_u());
+    }
+
+    // Without random preferences, the backend repeats the same solution
+    ASSERT_GT(a_s.size(), 50u);
+
+    // Retries are bounded by the per-solve budget
+    ASSERT_LE(solver->getStats().getCount(SolverStatsCounter::SwizzleRetry),
+        100*SolverBoolector::DefaultSwizzleCalls);
+}
+
+TEST_F(TestConstraintsLinear, ult_2var_fixed_rebind) {
+    VSC_DATACLASSES(TestConstraintsLinear_ult_2var_fixed_rebind, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint8_t 
+            b : vdc.rand_uint8_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+    )");
+    #include "TestConstraintsLinear_ult_2var_fixed_rebind.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    ICompoundSolverUP solver(m_factory->mkCompoundSolver());
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    fixed_fields.add({0});
+
+    // The solver instance is re-used across calls, so the
+    // new value of 'a' must be observed on each call
+    for (uint32_t i=0; i<200; i++) {
+        dm::ValRefStruct field_v(field->getMutVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        val_a.set_val(i);
+        solver->randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags);
+        dm::ValRefInt val_b(field_v.getFieldRef(1));
+        ASSERT_EQ(val_a.get_val_u(), i);
+        ASSERT_LT(val_a.get_val_u(), val_b.get_val_u());
+    }
+}
+
+TEST_F(TestConstraintsLinear, ult_2var_pool) {
+    VSC_DATACLASSES(TestConstraintsLinear_ult_2var_pool, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint8_t 
+            b : vdc.rand_uint8_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+    )");
+    #include "TestConstraintsLinear_ult_2var_pool.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    ICompoundSolverUP solver(m_factory->mkCompoundSolver());
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    solver->setPoolSize(8);
+    ASSERT_EQ(solver->getPoolSize(), 8);
+
+    // Each harvest serves 8 solutions, which are all distinct
+    std::set<std::pair<uint64_t,uint64_t>> ab_s;
+    for (uint32_t i=0; i<16; i++) {
+        ASSERT_TRUE(solver->randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        dm::ValRefStruct field_v(field->getImmVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        dm::ValRefInt val_b(field_v.getFieldRef(1));
+        ASSERT_LT(val_a.get_val_u(), val_b.get_val_u());
+        if (i < 8) {
+            ab_s.insert({val_a.get_val_u(), val_b.get_val_u()});
+        }
+    }
+    ASSERT_EQ(ab_s.size(), 8u);
+    ASSERT_EQ(solver->getStats().getCount(SolverStatsCounter::PoolHit), 14u);
+
+    // Changing the value of a fixed field invalidates the pool
+    fixed_fields.add({0});
+    for (uint32_t i=0; i<20; i++) {
+        dm::ValRefStruct field_v(field->getMutVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        val_a.set_val(10*i);
+        ASSERT_TRUE(solver->randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        dm::ValRefInt val_b(field_v.getFieldRef(1));
+        ASSERT_EQ(val_a.get_val_u(), 10*i);
+        ASSERT_LT(val_a.get_val_u(), val_b.get_val_u());
+    }
+}
+
+TEST_F(TestConstraintsLinear, ult_2var_pool_fixed) {
+    VSC_DATACLASSES(TestConstraintsLinear_ult_2var_pool_fixed, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint8_t 
+            b : vdc.rand_uint8_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+    )");
+    #include "TestConstraintsLinear_ult_2var_pool_fixed.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    ICompoundSolverUP solver(m_factory->mkCompoundSolver());
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    solver->setPoolSize(8);
+    fixed_fields.add({0});
+
+    // Re-binding an unchanged fixed value keeps the pool
+    for (uint32_t i=0; i<16; i++) {
+        dm::ValRefStruct field_v(field->getMutVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        val_a.set_val(10);
+        ASSERT_TRUE(solver->randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        dm::ValRefInt val_b(field_v.getFieldRef(1));
+        ASSERT_EQ(val_a.get_val_u(), 10u);
+        ASSERT_LT(val_a.get_val_u(), val_b.get_val_u());
+    }
+    ASSERT_EQ(solver->getStats().getCount(SolverStatsCounter::PoolHit), 14u);
+
+    // A changed value clears the pool, so the next call isn't a hit
+    {
+        dm::ValRefStruct field_v(field->getMutVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        val_a.set_val(20);
+    }
+    ASSERT_TRUE(solver->randomize(
+        randstate.get(),
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints,
+        flags));
+    ASSERT_EQ(solver->getStats().getCount(SolverStatsCounter::PoolHit), 14u);
+}
+
+TEST_F(TestConstraintsLinear, ult_2var_pool_fixed_wide) {
+    VSC_DATACLASSES(TestConstraintsLinear_ult_2var_pool_fixed_wide, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand[vdc.bit_t[96]] 
+            b : vdc.rand[vdc.bit_t[96]] 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+    )");
+    #include "TestConstraintsLinear_ult_2var_pool_fixed_wide.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    ICompoundSolverUP solver(m_factory->mkCompoundSolver());
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    solver->setPoolSize(8);
+    fixed_fields.add({0});
+
+    // Solutions are checked by wide_write_back. This checks that the
+    // pool is keyed on all words of the fixed value
+    uint64_t a_w[2] = {10, 1};
+    for (uint32_t i=0; i<16; i++) {
+        dm::ValRefStruct field_v(field->getMutVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        ValRefIntWords::set(val_a, a_w);
+        ASSERT_TRUE(solver->randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+    }
+    ASSERT_EQ(solver->getStats().getCount(SolverStatsCounter::PoolHit), 14u);
+
+    // A value that differs only above bit 64 clears the pool
+    a_w[1] = 2;
+    {
+        dm::ValRefStruct field_v(field->getMutVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        ValRefIntWords::set(val_a, a_w);
+    }
+    ASSERT_TRUE(solver->randomize(
+        randstate.get(),
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints,
+        flags));
+    ASSERT_EQ(solver->getStats().getCount(SolverStatsCounter::PoolHit), 14u);
+}
+
+TEST_F(TestConstraintsLinear, wide_write_back) {
+    VSC_DATACLASSES(TestConstraintsLinear_wide_write_back, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand[vdc.bit_t[96]] 
+            b : vdc.rand[vdc.bit_t[96]] 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a == (1 << 80) + 10
+                self.b > self.a
+                self.b < self.a + 16
+    )");
+    #include "TestConstraintsLinear_wide_write_back.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    ICompoundSolverUP solver(m_factory->mkCompoundSolver());
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    // Solutions are written back both directly and from the pool
+    solver->setPoolSize(4);
+
+    uint64_t a_w[2], b_w[2];
+    for (uint32_t i=0; i<16; i++) {
+        ASSERT_TRUE(solver->randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        dm::ValRefStruct field_v(field->getMutVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        dm::ValRefInt val_b(field_v.getFieldRef(1));
+        ValRefIntWords::get(val_a, 96, false, a_w);
+        ValRefIntWords::get(val_b, 96, false, b_w);
+        ASSERT_EQ(a_w[0], 10u);
+        ASSERT_EQ(a_w[1], 1ULL << 16);
+        ASSERT_EQ(b_w[1], 1ULL << 16);
+        ASSERT_GT(b_w[0], 10u);
+        ASSERT_LT(b_w[0], 26u);
+    }
+    ASSERT_GT(solver->getStats().getCount(SolverStatsCounter::PoolHit), 0u);
+}
+
+TEST_F(TestConstraintsLinear, ult_2var_fixed_sat) {
+    VSC_DATACLASSES(TestConstraintsLinear_ult_2var_fixed_sat, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint8_t 
+            b : vdc.rand_uint8_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+    )");
+    #include "TestConstraintsLinear_ult_2var_fixed_sat.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    ICompoundSolverUP solver(m_factory->mkCompoundSolver());
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    fixed_fields.add({0});
+
+    dm::ValRefStruct field_v(field->getMutVal());
+    dm::ValRefInt val_a(field_v.getFieldRef(0));
+
+    // No value of 'b' is greater than 255
+    val_a.set_val(255);
+    ASSERT_FALSE(solver->sat(
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints,
+        flags));
+
+    val_a.set_val(10);
+    ASSERT_TRUE(solver->randomize(
+        randstate.get(),
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints,
+        flags));
+    dm::ValRefInt val_b(field_v.getFieldRef(1));
+    uint64_t b = val_b.get_val_u();
+    ASSERT_LT(10u, b);
+
+    // Checking satisfiability doesn't modify field values
+    ASSERT_TRUE(solver->sat(
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints,
+        flags));
+    ASSERT_EQ(val_b.get_val_u(), b);
+}
+
+TEST_F(TestConstraintsLinear, ult_2var_batch) {
+    VSC_DATACLASSES(TestConstraintsLinear_ult_2var_batch, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint32_t 
+            b : vdc.rand_uint32_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+    )");
+    #include "TestConstraintsLinear_ult_2var_batch.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    ICompoundSolverUP solver(m_factory->mkCompoundSolver());
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+    const uint32_t count = 1000;
+    std::vector<std::vector<int32_t>> columns = {{0}, {1}};
+    std::vector<uint64_t> data(columns.size()*count);
+
+    ASSERT_TRUE(solver->randomizeN(
+        randstate.get(),
+        field.get(),
+        count,
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints,
+        flags,
+        columns,
+        data.data()));
+
+    uint32_t n_diff = 0;
+    for (uint32_t i=0; i<count; i++) {
+        ASSERT_LT(data[i], data[count+i]);
+        if (i && data[i] != data[i-1]) {
+            n_diff++;
+        }
+    }
+    ASSERT_GT(n_diff, count/2);
+}
+
+TEST_F(TestConstraintsLinear, slt_2var_batch) {
+    VSC_DATACLASSES(TestConstraintsLinear_slt_2var_batch, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_int8_t 
+            b : vdc.rand_int8_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < -10
+                self.a < self.b
+    )");
+    #include "TestConstraintsLinear_slt_2var_batch.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    ICompoundSolverUP solver(m_factory->mkCompoundSolver());
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::DiagnoseFailures;
+    const uint32_t count = 100;
+    std::vector<std::vector<int32_t>> columns = {{0}, {1}};
+    std::vector<uint64_t> data(columns.size()*count);
+
+    ASSERT_TRUE(solver->randomizeN(
+        randstate.get(),
+        field.get(),
+        count,
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints,
+        flags,
+        columns,
+        data.data()));
+
+    // Signed columns are sign-extended to 64 bits
+    for (uint32_t i=0; i<count; i++) {
+        ASSERT_LT(static_cast<int64_t>(data[i]), -10);
+        ASSERT_LT(static_cast<int64_t>(data[i]), static_cast<int64_t>(data[count+i]));
+    }
+}
+
+TEST_F(TestConstraintsLinear, parallel_thread_invariant) {
+    VSC_DATACLASSES(TestConstraintsLinear_parallel_thread_invariant, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint32_t 
+            b : vdc.rand_uint32_t 
+            c : vdc.rand_uint32_t 
+            d : vdc.rand_uint32_t 
+            e : vdc.rand_uint32_t 
+            f : vdc.rand_uint32_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+                self.c < self.d
+                self.e < self.f
+    )");
+    #include "TestConstraintsLinear_parallel_thread_invariant.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field1(mkRootField("abc1", MyC_t));
+    vsc::dm::IModelFieldUP field4(mkRootField("abc4", MyC_t));
+
+    IRandStateUP randstate1(m_factory->mkRandState("0"));
+    IRandStateUP randstate4(m_factory->mkRandState("0"));
+    ICompoundSolverUP solver1(m_factory->mkCompoundSolver());
+    ICompoundSolverUP solver4(m_factory->mkCompoundSolver());
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    solver1->setNumThreads(1);
+    solver4->setNumThreads(4);
+    ASSERT_EQ(solver4->getNumThreads(), 4);
+
+    // Results must not depend on the number of worker threads
+    for (uint32_t i=0; i<20; i++) {
+        ASSERT_TRUE(solver1->randomize(
+            randstate1.get(),
+            field1.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        ASSERT_TRUE(solver4->randomize(
+            randstate4.get(),
+            field4.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        dm::ValRefStruct field1_v(field1->getMutVal());
+        dm::ValRefStruct field4_v(field4->getMutVal());
+        for (uint32_t j=0; j<6; j++) {
+            dm::ValRefInt v1(field1_v.getFieldRef(j));
+            dm::ValRefInt v4(field4_v.getFieldRef(j));
+            ASSERT_EQ(v1.get_val_u(), v4.get_val_u());
+        }
+        for (uint32_t j=0; j<6; j+=2) {
+            dm::ValRefInt lo(field4_v.getFieldRef(j));
+            dm::ValRefInt hi(field4_v.getFieldRef(j+1));
+            ASSERT_LT(lo.get_val_u(), hi.get_val_u());
+        }
+    }
+}
+
+TEST_F(TestConstraintsLinear, sequential_thread_invariant) {
+    VSC_DATACLASSES(TestConstraintsLinear_sequential_thread_invariant, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint32_t 
+            b : vdc.rand_uint32_t 
+            c : vdc.rand_uint32_t 
+            d : vdc.rand_uint32_t 
+            e : vdc.rand_uint32_t 
+            f : vdc.rand_uint32_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+                self.c < self.d
+                self.e < self.f
+    )");
+    #include "TestConstraintsLinear_sequential_thread_invariant.h"
+    enableDebug(false);
+
+    // No pool, a single worker, and several workers
+    const uint32_t n_threads[] = {0, 1, 4};
+    std::vector<vsc::dm::IModelFieldUP> fields;
+    std::vector<IRandStateUP> randstates;
+    std::vector<ICompoundSolverUP> solvers;
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    for (uint32_t i=0; i<3; i++) {
+        fields.push_back(vsc::dm::IModelFieldUP(
+            mkRootField("abc" + std::to_string(n_threads[i]), MyC_t)));
+        randstates.push_back(IRandStateUP(m_factory->mkRandState("0")));
+        solvers.push_back(ICompoundSolverUP(m_factory->mkCompoundSolver()));
+        solvers.back()->setNumThreads(n_threads[i]);
+        ASSERT_EQ(solvers.back()->getNumThreads(), n_threads[i]);
+    }
+
+    // Results must not depend on whether a thread pool is used,
+    // nor on the number of worker threads
+    for (uint32_t i=0; i<20; i++) {
+        for (uint32_t s=0; s<3; s++) {
+            ASSERT_TRUE(solvers.at(s)->randomize(
+                randstates.at(s).get(),
+                fields.at(s).get(),
+                target_fields,
+                fixed_fields,
+                include_constraints,
+                exclude_constraints,
+                flags));
+        }
+        dm::ValRefStruct field0_v(fields.at(0)->getMutVal());
+        for (uint32_t s=1; s<3; s++) {
+            dm::ValRefStruct field_v(fields.at(s)->getMutVal());
+            for (uint32_t j=0; j<6; j++) {
+                dm::ValRefInt v0(field0_v.getFieldRef(j));
+                dm::ValRefInt v(field_v.getFieldRef(j));
+                ASSERT_EQ(v0.get_val_u(), v.get_val_u());
+            }
+        }
+        for (uint32_t j=0; j<6; j+=2) {
+            dm::ValRefInt lo(field0_v.getFieldRef(j));
+            dm::ValRefInt hi(field0_v.getFieldRef(j+1));
+            ASSERT_LT(lo.get_val_u(), hi.get_val_u());
+        }
+    }
+}
+
 TEST_F(TestConstraintsLinear, struct_32bit_ne) {
     VSC_DATACLASSES(TestConstraintsLinear_struct_32bit_ne, MyC, R"(
         @vdc.randclass
@@ -326,8 +940,48 @@ TEST_F(TestConstraintsLinear, nested_struct_32bit_4_subfield) {
     }
 }
 
+TEST_F(TestConstraintsLinear, eq_add_mod) {
+    VSC_DATACLASSES(TestConstraintsLinear_eq_add_mod, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint32_t 
+            b : vdc.rand_uint32_t 
+            c : vdc.rand_uint32_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < 100
+                self.b < 100
+                self.c == self.a + self.b
+                self.a % 7 == 3
+    )");
+    #include "TestConstraintsLinear_eq_add_mod.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
 
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    ICompoundSolverUP solver(m_factory->mkCompoundSolver());
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
 
+    for (uint32_t i=0; i<100; i++) {
+        solver->randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags);
+        dm::ValRefStruct field_v(field->getImmVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        dm::ValRefInt val_b(field_v.getFieldRef(1));
+        dm::ValRefInt val_c(field_v.getFieldRef(2));
+        ASSERT_EQ(val_c.get_val_u(), val_a.get_val_u() + val_b.get_val_u());
+        ASSERT_EQ(val_a.get_val_u() % 7, 3);
+    }
+}
 
 }
 }
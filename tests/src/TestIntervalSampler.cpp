@@ -0,0 +1,175 @@
+/*
+ * TestIntervalSampler.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <set>
+#include "TestIntervalSampler.h"
+#include "IntervalSet.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+TestIntervalSampler::TestIntervalSampler() {
+
+}
+
+TestIntervalSampler::~TestIntervalSampler() {
+
+}
+
+TEST_F(TestIntervalSampler, interval_set_ops) {
+    IntervalSet s(0, 9);
+    s.unite(IntervalSet(20, 29));
+    s.unite(IntervalSet(10, 12));
+    ASSERT_EQ(s.getIntervals().size(), 2);
+    ASSERT_EQ(s.getIntervals().at(0).second, 12);
+    ASSERT_EQ(s.count(), 23);
+
+    s.intersect(IntervalSet(5, 25));
+    ASSERT_EQ(s.getIntervals().size(), 2);
+    ASSERT_EQ(s.getIntervals().at(0).first, 5);
+    ASSERT_EQ(s.getIntervals().at(1).second, 25);
+    ASSERT_EQ(s.count(), 14);
+
+    s.intersect(IntervalSet(13, 19));
+    ASSERT_TRUE(s.empty());
+
+    // The full domain has 2^64 values, reported as 0
+    ASSERT_EQ(IntervalSet::full().count(), 0);
+
+    IntervalSet c(0, 9);
+    c.unite(IntervalSet(20, UINT64_MAX));
+    c.complement();
+    ASSERT_EQ(c.getIntervals().size(), 1);
+    ASSERT_EQ(c.getIntervals().at(0).first, 10);
+    ASSERT_EQ(c.getIntervals().at(0).second, 19);
+    c.complement();
+    c.complement();
+    ASSERT_EQ(c.count(), 10);
+}
+
+TEST_F(TestIntervalSampler, single_var_bounds) {
+    VSC_DATACLASSES(TestIntervalSampler_single_var_bounds, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint8_t 
+            b : vdc.rand_int8_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a > 2
+                self.a < 15
+                self.a != 7
+                self.b >= -5
+                self.b < 5
+    )");
+    #include "TestIntervalSampler_single_var_bounds.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    ICompoundSolverUP solver(m_factory->mkCompoundSolver());
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+    std::set<uint64_t> a_s;
+    std::set<int64_t> b_s;
+
+    for (uint32_t i=0; i<1000; i++) {
+        ASSERT_TRUE(solver->randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        dm::ValRefStruct field_v(field->getImmVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        dm::ValRefInt val_b(field_v.getFieldRef(1));
+        ASSERT_GT(val_a.get_val_u(), 2);
+        ASSERT_LT(val_a.get_val_u(), 15);
+        ASSERT_NE(val_a.get_val_u(), 7);
+        ASSERT_GE(val_b.get_val_s(), -5);
+        ASSERT_LT(val_b.get_val_s(), 5);
+        a_s.insert(val_a.get_val_u());
+        b_s.insert(val_b.get_val_s());
+    }
+
+    // Every legal value is produced
+    ASSERT_EQ(a_s.size(), 11);
+    ASSERT_EQ(b_s.size(), 10);
+
+    // No backend solve calls were made
+    ASSERT_EQ(solver->getStats().getPhase(SolverStatsPhase::Solve).count(), 0);
+}
+
+TEST_F(TestIntervalSampler, rangelist) {
+    VSC_DATACLASSES(TestIntervalSampler_rangelist, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint8_t 
+            b : vdc.rand_int8_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a in vdc.rangelist(1, 2, [4, 8], 12)
+                self.a != 6
+                self.b in vdc.rangelist([-4, -2], 3)
+    )");
+    #include "TestIntervalSampler_rangelist.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    ICompoundSolverUP solver(m_factory->mkCompoundSolver());
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+    std::set<uint64_t> a_s;
+    std::set<int64_t> b_s;
+
+    for (uint32_t i=0; i<1000; i++) {
+        ASSERT_TRUE(solver->randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        dm::ValRefStruct field_v(field->getImmVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        dm::ValRefInt val_b(field_v.getFieldRef(1));
+        a_s.insert(val_a.get_val_u());
+        b_s.insert(val_b.get_val_s());
+    }
+
+    // Every listed value, and only those, is produced
+    ASSERT_EQ(a_s, std::set<uint64_t>({1, 2, 4, 5, 7, 8, 12}));
+    ASSERT_EQ(b_s, std::set<int64_t>({-4, -3, -2, 3}));
+
+    // No backend solve calls were made
+    ASSERT_EQ(solver->getStats().getPhase(SolverStatsPhase::Solve).count(), 0);
+}
+
+}
+}
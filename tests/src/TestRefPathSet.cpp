@@ -18,11 +18,32 @@
  * Created on:
  *     Author:
  */
+#include <stdlib.h>
+#include <new>
 #include "TestRefPathSet.h"
 #include "vsc/solvers/impl/RefPathSet.h"
 #include "vsc/solvers/impl/RefPathMap.h"
 #include "vsc/solvers/impl/RefPathPtrMap.h"
 
+// Counts heap allocations made by the test binary while enabled
+static bool         s_count_allocs = false;
+static uint64_t     s_num_allocs = 0;
+
+void *operator new(size_t sz) {
+    if (s_count_allocs) {
+        s_num_allocs++;
+    }
+    void *ret = malloc((sz)?sz:1);
+    if (!ret) {
+        throw std::bad_alloc();
+    }
+    return ret;
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
 
 namespace vsc {
 namespace solvers {
@@ -196,5 +217,231 @@ TEST_F(TestRefPathSet, single_level_path_ptr) {
 //    ASSERT_EQ(v, 1);
 }
 
+TEST_F(TestRefPathSet, reset_keeps_capacity) {
+    RefPathArena arena;
+    RefPathSet pset(&arena);
+
+    for (int32_t i=0; i<1000; i++) {
+        ASSERT_TRUE(pset.add({0, i%10, i}));
+    }
+    size_t capacity = arena.capacity();
+    ASSERT_TRUE(capacity > 0);
+
+    for (uint32_t n=0; n<10; n++) {
+        arena.reset();
+        pset.reset();
+        ASSERT_TRUE(pset.empty());
+        ASSERT_FALSE(pset.find({0, 1, 1}));
+        for (int32_t i=0; i<1000; i++) {
+            ASSERT_TRUE(pset.add({0, i%10, i}));
+        }
+        ASSERT_EQ(pset.size(), 1000);
+        ASSERT_EQ(arena.capacity(), capacity);
+    }
+}
+
+TEST_F(TestRefPathSet, map_reset) {
+    RefPathMap<int32_t>     m;
+    int32_t                 v;
+
+    for (int32_t i=0; i<100; i++) {
+        ASSERT_TRUE(m.add({1, i}, i));
+    }
+    m.reset();
+    ASSERT_EQ(m.size(), 0);
+    ASSERT_FALSE(m.find({1, 1}, v));
+    ASSERT_TRUE(m.add({1, 1}, 2));
+    ASSERT_TRUE(m.find({1, 1}, v));
+    ASSERT_EQ(v, 2);
+
+    RefPathPtrMap<int32_t>  pm;
+    ASSERT_TRUE(pm.add({1, 2}, &v));
+    pm.reset();
+    ASSERT_EQ(pm.find({1, 2}), (int32_t *)0);
+}
+
+TEST_F(TestRefPathSet, foreach_matches_iterator) {
+    RefPathSet pset;
+    RefPathMap<int32_t> m;
+
+    for (int32_t i=0; i<500; i++) {
+        std::vector<int32_t> path;
+        for (int32_t j=0; j<(i%4); j++) {
+            path.push_back((i*7+j)%5);
+        }
+        path.push_back(i%130);
+        pset.add(path);
+        m.add(path, path.size());
+    }
+
+    std::vector<std::vector<int32_t>> it_l, fe_l;
+    for (RefPathSet::iterator it=pset.begin(); it.next(); ) {
+        it_l.push_back(it.path());
+    }
+    pset.forEach([&fe_l](const int32_t *path, uint32_t depth) {
+        fe_l.push_back(std::vector<int32_t>(path, path+depth));
+    });
+    ASSERT_EQ(static_cast<int32_t>(it_l.size()), pset.size());
+    ASSERT_TRUE(it_l == fe_l);
+
+    it_l.clear();
+    fe_l.clear();
+    for (RefPathMap<int32_t>::iterator it=m.begin(); it.next(); ) {
+        ASSERT_EQ(it.value(), static_cast<int32_t>(it.path().size()));
+        it_l.push_back(it.path());
+    }
+    m.forEach([&fe_l](const int32_t *path, uint32_t depth, int32_t value) {
+        ASSERT_EQ(value, static_cast<int32_t>(depth));
+        fe_l.push_back(std::vector<int32_t>(path, path+depth));
+    });
+    ASSERT_TRUE(it_l == fe_l);
+}
+
+TEST_F(TestRefPathSet, iterate_no_alloc) {
+    RefPathSet pset;
+    RefPathMap<int32_t> m;
+
+    for (int32_t i=0; i<10000; i++) {
+        ASSERT_TRUE(pset.add({i%7, i%3, i}));
+        ASSERT_TRUE(m.add({i%7, i%3, i}, i));
+    }
+
+    uint64_t count = 0;
+    s_num_allocs = 0;
+    s_count_allocs = true;
+    for (uint32_t n=0; n<100; n++) {
+        pset.forEach([&count](const int32_t *path, uint32_t depth) {
+            count += path[depth-1];
+        });
+        m.forEach([&count](const int32_t *path, uint32_t depth, int32_t value) {
+            count += value;
+        });
+    }
+    s_count_allocs = false;
+    ASSERT_EQ(s_num_allocs, 0);
+
+    // Neither creating nor advancing the iterator allocates
+    s_num_allocs = 0;
+    s_count_allocs = true;
+    for (RefPathSet::iterator it=pset.begin(); it.next(); ) {
+        count += it.data()[it.depth()-1];
+    }
+    for (RefPathMap<int32_t>::iterator it=m.begin(); it.next(); ) {
+        count += it.value() + it.data()[it.depth()-1];
+    }
+    s_count_allocs = false;
+    ASSERT_EQ(s_num_allocs, 0);
+
+    // The vector form of the path re-uses its buffer
+    RefPathSet::iterator it = pset.begin();
+    ASSERT_TRUE(it.next());
+    count += it.path().back();
+    s_num_allocs = 0;
+    s_count_allocs = true;
+    while (it.next()) {
+        count += it.path().back();
+    }
+    s_count_allocs = false;
+    ASSERT_EQ(s_num_allocs, 0);
+    ASSERT_TRUE(count > 0);
+}
+
+TEST_F(TestRefPathSet, remove) {
+    RefPathSet pset;
+
+    ASSERT_TRUE(pset.add({0, 1, 2}));
+    ASSERT_TRUE(pset.add({0, 1, 3}));
+    ASSERT_TRUE(pset.remove({0, 1, 2}));
+    ASSERT_FALSE(pset.remove({0, 1, 2}));
+    ASSERT_FALSE(pset.find({0, 1, 2}));
+    ASSERT_TRUE(pset.find({0, 1, 3}));
+    ASSERT_EQ(pset.size(), 1);
+}
+
+TEST_F(TestRefPathSet, bulk_ops) {
+    RefPathSet a, b;
+
+    // 'a' holds even leaf indices and 'b' multiples of three, 
+    // across paths that end at different depths
+    for (int32_t i=0; i<300; i++) {
+        if (!(i%2)) {
+            ASSERT_TRUE(a.add({1, i}));
+            ASSERT_TRUE(a.add({2, 4, i}));
+        }
+        if (!(i%3)) {
+            ASSERT_TRUE(b.add({1, i}));
+            ASSERT_TRUE(b.add({i}));
+        }
+    }
+
+    RefPathSet r;
+    r.setUnion(a, b);
+    ASSERT_EQ(r.size(), 200+150+100);
+    ASSERT_EQ(r.popcount(), r.size());
+    ASSERT_TRUE(a.isSubsetOf(r));
+    ASSERT_TRUE(b.isSubsetOf(r));
+    ASSERT_FALSE(r.isSubsetOf(a));
+
+    r.setIntersection(a, b);
+    ASSERT_EQ(r.size(), 50);
+    ASSERT_TRUE(r.find({1, 6}));
+    ASSERT_FALSE(r.find({1, 4}));
+    ASSERT_FALSE(r.find({6}));
+    ASSERT_TRUE(r.isSubsetOf(a));
+    ASSERT_TRUE(r.isSubsetOf(b));
+
+    r.setDifference(a, b);
+    ASSERT_EQ(r.size(), 150+100);
+    ASSERT_TRUE(r.find({1, 4}));
+    ASSERT_FALSE(r.find({1, 6}));
+    ASSERT_TRUE(r.find({2, 4, 6}));
+
+    // In-place, (a-b) | (a&b) == a
+    RefPathSet c;
+    c.setIntersection(a, b);
+    r.unionWith(c);
+    ASSERT_TRUE(r.isSubsetOf(a));
+    ASSERT_TRUE(a.isSubsetOf(r));
+    r.subtract(a);
+    ASSERT_TRUE(r.empty());
+    ASSERT_EQ(r.popcount(), 0);
+}
+
+TEST_F(TestRefPathSet, empty_before_add) {
+    RefPathArena arena;
+    RefPathSet shared(&arena);
+    RefPathSet a, b;
+    int32_t n = 0;
+
+    // Nothing is allocated until the first add
+    ASSERT_EQ(arena.capacity(), 0);
+    ASSERT_FALSE(shared.find({1, 2}));
+    ASSERT_FALSE(shared.remove({1}));
+    ASSERT_FALSE(shared.begin().next());
+    shared.forEach([&](const int32_t *path, uint32_t depth) { n++; });
+    ASSERT_EQ(n, 0);
+    shared.intersectWith(a);
+    shared.subtract(a);
+    shared.unionWith(a);
+    ASSERT_TRUE(shared.isSubsetOf(a));
+    ASSERT_EQ(arena.capacity(), 0);
+
+    // Empty sets still combine with populated ones
+    b.add({0});
+    b.add({1, 2});
+    b.add({1, 2, 3});
+    a.intersectWith(b);
+    ASSERT_TRUE(a.empty());
+    a.unionWith(b);
+    ASSERT_EQ(a.size(), 3);
+    ASSERT_TRUE(a.find({1, 2, 3}));
+
+    ASSERT_TRUE(shared.add({4}));
+    ASSERT_TRUE(arena.capacity() > 0);
+    shared.reset();
+    ASSERT_TRUE(shared.empty());
+    ASSERT_FALSE(shared.find({4}));
+}
+
 }
 }
@@ -0,0 +1,142 @@
+/*
+ * TestRefPathSnapshot.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <thread>
+#include "TestRefPathSnapshot.h"
+#include "vsc/solvers/impl/RefPathSnapshot.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+TestRefPathSnapshot::TestRefPathSnapshot() {
+
+}
+
+TestRefPathSnapshot::~TestRefPathSnapshot() {
+
+}
+
+TEST_F(TestRefPathSnapshot, persistent) {
+    RefPathSnapshot s0;
+    RefPathSnapshot s1 = s0.add({0, 1, 2});
+    RefPathSnapshot s2 = s1.add({0, 1, 3}).add({4});
+    RefPathSnapshot s3 = s2.remove({0, 1, 2});
+
+    ASSERT_TRUE(s0.empty());
+    ASSERT_EQ(s1.size(), 1);
+    ASSERT_TRUE(s1.find({0, 1, 2}));
+    ASSERT_FALSE(s1.find({0, 1, 3}));
+    ASSERT_EQ(s2.size(), 3);
+    ASSERT_TRUE(s2.find({4}));
+    ASSERT_EQ(s3.size(), 2);
+    ASSERT_FALSE(s3.find({0, 1, 2}));
+    ASSERT_TRUE(s2.find({0, 1, 2}));
+
+    // Adding an existing path returns an equal snapshot
+    ASSERT_TRUE(s2.add({4}) == s2);
+}
+
+TEST_F(TestRefPathSnapshot, hash_order_independent) {
+    RefPathSnapshot a, b;
+
+    for (int32_t i=0; i<100; i++) {
+        a = a.add({i%3, i});
+        b = b.add({(99-i)%3, 99-i});
+    }
+    ASSERT_EQ(a.hash(), b.hash());
+    ASSERT_TRUE(a == b);
+
+    RefPathSnapshot c = a.remove({0, 0});
+    ASSERT_NE(c.hash(), a.hash());
+    ASSERT_TRUE(c != a);
+    ASSERT_TRUE(c.add({0, 0}) == a);
+    ASSERT_EQ(c.add({0, 0}).hash(), a.hash());
+
+    // Removing every path returns to the empty hash
+    for (int32_t i=0; i<100; i++) {
+        a = a.remove({i%3, i});
+    }
+    ASSERT_TRUE(a == RefPathSnapshot());
+    ASSERT_EQ(a.hash(), RefPathSnapshot().hash());
+}
+
+TEST_F(TestRefPathSnapshot, set_round_trip) {
+    RefPathSet set;
+
+    for (int32_t i=0; i<500; i++) {
+        set.add({i%5, i%7, i});
+    }
+
+    RefPathSnapshot s = RefPathSnapshot::fromSet(set);
+    ASSERT_EQ(s.size(), set.size());
+
+    RefPathSnapshot s2;
+    set.forEach([&s2](const int32_t *path, uint32_t depth) {
+        s2 = s2.add(std::vector<int32_t>(path, path+depth));
+    });
+    ASSERT_TRUE(s == s2);
+
+    RefPathSet set2;
+    s.toSet(set2);
+    ASSERT_EQ(set2.size(), set.size());
+    ASSERT_TRUE(set2.isSubsetOf(set));
+}
+
+TEST_F(TestRefPathSnapshot, concurrent_read) {
+    RefPathSnapshot base;
+
+    for (int32_t i=0; i<1000; i++) {
+        base = base.add({i%5, i});
+    }
+
+    // Each thread reads the shared snapshot and derives its own variants
+    std::vector<int32_t> errors(8, 0);
+    std::vector<std::thread> threads;
+    for (int32_t t=0; t<8; t++) {
+        threads.push_back(std::thread([&base, &errors, t]() {
+            for (int32_t i=0; i<100; i++) {
+                RefPathSnapshot v = base.add({9, t, i});
+                int32_t count = 0;
+                base.forEach([&count](const int32_t *path, uint32_t depth) {
+                    count++;
+                });
+                if (!v.find({9, t, i}) || base.find({9, t, i}) 
+                        || v.size() != 1001 || count != 1000) {
+                    errors.at(t)++;
+                }
+            }
+        }));
+    }
+    for (std::vector<std::thread>::iterator
+        it=threads.begin();
+        it!=threads.end(); it++) {
+        it->join();
+    }
+
+    for (int32_t t=0; t<8; t++) {
+        ASSERT_EQ(errors.at(t), 0);
+    }
+    ASSERT_EQ(base.size(), 1000);
+}
+
+}
+}
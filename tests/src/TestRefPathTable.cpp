@@ -0,0 +1,65 @@
+/*
+ * TestRefPathTable.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "TestRefPathTable.h"
+#include "RefPathTable.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+TestRefPathTable::TestRefPathTable() {
+
+}
+
+TestRefPathTable::~TestRefPathTable() {
+
+}
+
+TEST_F(TestRefPathTable, intern_find) {
+    RefPathTable table;
+
+    ASSERT_EQ(table.find({0, 1}), -1);
+    ASSERT_EQ(table.intern({0, 1}), 0);
+    ASSERT_EQ(table.intern({0, 2}), 1);
+    ASSERT_EQ(table.intern({3}), 2);
+    ASSERT_EQ(table.intern({0, 1}), 0);
+    ASSERT_EQ(table.find({0, 2}), 1);
+    ASSERT_EQ(table.size(), 3);
+}
+
+TEST_F(TestRefPathTable, reverse_lookup) {
+    RefPathTable table;
+
+    for (int32_t i=0; i<1000; i++) {
+        ASSERT_EQ(table.intern({1, i%10, i}), i);
+    }
+    for (int32_t i=0; i<1000; i++) {
+        const std::vector<int32_t> &path = table.getPath(i);
+        ASSERT_EQ(path.size(), 3);
+        ASSERT_EQ(path.at(1), i%10);
+        ASSERT_EQ(path.at(2), i);
+        ASSERT_EQ(table.find(path), i);
+    }
+}
+
+}
+}
@@ -0,0 +1,219 @@
+/*
+ * TestSolvePlanCache.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "TestSolvePlanCache.h"
+#include "SolvePlanCache.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+TestSolvePlanCache::TestSolvePlanCache() {
+
+}
+
+TestSolvePlanCache::~TestSolvePlanCache() {
+
+}
+
+TEST_F(TestSolvePlanCache, hit_miss) {
+    VSC_DATACLASSES(TestSolvePlanCache_hit_miss, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint32_t 
+            b : vdc.rand_uint32_t 
+            c : vdc.rand_uint32_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+    )");
+    #include "TestSolvePlanCache_hit_miss.h"
+
+    enableDebug(false);
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+
+    vsc::dm::IModelFieldUP field1(mkRootField("abc1", MyC_t));
+    vsc::dm::IModelFieldUP field2(mkRootField("abc2", MyC_t));
+
+    SolvePlanCache cache(m_factory->getDebugMgr());
+
+    SolvePlan *plan1 = cache.getPlan(
+        field1.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints);
+    ASSERT_EQ(cache.getNumMisses(), 1);
+    ASSERT_EQ(cache.getNumHits(), 0);
+    ASSERT_EQ(plan1->getSolveSets().size(), 1);
+    ASSERT_EQ(plan1->getUnconstrained().size(), 1);
+
+    // Same type and sets, different instance: plan is shared
+    SolvePlan *plan2 = cache.getPlan(
+        field2.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints);
+    ASSERT_EQ(plan1, plan2);
+    ASSERT_EQ(cache.getNumMisses(), 1);
+    ASSERT_EQ(cache.getNumHits(), 1);
+
+    // Changing one of the sets produces a new plan
+    fixed_fields.add({0});
+    SolvePlan *plan3 = cache.getPlan(
+        field1.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints);
+    ASSERT_NE(plan1, plan3);
+    ASSERT_EQ(cache.getNumMisses(), 2);
+    ASSERT_EQ(cache.size(), 2);
+}
+
+TEST_F(TestSolvePlanCache, snapshot) {
+    VSC_DATACLASSES(TestSolvePlanCache_snapshot, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint32_t 
+            b : vdc.rand_uint32_t 
+            c : vdc.rand_uint32_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+    )");
+    #include "TestSolvePlanCache_snapshot.h"
+
+    enableDebug(false);
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    RefPathSnapshot empty;
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    SolvePlanCache cache(m_factory->getDebugMgr());
+
+    SolvePlan *plan1 = cache.getPlan(
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints);
+
+    // Snapshots of the same content share the plan built from path sets
+    SolvePlan *plan2 = cache.getPlan(field.get(), empty, empty, empty, empty);
+    ASSERT_EQ(plan1, plan2);
+    ASSERT_EQ(cache.getNumMisses(), 1);
+    ASSERT_EQ(cache.getNumHits(), 1);
+
+    SolvePlan *plan3 = cache.getPlan(field.get(), empty, empty, empty, empty);
+    ASSERT_EQ(plan1, plan3);
+    ASSERT_EQ(cache.getNumHits(), 2);
+
+    // A derived snapshot keys a new plan
+    RefPathSnapshot fixed = empty.add({0});
+    SolvePlan *plan4 = cache.getPlan(field.get(), empty, fixed, empty, empty);
+    ASSERT_NE(plan1, plan4);
+    ASSERT_EQ(cache.getNumMisses(), 2);
+    ASSERT_EQ(cache.size(), 2);
+
+    // Equal content built in a different way is a hit
+    SolvePlan *plan5 = cache.getPlan(field.get(), empty, 
+        empty.add({0}).add({1}).remove({1}), empty, empty);
+    ASSERT_EQ(plan4, plan5);
+    ASSERT_EQ(cache.getNumMisses(), 2);
+}
+
+TEST_F(TestSolvePlanCache, evict_lru) {
+    VSC_DATACLASSES(TestSolvePlanCache_evict_lru, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint32_t 
+            b : vdc.rand_uint32_t 
+            c : vdc.rand_uint32_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+    )");
+    #include "TestSolvePlanCache_evict_lru.h"
+
+    enableDebug(false);
+    RefPathSet target_fields, include_constraints, exclude_constraints;
+    RefPathSet fixed_a, fixed_b, fixed_c;
+    fixed_a.add({0});
+    fixed_b.add({1});
+    fixed_c.add({2});
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    SolvePlanCache cache(m_factory->getDebugMgr(), 2);
+    std::vector<SolvePlan *> evicted;
+    cache.setEvictListener([&evicted](SolvePlan *plan) {
+        evicted.push_back(plan);
+    });
+
+    SolvePlan *plan_a = cache.getPlan(field.get(), 
+        target_fields, fixed_a, include_constraints, exclude_constraints);
+    SolvePlan *plan_b = cache.getPlan(field.get(), 
+        target_fields, fixed_b, include_constraints, exclude_constraints);
+
+    // Using 'a' makes 'b' the least-recently used
+    ASSERT_EQ(plan_a, cache.getPlan(field.get(), 
+        target_fields, fixed_a, include_constraints, exclude_constraints));
+    cache.getPlan(field.get(), 
+        target_fields, fixed_c, include_constraints, exclude_constraints);
+
+    ASSERT_EQ(cache.size(), 2);
+    ASSERT_EQ(cache.getNumEvictions(), 1);
+    ASSERT_EQ(evicted.size(), 1);
+    ASSERT_EQ(evicted.at(0), plan_b);
+    // Other plans of the type still reference the dependency graph
+    ASSERT_EQ(cache.getNumDepGraphs(), 1);
+
+    cache.getPlan(field.get(), 
+        target_fields, fixed_b, include_constraints, exclude_constraints);
+    ASSERT_EQ(cache.getNumMisses(), 4);
+    ASSERT_EQ(cache.size(), 2);
+
+    // Snapshot entries are evicted along with their plan
+    RefPathSnapshot empty;
+    cache.getPlan(field.get(), empty, empty, empty, empty);
+    cache.getPlan(field.get(), empty, empty.add({0}), empty, empty);
+    cache.getPlan(field.get(), empty, empty.add({1}), empty, empty);
+    uint64_t misses = cache.getNumMisses();
+    cache.getPlan(field.get(), empty, empty, empty, empty);
+    ASSERT_EQ(cache.getNumMisses(), misses+1);
+    ASSERT_EQ(cache.size(), 2);
+
+    evicted.clear();
+    cache.clear();
+    ASSERT_EQ(evicted.size(), 2);
+    ASSERT_EQ(cache.getNumDepGraphs(), 0);
+    ASSERT_EQ(cache.getNumEvictions(), 0);
+    ASSERT_EQ(cache.getNumHits(), 0);
+    ASSERT_EQ(cache.getNumMisses(), 0);
+}
+
+}
+}
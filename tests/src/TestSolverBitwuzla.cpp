@@ -0,0 +1,345 @@
+/*
+ * TestSolverBitwuzla.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <set>
+#include "TestSolverBitwuzla.h"
+#include "SolvePlanCache.h"
+#include "CompoundSolver.h"
+#include "Factory.h"
+#include "SolverFactoryBitwuzla.h"
+#include "ValRefIntWords.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+TestSolverBitwuzla::TestSolverBitwuzla() {
+
+}
+
+TestSolverBitwuzla::~TestSolverBitwuzla() {
+
+}
+
+TEST_F(TestSolverBitwuzla, ult_2var) {
+    VSC_DATACLASSES(TestSolverBitwuzla_ult_2var, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint8_t 
+            b : vdc.rand_uint8_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+    )");
+    #include "TestSolverBitwuzla_ult_2var.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    SolverFactoryBitwuzla solver_f(m_factory->getDebugMgr());
+    CompoundSolver solver(m_factory->getDebugMgr(), &solver_f);
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    for (uint32_t i=0; i<100; i++) {
+        ASSERT_TRUE(solver.randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        dm::ValRefStruct field_v(field->getImmVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        dm::ValRefInt val_b(field_v.getFieldRef(1));
+        ASSERT_LT(val_a.get_val_u(), val_b.get_val_u());
+    }
+    ASSERT_EQ(solver.getStats().getNumBackends(), 1);
+    ASSERT_EQ(solver.getStats().getBackendName(0), "bitwuzla");
+}
+
+TEST_F(TestSolverBitwuzla, mul_fixed) {
+    VSC_DATACLASSES(TestSolverBitwuzla_mul_fixed, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint32_t 
+            b : vdc.rand_uint32_t 
+            c : vdc.rand_uint32_t 
+
+            @vdc.constraint
+            def abc_c(self):
+                self.a * self.b == self.c
+                self.a > 1
+                self.a < 256
+                self.b > 1
+                self.b < 256
+    )");
+    #include "TestSolverBitwuzla_mul_fixed.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    SolverFactoryBitwuzla solver_f(m_factory->getDebugMgr());
+    CompoundSolver solver(m_factory->getDebugMgr(), &solver_f);
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    fixed_fields.add({2});
+
+    // Factor a fixed product, re-binding 'c' on each call
+    for (uint32_t i=0; i<20; i++) {
+        dm::ValRefStruct field_v(field->getMutVal());
+        dm::ValRefInt val_c(field_v.getFieldRef(2));
+        val_c.set_val(6*(i+1));
+        ASSERT_TRUE(solver.randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        dm::ValRefInt val_b(field_v.getFieldRef(1));
+        ASSERT_EQ(val_a.get_val_u()*val_b.get_val_u(), 6*(i+1));
+    }
+
+    // 7 is prime, so there is no factorization with both factors > 1
+    dm::ValRefStruct field_v(field->getMutVal());
+    dm::ValRefInt val_c(field_v.getFieldRef(2));
+    val_c.set_val(7);
+    ASSERT_FALSE(solver.sat(
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints,
+        flags));
+}
+
+TEST_F(TestSolverBitwuzla, wide_fixed) {
+    VSC_DATACLASSES(TestSolverBitwuzla_wide_fixed, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand[vdc.bit_t[96]] 
+            b : vdc.rand[vdc.bit_t[96]] 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.b > self.a
+                self.b < self.a + 16
+                self.b != (1 << 80) + 11
+    )");
+    #include "TestSolverBitwuzla_wide_fixed.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    SolverFactoryBitwuzla solver_f(m_factory->getDebugMgr());
+    CompoundSolver solver(m_factory->getDebugMgr(), &solver_f);
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    fixed_fields.add({0});
+
+    // Bits above 64 must be carried through the fixed value, the 
+    // literal, and the value written back
+    uint64_t a_w[2] = {10, 1ULL << 16};
+    uint64_t b_w[2];
+    for (uint32_t i=0; i<20; i++) {
+        dm::ValRefStruct field_v(field->getMutVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        ValRefIntWords::set(val_a, a_w);
+        ASSERT_TRUE(solver.randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        dm::ValRefInt val_b(field_v.getFieldRef(1));
+        ValRefIntWords::get(val_b, 96, false, b_w);
+        ASSERT_EQ(b_w[1], a_w[1]);
+        ASSERT_GT(b_w[0], 10u);
+        ASSERT_LT(b_w[0], 26u);
+        ASSERT_NE(b_w[0], 11u);
+    }
+}
+
+TEST_F(TestSolverBitwuzla, nonlinear_routed) {
+    VSC_DATACLASSES(TestSolverBitwuzla_nonlinear_routed, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint32_t 
+            b : vdc.rand_uint32_t 
+            c : vdc.rand_uint32_t 
+            d : vdc.rand_uint32_t 
+            e : vdc.rand_uint32_t 
+
+            @vdc.constraint
+            def abc_c(self):
+                self.a * self.b == self.c
+                self.a > 1
+                self.a < 256
+                self.b > 1
+                self.b < 256
+                self.d < self.e
+    )");
+    #include "TestSolverBitwuzla_nonlinear_routed.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    Factory factory;
+    factory.init(m_factory->getDebugMgr());
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    // The 'routed' strategy sends the non-linear set to Bitwuzla, and
+    // the linear set to Boolector
+    ISolverFactoryUP routed_f(factory.mkSolverFactory("routed"));
+    CompoundSolver solver(m_factory->getDebugMgr(), routed_f.get());
+
+    for (uint32_t i=0; i<20; i++) {
+        ASSERT_TRUE(solver.randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        dm::ValRefStruct field_v(field->getImmVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        dm::ValRefInt val_b(field_v.getFieldRef(1));
+        dm::ValRefInt val_c(field_v.getFieldRef(2));
+        dm::ValRefInt val_d(field_v.getFieldRef(3));
+        dm::ValRefInt val_e(field_v.getFieldRef(4));
+        ASSERT_EQ(val_a.get_val_u()*val_b.get_val_u(), val_c.get_val_u());
+        ASSERT_LT(val_d.get_val_u(), val_e.get_val_u());
+    }
+
+    ASSERT_EQ(solver.getStats().getNumBackends(), 2);
+    ASSERT_GT(solver.getStats().getBackend("bitwuzla").count(), 0);
+    ASSERT_GT(solver.getStats().getBackend("boolector").count(), 0);
+
+    // A backend selected by name solves every set
+    ISolverFactoryUP boolector_f(factory.mkSolverFactory("boolector"));
+    CompoundSolver boolector_solver(m_factory->getDebugMgr(), boolector_f.get());
+
+    ASSERT_TRUE(boolector_solver.randomize(
+        randstate.get(),
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints,
+        flags));
+    ASSERT_EQ(boolector_solver.getStats().getNumBackends(), 1);
+    ASSERT_EQ(boolector_solver.getStats().getBackendName(0), "boolector");
+
+    // By default, Boolector solves every set
+    ISolverFactoryUP default_f(factory.mkSolverFactory(""));
+    CompoundSolver default_solver(m_factory->getDebugMgr(), default_f.get());
+
+    ASSERT_TRUE(default_solver.randomize(
+        randstate.get(),
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints,
+        flags));
+    ASSERT_EQ(default_solver.getStats().getNumBackends(), 1);
+    ASSERT_EQ(default_solver.getStats().getBackendName(0), "boolector");
+
+    ASSERT_EQ(factory.mkSolverFactory("unknown"), (ISolverFactory *)0);
+}
+
+TEST_F(TestSolverBitwuzla, rangelist) {
+    VSC_DATACLASSES(TestSolverBitwuzla_rangelist, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint8_t 
+            b : vdc.rand_uint8_t 
+            c : vdc.rand_int8_t 
+
+            @vdc.constraint
+            def abc_c(self):
+                self.a in vdc.rangelist(1, 2, [4, 8], 12)
+                self.a < self.b
+                self.b < 10
+                self.c in vdc.rangelist([-4, -2], 3)
+    )");
+    #include "TestSolverBitwuzla_rangelist.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    SolverFactoryBitwuzla solver_f(m_factory->getDebugMgr());
+    CompoundSolver solver(m_factory->getDebugMgr(), &solver_f);
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    // Membership constraints are asserted, rather than dropped
+    std::set<uint64_t> a_s;
+    std::set<int64_t> c_s;
+    for (uint32_t i=0; i<100; i++) {
+        ASSERT_TRUE(solver.randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        dm::ValRefStruct field_v(field->getImmVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        dm::ValRefInt val_b(field_v.getFieldRef(1));
+        dm::ValRefInt val_c(field_v.getFieldRef(2));
+        ASSERT_LT(val_a.get_val_u(), val_b.get_val_u());
+        ASSERT_LT(val_b.get_val_u(), 10u);
+        a_s.insert(val_a.get_val_u());
+        c_s.insert(val_c.get_val_s());
+    }
+
+    for (std::set<uint64_t>::const_iterator
+        it=a_s.begin(); it!=a_s.end(); it++) {
+        ASSERT_TRUE(*it == 1 || *it == 2 || (*it >= 4 && *it <= 8));
+    }
+    for (std::set<int64_t>::const_iterator
+        it=c_s.begin(); it!=c_s.end(); it++) {
+        ASSERT_TRUE((*it >= -4 && *it <= -2) || *it == 3);
+    }
+    ASSERT_GT(a_s.size(), 1u);
+    ASSERT_GT(c_s.size(), 1u);
+}
+
+}
+}
@@ -0,0 +1,142 @@
+/*
+ * TestSolverBoolectorConstFactory.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <string>
+#include "boolector/boolector.h"
+#include "TestSolverBoolectorConstFactory.h"
+#include "SolverBoolectorConstFactory.h"
+#include "SolverBoolectorSortCache.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+TestSolverBoolectorConstFactory::TestSolverBoolectorConstFactory() {
+
+}
+
+TestSolverBoolectorConstFactory::~TestSolverBoolectorConstFactory() {
+
+}
+
+static std::string bits(Btor *btor, BoolectorNode *n) {
+    const char *b = boolector_get_bits(btor, n);
+    std::string ret(b);
+    boolector_free_bits(btor, b);
+    return ret;
+}
+
+TEST_F(TestSolverBoolectorConstFactory, narrow) {
+    Btor *btor = boolector_new();
+    {
+        SolverBoolectorSortCache sorts(btor);
+        SolverBoolectorConstFactory const_f(btor, &sorts);
+
+        ASSERT_EQ(bits(btor, const_f.mk(1, 1)), "1");
+        ASSERT_EQ(bits(btor, const_f.mk(4, 0xA)), "1010");
+        ASSERT_EQ(bits(btor, const_f.mk(40, 0x80000001ULL)),
+            "0000000010000000000000000000000000000001");
+        ASSERT_EQ(bits(btor, const_f.mk(64, 0xF000000000000001ULL)),
+            "1111" + std::string(59, '0') + "1");
+
+        // Bits above the width are ignored
+        ASSERT_EQ(const_f.mk(4, 0xFA), const_f.mk(4, 0xA));
+
+        // Each (width, value) is created once
+        uint32_t size = const_f.size();
+        ASSERT_EQ(const_f.mk(40, 0x80000001ULL), const_f.mk(40, 0x80000001ULL));
+        ASSERT_NE(const_f.mk(8, 0xA), const_f.mk(4, 0xA));
+        ASSERT_EQ(const_f.size(), size+1);
+        sorts.release();
+    }
+    boolector_release_all(btor);
+    boolector_delete(btor);
+}
+
+TEST_F(TestSolverBoolectorConstFactory, wide) {
+    Btor *btor = boolector_new();
+    {
+        SolverBoolectorSortCache sorts(btor);
+        SolverBoolectorConstFactory const_f(btor, &sorts);
+        uint64_t words[] = {1, 0x5};
+
+        ASSERT_EQ(bits(btor, const_f.mk(68, words)),
+            "0101" + std::string(63, '0') + "1");
+        ASSERT_EQ(const_f.mk(68, words), const_f.mk(68, words));
+
+        // 64-bit values are sign- or zero-extended
+        ASSERT_EQ(bits(btor, const_f.mkExt(80, ~0ULL, true)),
+            std::string(80, '1'));
+        ASSERT_EQ(bits(btor, const_f.mkExt(80, ~0ULL, false)),
+            std::string(16, '0') + std::string(64, '1'));
+        ASSERT_EQ(bits(btor, const_f.mkExt(128, 2, true)),
+            std::string(126, '0') + "10");
+        sorts.release();
+    }
+    boolector_release_all(btor);
+    boolector_delete(btor);
+}
+
+TEST_F(TestSolverBoolectorConstFactory, trim) {
+    Btor *btor = boolector_new();
+    {
+        SolverBoolectorSortCache sorts(btor);
+        SolverBoolectorConstFactory const_f(btor, &sorts, 4);
+
+        for (uint32_t i=0; i<4; i++) {
+            const_f.mk(32, i);
+        }
+        const_f.trim();
+        ASSERT_EQ(const_f.size(), 4);
+
+        const_f.mk(32, 4);
+        const_f.trim();
+        ASSERT_EQ(const_f.size(), 0);
+        ASSERT_EQ(bits(btor, const_f.mk(32, 3)), std::string(30, '0') + "11");
+        sorts.release();
+    }
+    boolector_release_all(btor);
+    boolector_delete(btor);
+}
+
+TEST_F(TestSolverBoolectorConstFactory, sorts) {
+    Btor *btor = boolector_new();
+    {
+        SolverBoolectorSortCache sorts(btor);
+        SolverBoolectorConstFactory const_f(btor, &sorts);
+
+        // Constants of the same width share a sort
+        for (uint32_t i=0; i<16; i++) {
+            const_f.mk(8, i);
+            const_f.mk(40, i);
+        }
+        ASSERT_EQ(sorts.get(8), sorts.get(8));
+        ASSERT_EQ(sorts.size(), 2);
+
+        sorts.release();
+        ASSERT_EQ(sorts.size(), 0);
+    }
+    boolector_release_all(btor);
+    boolector_delete(btor);
+}
+
+}
+}
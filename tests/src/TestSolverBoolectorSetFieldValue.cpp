@@ -0,0 +1,71 @@
+/*
+ * TestSolverBoolectorSetFieldValue.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <string>
+#include "TestSolverBoolectorSetFieldValue.h"
+#include "SolverBoolectorSetFieldValue.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+TestSolverBoolectorSetFieldValue::TestSolverBoolectorSetFieldValue() {
+
+}
+
+TestSolverBoolectorSetFieldValue::~TestSolverBoolectorSetFieldValue() {
+
+}
+
+TEST_F(TestSolverBoolectorSetFieldValue, bits2words_narrow) {
+    uint64_t words[1];
+
+    SolverBoolectorSetFieldValue::bits2words("1", 1, words);
+    ASSERT_EQ(words[0], 1);
+
+    SolverBoolectorSetFieldValue::bits2words("1010", 4, words);
+    ASSERT_EQ(words[0], 0xA);
+
+    SolverBoolectorSetFieldValue::bits2words("100000001", 9, words);
+    ASSERT_EQ(words[0], 0x101);
+
+    std::string bits = "1111" + std::string(59, '0') + "1";
+    SolverBoolectorSetFieldValue::bits2words(bits.c_str(), 64, words);
+    ASSERT_EQ(words[0], 0xF000000000000001ULL);
+}
+
+TEST_F(TestSolverBoolectorSetFieldValue, bits2words_wide) {
+    uint64_t words[3];
+
+    std::string bits = "101" + std::string(63, '0') + "1";
+    SolverBoolectorSetFieldValue::bits2words(bits.c_str(), 67, words);
+    ASSERT_EQ(words[0], 1);
+    ASSERT_EQ(words[1], 0x5);
+
+    bits = "1" + std::string(128, '1');
+    SolverBoolectorSetFieldValue::bits2words(bits.c_str(), 129, words);
+    ASSERT_EQ(words[0], ~0ULL);
+    ASSERT_EQ(words[1], ~0ULL);
+    ASSERT_EQ(words[2], 1);
+}
+
+}
+}
@@ -0,0 +1,204 @@
+/*
+ * TestSolverBoolectorTemplate.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "TestSolverBoolectorTemplate.h"
+#include "CompoundSolver.h"
+#include "SolverFactoryBoolector.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+TestSolverBoolectorTemplate::TestSolverBoolectorTemplate() {
+
+}
+
+TestSolverBoolectorTemplate::~TestSolverBoolectorTemplate() {
+
+}
+
+TEST_F(TestSolverBoolectorTemplate, shared_across_solvers) {
+    VSC_DATACLASSES(TestSolverBoolectorTemplate_shared_across_solvers, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint8_t 
+            b : vdc.rand_uint8_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+                self.a + self.b < 100
+    )");
+    #include "TestSolverBoolectorTemplate_shared_across_solvers.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field1(mkRootField("abc1", MyC_t));
+    vsc::dm::IModelFieldUP field2(mkRootField("abc2", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    SolverFactoryBoolector solver_f(m_factory->getDebugMgr());
+    CompoundSolver solver1(m_factory->getDebugMgr(), &solver_f);
+    CompoundSolver solver2(m_factory->getDebugMgr(), &solver_f);
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    for (uint32_t i=0; i<20; i++) {
+        ASSERT_TRUE(solver1.randomize(
+            randstate.get(),
+            field1.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        ASSERT_TRUE(solver2.randomize(
+            randstate.get(),
+            field2.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+
+        dm::ValRefStruct field1_v(field1->getImmVal());
+        dm::ValRefStruct field2_v(field2->getImmVal());
+        ASSERT_LT(
+            dm::ValRefInt(field1_v.getFieldRef(0)).get_val_u(),
+            dm::ValRefInt(field1_v.getFieldRef(1)).get_val_u());
+        ASSERT_LT(
+            dm::ValRefInt(field2_v.getFieldRef(0)).get_val_u(),
+            dm::ValRefInt(field2_v.getFieldRef(1)).get_val_u());
+        ASSERT_LT(
+            dm::ValRefInt(field2_v.getFieldRef(0)).get_val_u() +
+            dm::ValRefInt(field2_v.getFieldRef(1)).get_val_u(), 100u);
+    }
+
+    // Each compound solver has its own solve sets, but the formula
+    // is only compiled once
+    ASSERT_EQ(solver_f.getTemplates().size(), 1);
+    ASSERT_EQ(solver1.getStats().getCount(SolverStatsCounter::TemplateClone), 1);
+    ASSERT_EQ(solver2.getStats().getCount(SolverStatsCounter::TemplateClone), 1);
+}
+
+TEST_F(TestSolverBoolectorTemplate, fixed_rebind) {
+    VSC_DATACLASSES(TestSolverBoolectorTemplate_fixed_rebind, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint8_t 
+            b : vdc.rand_uint8_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+    )");
+    #include "TestSolverBoolectorTemplate_fixed_rebind.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    SolverFactoryBoolector solver_f(m_factory->getDebugMgr());
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    fixed_fields.add({0});
+
+    // Each solver starts from a clone, and binds its own fixed values
+    for (uint32_t i=0; i<4; i++) {
+        CompoundSolver solver(m_factory->getDebugMgr(), &solver_f);
+        for (uint32_t j=0; j<50; j++) {
+            dm::ValRefStruct field_v(field->getMutVal());
+            dm::ValRefInt val_a(field_v.getFieldRef(0));
+            val_a.set_val(50*i+j);
+            ASSERT_TRUE(solver.randomize(
+                randstate.get(),
+                field.get(),
+                target_fields,
+                fixed_fields,
+                include_constraints,
+                exclude_constraints,
+                flags));
+            dm::ValRefInt val_b(field_v.getFieldRef(1));
+            ASSERT_EQ(val_a.get_val_u(), 50*i+j);
+            ASSERT_GT(val_b.get_val_u(), val_a.get_val_u());
+        }
+    }
+
+    ASSERT_EQ(solver_f.getTemplates().size(), 1);
+}
+
+TEST_F(TestSolverBoolectorTemplate, evict_rebuild) {
+    VSC_DATACLASSES(TestSolverBoolectorTemplate_evict_rebuild, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint8_t 
+            b : vdc.rand_uint8_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+    )");
+    #include "TestSolverBoolectorTemplate_evict_rebuild.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    SolverFactoryBoolector solver_f(m_factory->getDebugMgr());
+    CompoundSolver solver(m_factory->getDebugMgr(), &solver_f);
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    RefPathSet fixed_a;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    fixed_a.add({0});
+
+    // Both sets of fixed fields lower to the same template. Only one
+    // plan is retained, so each switch evicts the other's solve set 
+    // and drops the template with it
+    solver.getPlanCache().setMaxSize(1);
+
+    for (uint32_t i=0; i<4; i++) {
+        dm::ValRefStruct field_v(field->getMutVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        dm::ValRefInt val_b(field_v.getFieldRef(1));
+        val_a.set_val(10+i);
+        ASSERT_TRUE(solver.randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            (i%2)?fixed_a:fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        if (i%2) {
+            ASSERT_EQ(val_a.get_val_u(), 10+i);
+        }
+        ASSERT_LT(val_a.get_val_u(), val_b.get_val_u());
+        ASSERT_EQ(solver_f.getTemplates().size(), 1);
+    }
+
+    ASSERT_EQ(solver.getPlanCache().getNumEvictions(), 3);
+    ASSERT_EQ(solver_f.getTemplates().getNumMisses(), 4);
+    ASSERT_EQ(solver_f.getTemplates().getNumHits(), 0);
+}
+
+}
+}
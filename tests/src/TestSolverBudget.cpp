@@ -0,0 +1,177 @@
+/*
+ * TestSolverBudget.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "TestSolverBudget.h"
+#include "vsc/solvers/SolverBudget.h"
+#include "CompoundSolver.h"
+#include "SolverFactoryBoolector.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+TestSolverBudget::TestSolverBudget() {
+
+}
+
+TestSolverBudget::~TestSolverBudget() {
+
+}
+
+TEST_F(TestSolverBudget, timeout_fail) {
+    VSC_DATACLASSES(TestSolverBudget_timeout_fail, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint64_t 
+            b : vdc.rand_uint64_t 
+            c : vdc.rand_uint64_t 
+
+            @vdc.constraint
+            def abc_c(self):
+                self.a * self.b == self.c
+                self.a > 1
+                self.a < 4294967296
+                self.b > 1
+                self.b < 4294967296
+    )");
+    #include "TestSolverBudget_timeout_fail.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    ICompoundSolverUP solver(m_factory->mkCompoundSolver());
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    fixed_fields.add({2});
+
+    // Factoring the product of the two largest 32-bit primes
+    // takes far longer than the budget
+    solver->setBudget(SolverBudget(1, 5, SolverFallback::Fail));
+    dm::ValRefStruct field_v(field->getMutVal());
+    dm::ValRefInt val_c(field_v.getFieldRef(2));
+    val_c.set_val(4294967291ULL*4294967279ULL);
+    ASSERT_FALSE(solver->randomize(
+        randstate.get(),
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints,
+        flags));
+    ASSERT_GE(solver->getStats().getCount(SolverStatsCounter::Timeout), 1u);
+    ASSERT_EQ(solver->getStats().getCount(SolverStatsCounter::Fallback), 0u);
+    ASSERT_EQ(solver->getStats().getCount(SolverStatsCounter::Unsat), 0u);
+
+    // The solver remains usable once the budget is lifted
+    solver->setBudget(SolverBudget());
+    val_c.set_val(6);
+    ASSERT_TRUE(solver->randomize(
+        randstate.get(),
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints,
+        flags));
+    dm::ValRefInt val_a(field_v.getFieldRef(0));
+    dm::ValRefInt val_b(field_v.getFieldRef(1));
+    ASSERT_EQ(val_a.get_val_u()*val_b.get_val_u(), 6u);
+}
+
+TEST_F(TestSolverBudget, conflict_limit) {
+    VSC_DATACLASSES(TestSolverBudget_conflict_limit, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint64_t 
+            b : vdc.rand_uint64_t 
+            c : vdc.rand_uint64_t 
+
+            @vdc.constraint
+            def abc_c(self):
+                self.a * self.b == self.c
+                self.a > 1
+                self.a < 4294967296
+                self.b > 1
+                self.b < 4294967296
+    )");
+    #include "TestSolverBudget_conflict_limit.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    // Only Boolector enforces conflict limits, so the backend is
+    // selected explicitly rather than by the default routing
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    SolverFactoryBoolector solver_f(m_factory->getDebugMgr());
+    CompoundSolver solver(m_factory->getDebugMgr(), &solver_f);
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    fixed_fields.add({2});
+
+    // Factoring the product of the two largest 32-bit primes
+    // takes far more conflicts than the budget
+    solver.setBudget(SolverBudget(0, 0, SolverFallback::Fail, 100));
+    dm::ValRefStruct field_v(field->getMutVal());
+    dm::ValRefInt val_c(field_v.getFieldRef(2));
+    val_c.set_val(4294967291ULL*4294967279ULL);
+    ASSERT_FALSE(solver.randomize(
+        randstate.get(),
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints,
+        flags));
+    ASSERT_GE(solver.getStats().getCount(SolverStatsCounter::Timeout), 1u);
+    ASSERT_EQ(solver.getStats().getCount(SolverStatsCounter::Fallback), 0u);
+
+    // A check that runs out of budget has an unknown result, which
+    // is not counted as UNSAT
+    ASSERT_FALSE(solver.sat(
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints,
+        flags));
+    ASSERT_EQ(solver.getStats().getCount(SolverStatsCounter::Unsat), 0u);
+
+    // The solver remains usable once the budget is lifted
+    solver.setBudget(SolverBudget());
+    val_c.set_val(6);
+    ASSERT_TRUE(solver.randomize(
+        randstate.get(),
+        field.get(),
+        target_fields,
+        fixed_fields,
+        include_constraints,
+        exclude_constraints,
+        flags));
+    dm::ValRefInt val_a(field_v.getFieldRef(0));
+    dm::ValRefInt val_b(field_v.getFieldRef(1));
+    ASSERT_EQ(val_a.get_val_u()*val_b.get_val_u(), 6u);
+}
+
+}
+}
@@ -0,0 +1,147 @@
+/*
+ * TestSolverPortfolio.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <thread>
+#include "TestSolverPortfolio.h"
+#include "CompoundSolver.h"
+#include "SolverFactoryBitwuzla.h"
+#include "SolverFactoryBoolector.h"
+#include "SolverFactoryPortfolio.h"
+#include "SolverPortfolio.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+TestSolverPortfolio::TestSolverPortfolio() {
+
+}
+
+TestSolverPortfolio::~TestSolverPortfolio() {
+
+}
+
+/**
+ * Racer that answers immediately when 'fast', and otherwise
+ * spins until another racer claims the race
+ */
+class RacerSolver : public virtual ISolver {
+public:
+    RacerSolver(bool fast, uint32_t &n_calls) : 
+        m_fast(fast), m_n_calls(n_calls), m_race(0), m_id(-1) { }
+
+    virtual SolverResult randomize(
+        IRandState                              *randstate,
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) override {
+        return sat(root_field, solveset);
+    }
+
+    virtual SolverResult sat(
+        dm::IModelField                         *root_field,
+        ISolveSet                               *solveset) override {
+        m_n_calls++;
+        if (!m_fast) {
+            while (m_race && !m_race->done()) {
+                std::this_thread::yield();
+            }
+        }
+        return (!m_race || m_race->claim(m_id))?
+            SolverResult::Sat:SolverResult::Unsat;
+    }
+
+    virtual void setRace(SolverRace *race, int32_t id) override {
+        m_race = race;
+        m_id = id;
+    }
+
+private:
+    bool                m_fast;
+    uint32_t            &m_n_calls;
+    SolverRace          *m_race;
+    int32_t             m_id;
+};
+
+TEST_F(TestSolverPortfolio, winner_remembered) {
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    uint32_t n_slow = 0, n_fast = 0;
+
+    SolverPortfolio solver(m_factory->getDebugMgr());
+    solver.addSolver(new RacerSolver(false, n_slow));
+    solver.addSolver(new RacerSolver(true, n_fast));
+
+    ASSERT_EQ(solver.getWinner(), -1);
+    ASSERT_EQ(solver.randomize(randstate.get(), 0, 0), SolverResult::Sat);
+    ASSERT_EQ(solver.getWinner(), 1);
+    ASSERT_EQ(n_slow, 1u);
+    ASSERT_EQ(n_fast, 1u);
+
+    // Later calls skip the race, and only use the winner
+    for (uint32_t i=0; i<10; i++) {
+        ASSERT_EQ(solver.randomize(randstate.get(), 0, 0), SolverResult::Sat);
+        ASSERT_EQ(solver.sat(0, 0), SolverResult::Sat);
+    }
+    ASSERT_EQ(n_slow, 1u);
+    ASSERT_EQ(n_fast, 21u);
+}
+
+TEST_F(TestSolverPortfolio, ult_2var) {
+    VSC_DATACLASSES(TestSolverPortfolio_ult_2var, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint8_t 
+            b : vdc.rand_uint8_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+    )");
+    #include "TestSolverPortfolio_ult_2var.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    SolverFactoryPortfolio solver_f(m_factory->getDebugMgr());
+    solver_f.addBackend(new SolverFactoryBoolector(m_factory->getDebugMgr()));
+    solver_f.addBackend(new SolverFactoryBitwuzla(m_factory->getDebugMgr()));
+    CompoundSolver solver(m_factory->getDebugMgr(), &solver_f);
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    for (uint32_t i=0; i<100; i++) {
+        ASSERT_TRUE(solver.randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags));
+        dm::ValRefStruct field_v(field->getImmVal());
+        dm::ValRefInt val_a(field_v.getFieldRef(0));
+        dm::ValRefInt val_b(field_v.getFieldRef(1));
+        ASSERT_LT(val_a.get_val_u(), val_b.get_val_u());
+    }
+}
+
+}
+}
@@ -0,0 +1,116 @@
+/*
+ * TestSolverStats.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "TestSolverStats.h"
+#include "vsc/solvers/SolverStats.h"
+
+
+namespace vsc {
+namespace solvers {
+
+
+TestSolverStats::TestSolverStats() {
+
+}
+
+TestSolverStats::~TestSolverStats() {
+
+}
+
+TEST_F(TestSolverStats, hist_percentile) {
+    SolverStatsHist hist;
+
+    ASSERT_EQ(hist.p50(), 0);
+
+    // 98 fast samples and 2 slow ones
+    for (uint32_t i=0; i<98; i++) {
+        hist.record(100);
+    }
+    hist.record(100000);
+    hist.record(100000);
+
+    ASSERT_EQ(hist.count(), 100);
+    ASSERT_EQ(hist.max(), 100000);
+    // Bucket upper bounds: 100 is in [64,127]
+    ASSERT_EQ(hist.p50(), 127);
+    ASSERT_EQ(hist.p99(), 131071);
+
+    hist.reset();
+    ASSERT_EQ(hist.count(), 0);
+    ASSERT_EQ(hist.p99(), 0);
+}
+
+TEST_F(TestSolverStats, phases) {
+    VSC_DATACLASSES(TestSolverStats_phases, MyC, R"(
+        @vdc.randclass
+        class MyC(object):
+            a : vdc.rand_uint32_t 
+            b : vdc.rand_uint32_t 
+            c : vdc.rand_uint32_t 
+
+            @vdc.constraint
+            def ab_c(self):
+                self.a < self.b
+    )");
+    #include "TestSolverStats_phases.h"
+    enableDebug(false);
+
+    vsc::dm::IModelFieldUP field(mkRootField("abc", MyC_t));
+
+    IRandStateUP randstate(m_factory->mkRandState("0"));
+    ICompoundSolverUP solver(m_factory->mkCompoundSolver());
+    RefPathSet target_fields, fixed_fields, include_constraints, exclude_constraints;
+    SolveFlags flags = SolveFlags::NoFlags;
+
+    for (uint32_t i=0; i<10; i++) {
+        solver->randomize(
+            randstate.get(),
+            field.get(),
+            target_fields,
+            fixed_fields,
+            include_constraints,
+            exclude_constraints,
+            flags);
+    }
+
+    SolverStats &stats = solver->getStats();
+    ASSERT_EQ(stats.getCount(SolverStatsCounter::PlanMiss), 1);
+    ASSERT_EQ(stats.getCount(SolverStatsCounter::PlanHit), 9);
+    ASSERT_EQ(stats.getCount(SolverStatsCounter::SolverMiss), 1);
+    ASSERT_EQ(stats.getCount(SolverStatsCounter::SolverHit), 9);
+    ASSERT_EQ(stats.getPhase(SolverStatsPhase::Partition).count(), 1);
+    ASSERT_EQ(stats.getPhase(SolverStatsPhase::Build).count(), 1);
+    ASSERT_EQ(stats.getPhase(SolverStatsPhase::Solve).count(), 10);
+    ASSERT_EQ(stats.getPhase(SolverStatsPhase::Readback).count(), 10);
+    ASSERT_EQ(stats.getPhase(SolverStatsPhase::Randomize).count(), 10);
+    ASSERT_EQ(stats.getNumBackends(), 1);
+    ASSERT_EQ(stats.getBackendName(0), "boolector");
+    ASSERT_EQ(stats.getNumSolveSets(), 1);
+    ASSERT_EQ(stats.getSolveSetAt(0).n_fields, 2);
+    ASSERT_EQ(stats.getSolveSetAt(0).solve.count(), 10);
+
+    solver->resetStats();
+    ASSERT_EQ(stats.getCount(SolverStatsCounter::PlanHit), 0);
+    ASSERT_EQ(stats.getPhase(SolverStatsPhase::Solve).count(), 0);
+    ASSERT_EQ(stats.getSolveSetAt(0).solve.count(), 0);
+}
+
+}
+}